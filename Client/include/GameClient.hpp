@@ -5,7 +5,13 @@
 #include "IsometricEngine.hpp"
 #include "Vector3D.hpp"
 #include "Movement.hpp"
+#include "Snapshot.hpp"
+#include "DatagramChannel.hpp"
+#include <array>
+#include <deque>
+#include <map>
 #include <memory>
+#include <vector>
 
 namespace IsometricMUD {
 
@@ -27,6 +33,16 @@ public:
      */
     void disconnect();
 
+    /**
+     * @brief Drop and delay outgoing datagrams to test behaviour on a bad link
+     */
+    void setNetworkSimulation(float lossRatio, sf::Time latency, sf::Time jitter);
+
+    /**
+     * @brief Log in as a named player so the server restores its saved position
+     */
+    void setPlayerName(const std::string& name);
+
     /**
      * @brief Initialize the client window and graphics
      */
@@ -41,7 +57,15 @@ private:
     void handleInput();
     void update();
     void render();
+    void buildGrid();
+    void applyAtlas();
     void handleNetworkMessages();
+    void handlePacket(sf::Packet& packet);
+    void handleSnapshot(const sf::Packet& packet);
+    void setEntityPosition(sf::Uint32 entityId, const Vector3D& position);
+    void handleDatagrams();
+    void sendMoveDatagram();
+    void followRedirect();
     
     std::unique_ptr<sf::RenderWindow> window;
     std::unique_ptr<IsometricEngine> engine;
@@ -51,9 +75,52 @@ private:
     
     Vector3D playerPosition;
     sf::Uint32 playerId;
+    std::string playerName;
+    sf::Clock lastMoveClock;    // Prediction wins until the player has been idle a while
+    Vector3D serverPlayerPosition;  // Where the server last said the player is
+    bool hasServerPosition;
+    
+    // Zone handoff: the server names another zone server and a token that
+    // the new session presents instead of logging in
+    unsigned short redirectPort;
+    sf::Uint32 resumeToken;
+    
+    // Other entities the server says are in view; never the player itself
+    std::map<sf::Uint32, Vector3D> remoteEntities;
+    
+    // Recent snapshots, kept as baselines for the server's deltas
+    SnapshotHistory receivedSnapshots;
+    Snapshot latestSnapshot;
+    
+    // Unreliable movement channel, opened once the server's CONNECT arrives
+    struct PendingMove {
+        sf::Uint32 number;
+        Direction dir;
+    };
+    static const size_t MaxPendingMoves = 16;
+    
+    DatagramSocket udpSocket;
+    DatagramChannel datagrams;
+    sf::IpAddress serverIp;
+    unsigned short serverUdpPort;
+    sf::Uint32 udpToken;
+    std::deque<PendingMove> pendingMoves;       // Repeated in every datagram until acknowledged
+    sf::Uint32 nextMoveNumber;
+    std::array<sf::Uint32, 64> datagramLastMove; // Newest move carried by each recent datagram
+    std::vector<sf::Uint16> newlyAcked;
+    sf::Clock datagramClock;
+    bool datagramAckDue;
     
     // Camera control
     sf::Vector2f cameraOffset;
+    
+    // The world grid is built once into cached chunks; entities are sorted and drawn every frame
+    TileChunkCache gridTiles;
+    DrawList entityDrawList;
+    
+    // Tile and entity sprites, packed on a worker thread at startup
+    TextureAtlas atlas;
+    bool atlasPending;
 };
 
 } // namespace IsometricMUD
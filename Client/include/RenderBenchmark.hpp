@@ -0,0 +1,38 @@
+#pragma once
+
+#include <ostream>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Render benchmark settings
+ */
+struct RenderBenchmarkConfig {
+    unsigned int tiles = 100000;        // Tiles in the test floor
+    unsigned int frames = 120;          // Frames timed per path
+    unsigned int dynamicItems = 50000;  // Entities sorted and drawn per frame by the draw list path
+    unsigned int width = 1024;          // Off-screen target size
+    unsigned int height = 768;
+};
+
+/**
+ * @brief Times a large floor drawn tile by tile, as one batch, and from cached chunks
+ *
+ * Draws into an off-screen sf::RenderTexture, so no window opens. Each path
+ * draws the same square floor (a translucent second layer over every eighth
+ * tile, like the client's upper levels) for a number of frames; the batch
+ * is rebuilt every frame so it pays for all of its CPU work. The chunked
+ * path builds a TileChunkCache once and pans the camera instead, and
+ * reports how many chunks and tiles culling skipped in its last frame. All
+ * three paths cull off-screen tiles, so a floor much larger than the
+ * window mostly measures how cheaply each path rejects tiles. A last run
+ * adds, sorts and draws a DrawList of on-screen entities every frame and
+ * reports the sort time on its own. The
+ * texture is read back once at the end of each run so the GPU has finished
+ * before the clock stops.
+ *
+ * @return False if the render texture couldn't be created
+ */
+bool runRenderBenchmark(const RenderBenchmarkConfig& config, std::ostream& out);
+
+} // namespace IsometricMUD
@@ -1,12 +1,31 @@
 #include "GameClient.hpp"
 #include "NetworkProtocol.hpp"
+#include "MessageSchema.hpp"
+#include "LevelFile.hpp"
 #include <iostream>
 
 namespace IsometricMUD {
 
+namespace {
+
+const sf::Color GroundColor(100, 150, 100);
+const sf::Color RemoteEntityColor(200, 80, 80);
+
+// Once the player has been idle this long, every move has had its answer
+// and the server's position replaces the locally predicted one
+const sf::Time ReconcileDelay = sf::milliseconds(250);
+
+// Zone servers share a host, so reaching the next one is quick or hopeless
+const sf::Time RedirectTimeout = sf::seconds(2.0f);
+
+} // namespace
+
 GameClient::GameClient() 
     : connected(false), running(false), playerPosition(0, 0, 0), 
-      playerId(0), cameraOffset(0, 0) {
+      playerId(0), serverPlayerPosition(0, 0, 0), hasServerPosition(false),
+      redirectPort(0), resumeToken(0), serverUdpPort(0), udpToken(0), nextMoveNumber(1),
+      datagramAckDue(false), cameraOffset(0, 0), atlasPending(false) {
+    datagramLastMove.fill(0);
 }
 
 GameClient::~GameClient() {
@@ -22,13 +41,29 @@ bool GameClient::connect(const std::string& serverAddress, unsigned short port)
     }
     
     connected = true;
+    serverIp = sf::IpAddress(serverAddress);
     std::cout << "Connected to server at " << serverAddress << ":" << port << std::endl;
+    
+    // Movement switches to UDP once the server's CONNECT names its port
+    if (udpSocket.bind(sf::Socket::AnyPort) == sf::Socket::Done) {
+        udpSocket.setBlocking(false);
+    }
     return true;
 }
 
+void GameClient::setNetworkSimulation(float lossRatio, sf::Time latency, sf::Time jitter) {
+    udpSocket.setSimulation(lossRatio, latency, jitter);
+}
+
+void GameClient::setPlayerName(const std::string& name) {
+    playerName = name;
+}
+
 void GameClient::disconnect() {
     if (connected) {
         socket.disconnect();
+        udpSocket.unbind();
+        serverUdpPort = 0;
         connected = false;
     }
 }
@@ -42,6 +77,14 @@ bool GameClient::initialize() {
     
     engine = std::make_unique<IsometricEngine>();
     engine->initialize(1024, 768);
+    buildGrid();
+    
+    // Flat art for now; the grid and entities switch to it once it is packed
+    atlas.addTileSprite(static_cast<int>(TileType::GRASS), TextureAtlas::makeTileSprite(GroundColor));
+    atlas.addEntitySprite(static_cast<int>(DrawLayer::ENTITY), TextureAtlas::makeTileSprite(RemoteEntityColor));
+    atlas.addEntitySprite(static_cast<int>(DrawLayer::PLAYER), TextureAtlas::makeTileSprite(sf::Color::Yellow));
+    atlas.buildAsync();
+    atlasPending = true;
     
     return true;
 }
@@ -101,71 +144,337 @@ void GameClient::handleInput() {
             }
             
             if (shouldMove && connected) {
-                // Send movement packet to server
-                sf::Packet packet = NetworkProtocol::createMovePacket(playerId, moveDir);
-                socket.send(packet);
+                if (serverUdpPort != 0) {
+                    // Queue the move; it is repeated until the server acknowledges it
+                    pendingMoves.push_back({nextMoveNumber++, moveDir});
+                    if (pendingMoves.size() > MaxPendingMoves) {
+                        pendingMoves.pop_front();
+                    }
+                    sendMoveDatagram();
+                } else {
+                    sf::Packet packet = NetworkProtocol::createMovePacket(playerId, moveDir);
+                    socket.send(packet);
+                }
                 
                 // Update local position immediately for responsiveness
                 playerPosition = Movement::applyMovement(playerPosition, moveDir);
+                lastMoveClock.restart();
             }
         }
     }
 }
 
 void GameClient::update() {
+    // Moves are predicted locally; after a pause, adopt the server's answer so
+    // rejected moves and restored logins don't leave the player out of sync
+    if (hasServerPosition && lastMoveClock.getElapsedTime() >= ReconcileDelay) {
+        playerPosition = serverPlayerPosition;
+    }
+    
     // Update camera to follow player
     engine->setCameraPosition(playerPosition);
 }
 
 void GameClient::render() {
     window->clear(sf::Color(50, 50, 50));
-    
-    // Render the world grid
-    for (int x = -5; x <= 5; x++) {
-        for (int y = -5; y <= 5; y++) {
-            for (int z = 0; z <= 2; z++) {
-                Vector3D tilePos(x, y, z);
-                sf::Color tileColor;
-                
-                if (z == 0) {
-                    tileColor = sf::Color(100, 150, 100); // Ground
-                } else {
-                    tileColor = sf::Color(150, 150, 200, 100); // Upper levels, semi-transparent
-                }
-                
-                engine->renderTile(*window, tilePos, tileColor);
-            }
-        }
+    engine->resetStats();
+    if (atlasPending && atlas.isBuilt()) {
+        applyAtlas();
     }
     
-    // Render player
-    engine->renderTile(*window, playerPosition, sf::Color::Yellow);
+    // The player and other entities in view, drawn in among the world grid
+    // so tiles in front of them cover them
+    sf::IntRect remoteSprite = engine->getEntitySprite(static_cast<int>(DrawLayer::ENTITY));
+    sf::IntRect playerSprite = engine->getEntitySprite(static_cast<int>(DrawLayer::PLAYER));
+    entityDrawList.clear();
+    for (const auto& entity : remoteEntities) {
+        engine->addToDrawList(entityDrawList, entity.second,
+                              remoteSprite.width > 0 ? sf::Color::White : RemoteEntityColor,
+                              DrawLayer::ENTITY, remoteSprite);
+    }
+    engine->addToDrawList(entityDrawList, playerPosition,
+                          playerSprite.width > 0 ? sf::Color::White : sf::Color::Yellow,
+                          DrawLayer::PLAYER, playerSprite);
+    engine->renderScene(*window, gridTiles, entityDrawList);
     
     window->display();
 }
 
+void GameClient::buildGrid() {
+    gridTiles.clear();
+    for (int z = 0; z <= 2; z++) {
+        sf::Color tileColor;
+        sf::IntRect sprite;
+        if (z == 0) {
+            sprite = engine->getTileSprite(static_cast<int>(TileType::GRASS));
+            tileColor = sprite.width > 0 ? sf::Color::White : GroundColor;
+        } else {
+            tileColor = sf::Color(150, 150, 200, 100); // Upper levels, semi-transparent
+        }
+        
+        for (int x = -5; x <= 5; x++) {
+            for (int y = -5; y <= 5; y++) {
+                gridTiles.setTile(Vector3D(x, y, z), tileColor, sprite);
+            }
+        }
+    }
+}
+
+void GameClient::applyAtlas() {
+    atlasPending = false;
+    if (!atlas.upload()) {
+        std::cerr << "Texture atlas unavailable; drawing flat tiles" << std::endl;
+        return;
+    }
+    engine->setAtlas(&atlas);
+    buildGrid();
+}
+
 void GameClient::handleNetworkMessages() {
     if (!connected) return;
     
     sf::Packet packet;
-    sf::Socket::Status status = socket.receive(packet);
+    while (redirectPort == 0 && socket.receive(packet) == sf::Socket::Done) {
+        handlePacket(packet);
+    }
+    if (redirectPort != 0) {
+        followRedirect();
+        return;
+    }
     
-    if (status == sf::Socket::Done) {
-        PacketType type = NetworkProtocol::getPacketType(packet);
+    if (serverUdpPort != 0) {
+        handleDatagrams();
         
-        switch (type) {
-            case PacketType::UPDATE_POSITION: {
-                sf::Uint32 entityId;
-                Vector3D position;
-                if (NetworkProtocol::parsePositionPacket(packet, entityId, position)) {
-                    // Update entity position (for multiplayer)
-                    std::cout << "Entity " << entityId << " moved to (" 
-                              << position.x << ", " << position.y << ", " << position.z << ")" << std::endl;
+        // Resend unacknowledged moves and acknowledge the server's datagrams
+        // promptly; otherwise a slow keepalive holds the endpoint binding
+        sf::Time interval = (!pendingMoves.empty() || datagramAckDue) ?
+            sf::milliseconds(50) : sf::milliseconds(250);
+        if (datagramClock.getElapsedTime() >= interval) {
+            sendMoveDatagram();
+        }
+        udpSocket.releaseDelayed();
+    }
+}
+
+void GameClient::handlePacket(sf::Packet& packet) {
+    PacketType type = NetworkProtocol::getPacketType(packet);
+    
+    switch (type) {
+        case PacketType::BATCH: {
+            // The server sends everything from one tick as a single batch
+            std::vector<sf::Packet> messages;
+            if (NetworkProtocol::unpackBatch(packet, messages)) {
+                for (auto& message : messages) {
+                    handlePacket(message);
                 }
+            }
+            break;
+        }
+        case PacketType::CONNECT: {
+            if (!NetworkProtocol::parseConnectPacket(packet, playerId, udpToken, serverUdpPort)) {
                 break;
             }
-            default:
+            if (resumeToken != 0) {
+                // Handed over by another zone server, which passed on our name and position
+                sf::Packet resume = NetworkProtocol::createResumePacket(resumeToken);
+                socket.send(resume);
+                resumeToken = 0;
+            } else if (!playerName.empty()) {
+                sf::Packet login = NetworkProtocol::createLoginPacket(playerName);
+                socket.send(login);
+            }
+            if (serverUdpPort != 0) {
+                // Announce our UDP endpoint straight away
+                sendMoveDatagram();
+            }
+            break;
+        }
+        case PacketType::SNAPSHOT: {
+            handleSnapshot(packet);
+            break;
+        }
+        case PacketType::SPAWN_ENTITY: {
+            sf::Uint32 entityId;
+            Vector3D position;
+            if (NetworkProtocol::parseSpawnPacket(packet, entityId, position)) {
+                setEntityPosition(entityId, position);
+            }
+            break;
+        }
+        case PacketType::REMOVE_ENTITY: {
+            sf::Uint32 entityId;
+            if (NetworkProtocol::parseRemovePacket(packet, entityId)) {
+                remoteEntities.erase(entityId);
+            }
+            break;
+        }
+        case PacketType::CHAT: {
+            ChatChannel channel;
+            sf::Uint32 sender;
+            std::string message;
+            if (NetworkProtocol::parseChatPacket(packet, channel, sender, message)) {
+                std::cout << "[" << NetworkProtocol::getChatChannelName(channel) << "] "
+                          << sender << ": " << message << std::endl;
+            }
+            break;
+        }
+        case PacketType::REDIRECT: {
+            // Followed once the rest of this batch is read
+            NetworkProtocol::parseRedirectPacket(packet, redirectPort, resumeToken);
+            break;
+        }
+        case PacketType::UPDATE_POSITION: {
+            sf::Uint32 entityId;
+            Vector3D position;
+            if (NetworkProtocol::parsePositionPacket(packet, entityId, position)) {
+                setEntityPosition(entityId, position);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void GameClient::handleSnapshot(const sf::Packet& packet) {
+    WireReader reader(packet.getData(), packet.getDataSize());
+    sf::Uint32 sequence;
+    sf::Uint32 baselineSequence;
+    if (!SnapshotCodec::readHeader(reader, sequence, baselineSequence)) {
+        return;
+    }
+    
+    static const Snapshot emptyBaseline;
+    const Snapshot* baseline = &emptyBaseline;
+    if (baselineSequence != 0) {
+        baseline = receivedSnapshots.find(baselineSequence);
+        if (!baseline) {
+            // Too old to resolve; the server falls back to a full snapshot
+            // once our acknowledgements stop advancing
+            return;
+        }
+    }
+    
+    if (!SnapshotCodec::decode(reader, *baseline, latestSnapshot)) {
+        std::cerr << "Malformed snapshot " << sequence << std::endl;
+        return;
+    }
+    latestSnapshot.sequence = sequence;
+    receivedSnapshots.store(latestSnapshot);
+    
+    // The snapshot is the complete view, so it replaces what we had
+    remoteEntities.clear();
+    for (const auto& entity : latestSnapshot.entities) {
+        setEntityPosition(entity.entityId, Snapshot::toPosition(entity));
+    }
+    
+    sf::Packet ack = NetworkProtocol::createSnapshotAckPacket(sequence);
+    socket.send(ack);
+}
+
+void GameClient::setEntityPosition(sf::Uint32 entityId, const Vector3D& position) {
+    // The server reports the player too; that copy only corrects prediction
+    // and isn't drawn, or it would trail the player as a second sprite
+    if (entityId == playerId) {
+        serverPlayerPosition = position;
+        hasServerPosition = true;
+    } else {
+        remoteEntities[entityId] = position;
+    }
+}
+
+void GameClient::followRedirect() {
+    unsigned short port = redirectPort;
+    redirectPort = 0;
+    
+    // Leaving ends the old session; the new server is already holding our token
+    socket.disconnect();
+    if (socket.connect(serverIp, port, RedirectTimeout) != sf::Socket::Done) {
+        std::cerr << "Could not reach the zone server on port " << port << std::endl;
+        udpSocket.unbind();
+        serverUdpPort = 0;
+        connected = false;
+        return;
+    }
+    
+    // A new session: its own ids, snapshot baselines and UDP channel. The
+    // player keeps its position; the new server was told the same one
+    playerId = 0;
+    udpToken = 0;
+    serverUdpPort = 0;
+    hasServerPosition = false;
+    remoteEntities.clear();
+    receivedSnapshots.clear();
+    datagrams = DatagramChannel();
+    pendingMoves.clear();
+    nextMoveNumber = 1;
+    datagramLastMove.fill(0);
+    std::cout << "Moved to the zone server on port " << port << std::endl;
+}
+
+void GameClient::sendMoveDatagram() {
+    // [client id][token][channel header][first move number][count][MOVE...]
+    char buffer[MaxDatagramSize];
+    WireWriter writer(buffer, sizeof(buffer));
+    writer.writeVarUInt(playerId);
+    writer.writeUInt32(udpToken);
+    sf::Uint16 sequence = datagrams.writeHeader(writer);
+    writer.writeVarUInt(pendingMoves.empty() ? nextMoveNumber : pendingMoves.front().number);
+    writer.writeVarUInt(pendingMoves.size());
+    for (const auto& move : pendingMoves) {
+        Messages::Move::encode(writer, move.dir, playerId);
+    }
+    datagramLastMove[sequence % datagramLastMove.size()] = nextMoveNumber - 1;
+    
+    if (writer.finish()) {
+        udpSocket.sendDatagram(buffer, writer.getSize(), serverIp, serverUdpPort);
+    }
+    datagramClock.restart();
+    datagramAckDue = false;
+}
+
+void GameClient::handleDatagrams() {
+    char buffer[MaxDatagramSize];
+    std::size_t received = 0;
+    sf::IpAddress sender;
+    unsigned short senderPort = 0;
+    
+    while (udpSocket.receive(buffer, sizeof(buffer), received, sender, senderPort) == sf::Socket::Done) {
+        if (sender != serverIp || senderPort != serverUdpPort) {
+            continue;
+        }
+        
+        // [channel header][count][UPDATE_POSITION...]
+        WireReader reader(buffer, received);
+        newlyAcked.clear();
+        bool fresh = datagrams.readHeader(reader, newlyAcked);
+        
+        // Moves carried by an acknowledged datagram have reached the server
+        for (sf::Uint16 sequence : newlyAcked) {
+            sf::Uint32 carried = datagramLastMove[sequence % datagramLastMove.size()];
+            while (!pendingMoves.empty() && pendingMoves.front().number <= carried) {
+                pendingMoves.pop_front();
+            }
+        }
+        
+        if (!fresh) {
+            continue;
+        }
+        datagramAckDue = true;
+        
+        sf::Uint64 count = reader.readVarUInt();
+        for (sf::Uint64 i = 0; i < count; i++) {
+            sf::Uint32 entityId;
+            Vector3D position;
+            if (!Messages::UpdatePosition::decode(reader, entityId, position)) {
                 break;
+            }
+            
+            // Spawns and removals come over TCP; a late datagram must not
+            // bring back an entity that has already left view
+            if (entityId == playerId || remoteEntities.count(entityId)) {
+                setEntityPosition(entityId, position);
+            }
         }
     }
 }
@@ -0,0 +1,190 @@
+#include "RenderBenchmark.hpp"
+#include "IsometricEngine.hpp"
+#include "TileBatch.hpp"
+#include "TileChunkCache.hpp"
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace IsometricMUD {
+
+namespace {
+
+const sf::Color GroundColor(100, 150, 100);
+const sf::Color UpperColor(150, 150, 200, 100);
+const sf::Color EntityColor(200, 80, 80);
+
+// Every this many ground tiles gets a translucent tile one level up
+const unsigned int UpperTileSpacing = 8;
+
+struct PathResult {
+    double frameMs = 0.0;
+    size_t drawCalls = 0;
+    size_t vertices = 0;
+};
+
+struct FloorTile {
+    Vector3D position;
+    bool upper;
+};
+
+std::vector<FloorTile> buildFloor(unsigned int tiles) {
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(tiles))));
+    std::vector<FloorTile> floor;
+    floor.reserve(tiles + tiles / UpperTileSpacing + 1);
+    
+    for (unsigned int i = 0; i < tiles; i++) {
+        float x = static_cast<float>(static_cast<int>(i) % side - side / 2);
+        float y = static_cast<float>(static_cast<int>(i) / side - side / 2);
+        floor.push_back({Vector3D(x, y, 0), false});
+        if (i % UpperTileSpacing == 0) {
+            floor.push_back({Vector3D(x, y, 1), true});
+        }
+    }
+    return floor;
+}
+
+// Time frames from the first clear until the GPU has finished the last one
+template <typename DrawFrame>
+double timeFrames(sf::RenderTexture& target, unsigned int frames, DrawFrame drawFrame) {
+    // One untimed frame so driver and allocation warm-up isn't counted
+    target.clear(sf::Color(50, 50, 50));
+    drawFrame();
+    target.display();
+    
+    sf::Clock clock;
+    for (unsigned int frame = 0; frame < frames; frame++) {
+        target.clear(sf::Color(50, 50, 50));
+        drawFrame();
+        target.display();
+    }
+    target.getTexture().copyToImage();
+    return clock.getElapsedTime().asMicroseconds() / 1000.0 / frames;
+}
+
+} // namespace
+
+bool runRenderBenchmark(const RenderBenchmarkConfig& config, std::ostream& out) {
+    sf::RenderTexture target;
+    if (!target.create(config.width, config.height)) {
+        std::cerr << "Failed to create a " << config.width << "x" << config.height
+                  << " render texture" << std::endl;
+        return false;
+    }
+    
+    IsometricEngine engine;
+    engine.initialize(config.width, config.height);
+    
+    std::vector<FloorTile> floor = buildFloor(config.tiles);
+    
+    // One call per tile, as the client used to draw its grid
+    PathResult immediate;
+    immediate.frameMs = timeFrames(target, config.frames, [&]() {
+        engine.resetStats();
+        for (const FloorTile& tile : floor) {
+            engine.renderTile(target, tile.position, tile.upper ? UpperColor : GroundColor);
+        }
+    });
+    immediate.drawCalls = engine.getStats().tilesDrawn;
+    
+    // One call per layer
+    std::array<TileBatch, 2> layers;
+    PathResult batched;
+    batched.frameMs = timeFrames(target, config.frames, [&]() {
+        for (TileBatch& layer : layers) {
+            layer.clear();
+        }
+        for (const FloorTile& tile : floor) {
+            engine.addTile(layers[tile.upper ? 1 : 0], tile.position, tile.upper ? UpperColor : GroundColor);
+        }
+        for (const TileBatch& layer : layers) {
+            engine.renderBatch(target, layer);
+        }
+    });
+    for (const TileBatch& layer : layers) {
+        batched.drawCalls += layer.isEmpty() ? 0 : 1;
+        batched.vertices += layer.getVertexCount();
+    }
+    
+    // Prebuilt chunks; the camera pans every frame so only the transform changes
+    TileChunkCache chunks;
+    for (const FloorTile& tile : floor) {
+        chunks.setTile(tile.position, tile.upper ? UpperColor : GroundColor);
+    }
+    PathResult chunked;
+    unsigned int frame = 0;
+    chunked.frameMs = timeFrames(target, config.frames, [&]() {
+        engine.resetStats();
+        engine.setCameraPosition(Vector3D(static_cast<float>(frame++ % 32), 0, 0));
+        engine.renderChunks(target, chunks);
+    });
+    RenderStats culling = engine.getStats();
+    chunked.drawCalls = culling.chunksDrawn;
+    
+    // Entities scattered over the visible area, re-added and sorted every frame
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> spread(-10, 10);
+    std::uniform_int_distribution<int> level(0, 2);
+    std::vector<Vector3D> entities;
+    entities.reserve(config.dynamicItems);
+    for (unsigned int i = 0; i < config.dynamicItems; i++) {
+        entities.push_back(Vector3D(spread(random), spread(random), level(random)));
+    }
+    
+    engine.setCameraPosition(Vector3D(0, 0, 0));
+    DrawList drawList;
+    PathResult sorted;
+    double sortMs = 0.0;
+    sorted.frameMs = timeFrames(target, config.frames, [&]() {
+        engine.resetStats();
+        drawList.clear();
+        for (const Vector3D& position : entities) {
+            engine.addToDrawList(drawList, position, EntityColor, DrawLayer::ENTITY);
+        }
+        engine.renderDrawList(target, drawList);
+        sortMs += engine.getStats().sortMs;
+    });
+    // Averaged over the untimed warm-up frame too; it sorts the same items
+    sortMs /= config.frames + 1;
+    sorted.drawCalls = 1;
+    
+    out << std::fixed << std::setprecision(3);
+    out << "{"
+        << "\"tiles\":" << floor.size()
+        << ",\"frames\":" << config.frames
+        << ",\"target\":\"" << config.width << "x" << config.height << "\""
+        << ",\"immediate\":{"
+        << "\"frame_ms\":" << immediate.frameMs
+        << ",\"draw_calls\":" << immediate.drawCalls
+        << "}"
+        << ",\"batched\":{"
+        << "\"frame_ms\":" << batched.frameMs
+        << ",\"draw_calls\":" << batched.drawCalls
+        << ",\"vertices\":" << batched.vertices
+        << "}"
+        << ",\"chunked\":{"
+        << "\"frame_ms\":" << chunked.frameMs
+        << ",\"draw_calls\":" << chunked.drawCalls
+        << ",\"chunks_drawn\":" << culling.chunksDrawn
+        << ",\"chunks_culled\":" << culling.chunksCulled
+        << ",\"tiles_drawn\":" << culling.chunkTilesDrawn
+        << ",\"tiles_culled\":" << culling.chunkTilesCulled
+        << ",\"chunk_rebuilds\":" << chunks.getRebuildCount()
+        << "}"
+        << ",\"draw_list\":{"
+        << "\"items\":" << drawList.size()
+        << ",\"frame_ms\":" << sorted.frameMs
+        << ",\"sort_ms\":" << sortMs
+        << ",\"draw_calls\":" << sorted.drawCalls
+        << "}"
+        << ",\"speedup\":" << (batched.frameMs > 0.0 ? immediate.frameMs / batched.frameMs : 0.0)
+        << ",\"chunked_speedup\":" << (chunked.frameMs > 0.0 ? immediate.frameMs / chunked.frameMs : 0.0)
+        << "}" << std::endl;
+    return true;
+}
+
+} // namespace IsometricMUD
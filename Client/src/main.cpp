@@ -1,29 +1,109 @@
 #include "GameClient.hpp"
+#include "NetworkProtocol.hpp"
+#include "RenderBenchmark.hpp"
 #include <iostream>
 #include <string>
 
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [server_address] [port] [options]" << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  --name <player>          Log in as a named player to resume its saved position" << std::endl;
+    std::cerr << "  --sim-loss <percent>     Drop this share of outgoing datagrams (testing)" << std::endl;
+    std::cerr << "  --sim-latency <ms>       Delay outgoing datagrams (testing)" << std::endl;
+    std::cerr << "  --sim-jitter <ms>        Add up to this much random delay (testing)" << std::endl;
+    std::cerr << "  --bench-render <tiles>   Time per-tile and batched drawing off-screen, then exit" << std::endl;
+    std::cerr << "  --bench-frames <n>       Frames timed per path by --bench-render (default 120)" << std::endl;
+}
+
+bool parseNumber(const std::string& text, int minValue, int maxValue, int& result) {
+    try {
+        int value = std::stoi(text);
+        if (value < minValue || value > maxValue) {
+            return false;
+        }
+        result = value;
+        return true;
+    } catch (const std::exception& e) {
+        return false;
+    }
+}
+
+} // namespace
+
 int main(int argc, char* argv[]) {
     std::string serverAddress = "127.0.0.1";
     unsigned short port = 53000;
+    int simulatedLoss = 0;
+    int simulatedLatency = 0;
+    int simulatedJitter = 0;
+    int positional = 0;
+    std::string playerName;
+    bool benchRender = false;
+    IsometricMUD::RenderBenchmarkConfig benchConfig;
     
-    if (argc > 1) {
-        serverAddress = argv[1];
-    }
-    if (argc > 2) {
-        try {
-            int portNum = std::stoi(argv[2]);
-            if (portNum < 1 || portNum > 65535) {
-                std::cerr << "Error: Port must be between 1 and 65535" << std::endl;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        int value = 0;
+        
+        if (arg == "--name" && i + 1 < argc) {
+            playerName = argv[++i];
+            if (playerName.empty() || playerName.size() > IsometricMUD::MaxPlayerNameLength) {
+                std::cerr << "Error: Player name must be 1 to " << IsometricMUD::MaxPlayerNameLength
+                          << " characters" << std::endl;
                 return 1;
             }
-            port = static_cast<unsigned short>(portNum);
-        } catch (const std::exception& e) {
-            std::cerr << "Error: Invalid port number '" << argv[2] << "'" << std::endl;
-            std::cerr << "Usage: " << argv[0] << " [server_address] [port]" << std::endl;
+        } else if (arg == "--sim-loss" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 0, 100, simulatedLoss)) {
+                std::cerr << "Error: Loss must be a percentage between 0 and 100" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--sim-latency" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 0, 10000, simulatedLatency)) {
+                std::cerr << "Error: Invalid latency '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--sim-jitter" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 0, 10000, simulatedJitter)) {
+                std::cerr << "Error: Invalid jitter '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--bench-render" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 10000000, value)) {
+                std::cerr << "Error: Invalid tile count '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            benchConfig.tiles = static_cast<unsigned int>(value);
+            benchRender = true;
+        } else if (arg == "--bench-frames" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 100000, value)) {
+                std::cerr << "Error: Invalid frame count '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            benchConfig.frames = static_cast<unsigned int>(value);
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            printUsage(argv[0]);
             return 1;
+        } else if (positional == 0) {
+            serverAddress = arg;
+            positional++;
+        } else {
+            if (!parseNumber(arg, 1, 65535, value)) {
+                std::cerr << "Error: Invalid port number '" << arg << "'" << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            port = static_cast<unsigned short>(value);
+            positional++;
         }
     }
     
+    if (benchRender) {
+        return IsometricMUD::runRenderBenchmark(benchConfig, std::cout) ? 0 : 1;
+    }
+    
     std::cout << "Isometric MUD Client" << std::endl;
     std::cout << "====================" << std::endl;
     std::cout << "Controls:" << std::endl;
@@ -36,6 +116,9 @@ int main(int argc, char* argv[]) {
     std::cout << std::endl;
     
     IsometricMUD::GameClient client;
+    client.setPlayerName(playerName);
+    client.setNetworkSimulation(simulatedLoss / 100.0f, sf::milliseconds(simulatedLatency),
+                                sf::milliseconds(simulatedJitter));
     
     if (!client.initialize()) {
         std::cerr << "Failed to initialize client" << std::endl;
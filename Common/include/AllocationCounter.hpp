@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Counts heap allocations made by the calling thread
+ *
+ * Built with ISOMUD_COUNT_ALLOCATIONS, the global operator new is replaced
+ * by one that bumps a thread-local counter before calling malloc. Reading
+ * the counter before and after a piece of work gives the number of heap
+ * allocations it made. Without the option nothing is replaced and the
+ * count stays at zero.
+ */
+class AllocationCounter {
+public:
+    static bool isEnabled();
+
+    /**
+     * @brief Heap allocations made by this thread so far
+     */
+    static std::uint64_t getThreadCount();
+};
+
+} // namespace IsometricMUD
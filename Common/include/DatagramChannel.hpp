@@ -0,0 +1,129 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include <SFML/System.hpp>
+#include "WireCodec.hpp"
+#include <array>
+#include <map>
+#include <random>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Largest datagram either side sends; stays under a typical path MTU
+ */
+constexpr size_t MaxDatagramSize = 1200;
+
+/**
+ * @brief Sequence numbers and acknowledgements for one unreliable UDP peer
+ *
+ * Every datagram starts with its own 16-bit sequence number, the newest
+ * sequence received from the peer, and a 32-bit field acknowledging the 32
+ * sequences before that. Nothing is retransmitted: senders learn which
+ * datagrams arrived and decide for themselves what is worth repeating, and
+ * receivers discard anything older than what they already applied.
+ *
+ * Sequence 0 is never sent, so an ack of 0 means "nothing received yet".
+ */
+class DatagramChannel {
+public:
+    DatagramChannel();
+
+    /**
+     * @brief Write the header for the next outgoing datagram
+     * @return The sequence number the datagram was given
+     */
+    sf::Uint16 writeHeader(WireWriter& writer);
+
+    /**
+     * @brief Read a received header and process the acknowledgements in it
+     * @param newlyAcked Receives our sequences the peer confirmed for the first time
+     * @return False if the datagram is malformed, a duplicate, or older than
+     *         one already received (its payload should then be ignored)
+     */
+    bool readHeader(WireReader& reader, std::vector<sf::Uint16>& newlyAcked);
+
+    /**
+     * @brief Smoothed round-trip time measured from acknowledgements
+     */
+    sf::Time getRoundTripTime() const { return roundTripTime; }
+
+    /**
+     * @brief Fraction of our datagrams that aged out of the history unacknowledged
+     */
+    float getLossRatio() const;
+
+    /**
+     * @brief True if a is more recent than b, allowing for wrap-around
+     */
+    static bool isNewer(sf::Uint16 a, sf::Uint16 b);
+
+private:
+    static const size_t SentHistory = 64;
+
+    struct SentRecord {
+        sf::Uint16 sequence = 0;
+        bool acked = false;
+        sf::Time sentAt;
+    };
+
+    void acknowledge(sf::Uint16 sequence, std::vector<sf::Uint16>& newlyAcked);
+
+    sf::Uint16 localSequence;
+    sf::Uint16 remoteSequence;
+    sf::Uint32 receivedBits;
+
+    std::array<SentRecord, SentHistory> sent;
+    sf::Clock clock;
+    sf::Time roundTripTime;
+    sf::Uint32 ackedCount;
+    sf::Uint32 lostCount;
+};
+
+/**
+ * @brief UDP socket with an optional loss and latency simulator
+ *
+ * With the simulator off, sendDatagram() is a plain send. Otherwise each
+ * outgoing datagram is dropped with the configured probability or held back
+ * for the configured latency plus random jitter (so datagrams may also
+ * arrive out of order). Both ends applying it covers both directions, which
+ * makes lossy links reproducible on loopback.
+ */
+class DatagramSocket : public sf::UdpSocket {
+public:
+    using sf::UdpSocket::getHandle;
+
+    DatagramSocket();
+
+    /**
+     * @brief Configure the simulator; all zero disables it
+     */
+    void setSimulation(float lossRatio, sf::Time latency, sf::Time jitter);
+
+    sf::Socket::Status sendDatagram(const void* data, size_t size,
+                                    const sf::IpAddress& address, unsigned short port);
+
+    /**
+     * @brief Send held-back datagrams whose delay has elapsed
+     */
+    void releaseDelayed();
+
+    bool hasDelayed() const { return !delayed.empty(); }
+
+private:
+    struct DelayedDatagram {
+        std::vector<char> bytes;
+        sf::IpAddress address;
+        unsigned short port;
+    };
+
+    float lossRatio;
+    sf::Time latency;
+    sf::Time jitter;
+    sf::Clock clock;
+    std::mt19937 random;
+    std::multimap<sf::Int64, DelayedDatagram> delayed; // Keyed by release time in microseconds
+};
+
+} // namespace IsometricMUD
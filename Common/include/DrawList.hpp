@@ -0,0 +1,90 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "TileBatch.hpp"
+#include "Vector3D.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief What an item in a DrawList is; the lowest of the depth key bits
+ *
+ * At the same tile and height, higher layers are drawn on top.
+ */
+enum class DrawLayer : std::uint8_t {
+    TILE = 0,
+    ENTITY = 1,
+    PLAYER = 2
+};
+
+/**
+ * @brief Per-frame items drawn in painter's order, sorted by a packed depth key
+ *
+ * Each item carries a 32-bit key: [x + y : 16][z : 8][layer : 8], each
+ * field biased to be unsigned, so comparing keys as integers orders items
+ * back to front, then bottom to top, then by layer. sort() is an LSD radix
+ * sort over the key bytes (O(n), no comparisons) that skips bytes every key
+ * shares, which for a typical frame leaves two or three passes.
+ *
+ * The list is for things that move: static level tiles already sit in
+ * presorted chunks. IsometricEngine::renderScene draws the sorted list in
+ * slices between the chunk diagonals, using append() to take the items up
+ * to each diagonal.
+ */
+class DrawList {
+public:
+    /**
+     * @brief Pack a position and layer into a depth key
+     *
+     * x + y is clamped to +-32767 and z to -128..127, more than any level uses.
+     */
+    static std::uint32_t makeKey(const Vector3D& position, DrawLayer layer);
+
+    /**
+     * @brief Add an item centred on a projected position
+     * @param sprite Atlas area to draw instead of a flat diamond, tinted by color (empty: none)
+     */
+    void add(std::uint32_t key, const sf::Vector2f& center, const sf::Color& color,
+             const sf::IntRect& sprite = sf::IntRect());
+
+    void clear();
+
+    /**
+     * @brief Order the items back to front (stable for equal keys)
+     */
+    void sort();
+
+    /**
+     * @brief Refill a batch with the items in their current order
+     */
+    void build(TileBatch& batch) const;
+
+    /**
+     * @brief Add sorted items to a batch, from index first up to the first whose x + y reaches depth
+     * @return Index of the first item not added
+     */
+    size_t append(TileBatch& batch, size_t first, int depth) const;
+
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+
+private:
+    struct Item {
+        sf::Vector2f center;
+        sf::Color color;
+        sf::IntRect sprite;
+    };
+
+    struct SortEntry {
+        std::uint32_t key;
+        std::uint32_t item;
+    };
+
+    std::vector<Item> items;
+    std::vector<SortEntry> order;       // Sorted after sort(); insertion order before
+    std::vector<SortEntry> scratch;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <SFML/Config.hpp>
+#include "Vector3D.hpp"
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Names an entity in an EntityStore; stale once the entity is destroyed
+ *
+ * Destroying an entity bumps its slot's generation, so a handle kept past
+ * that never reaches whatever reuses the slot. Generation 0 is never issued,
+ * which makes a default-constructed handle null.
+ */
+struct EntityHandle {
+    sf::Uint32 index = 0;
+    sf::Uint32 generation = 0;
+
+    bool isNull() const { return generation == 0; }
+    bool operator==(const EntityHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const EntityHandle& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Simulation state of every entity, one dense array per component
+ *
+ * Live entities occupy indices 0..size()-1 of each component array, so a
+ * system that only needs positions walks one contiguous array. Handles go
+ * through a slot table to the dense index. Destroying an entity moves the
+ * last one into its place, so both create and destroy are O(1), but dense
+ * indices are only stable until the next destroy.
+ *
+ * Networking state (sockets, send queues) stays with the connection; an
+ * entity only records which connection owns it.
+ */
+class EntityStore {
+public:
+    static const sf::Uint8 PlayerFlag = 1 << 0;
+    static const sf::Uint8 NpcFlag = 1 << 1;
+
+    /**
+     * @brief Add an entity
+     * @param owner Id of the connection that controls it (0 = the server)
+     */
+    EntityHandle create(const Vector3D& position, sf::Uint32 owner, sf::Uint8 flags);
+
+    /**
+     * @brief Remove an entity
+     * @return False if the handle was already stale
+     */
+    bool destroy(EntityHandle handle);
+
+    bool isAlive(EntityHandle handle) const {
+        return handle.index < slots.size() && slots[handle.index].generation == handle.generation &&
+               handle.generation != 0;
+    }
+
+    /**
+     * @brief Dense index of a live entity (valid until the next destroy)
+     */
+    size_t getIndex(EntityHandle handle) const { return slots[handle.index].denseIndex; }
+
+    EntityHandle getHandle(size_t index) const {
+        sf::Uint32 slot = denseSlots[index];
+        return EntityHandle{slot, slots[slot].generation};
+    }
+
+    size_t size() const { return positions.size(); }
+    void clear();
+
+    // Per-entity access; the handle must be alive
+    Vector3D& getPosition(EntityHandle handle) { return positions[getIndex(handle)]; }
+    const Vector3D& getPosition(EntityHandle handle) const { return positions[getIndex(handle)]; }
+    Vector3D& getVelocity(EntityHandle handle) { return velocities[getIndex(handle)]; }
+    sf::Uint32 getOwner(EntityHandle handle) const { return owners[getIndex(handle)]; }
+    sf::Uint8 getFlags(EntityHandle handle) const { return flags[getIndex(handle)]; }
+
+    // Whole components, indexed 0..size()-1
+    Vector3D* getPositions() { return positions.data(); }
+    const Vector3D* getPositions() const { return positions.data(); }
+    Vector3D* getVelocities() { return velocities.data(); }
+    const Vector3D* getVelocities() const { return velocities.data(); }
+    const sf::Uint32* getOwners() const { return owners.data(); }
+    const sf::Uint8* getFlags() const { return flags.data(); }
+
+private:
+    struct Slot {
+        sf::Uint32 generation;
+        sf::Uint32 denseIndex;
+    };
+
+    // Components
+    std::vector<Vector3D> positions;
+    std::vector<Vector3D> velocities;   // Movement per step of the current walk
+    std::vector<sf::Uint32> owners;
+    std::vector<sf::Uint8> flags;
+    std::vector<sf::Uint32> denseSlots; // Slot of each dense entry
+
+    std::vector<Slot> slots;
+    std::vector<sf::Uint32> freeSlots;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Fixed-memory log-linear histogram for latency measurements
+ *
+ * Values are bucketed by power of two and split into 16 linear sub-buckets,
+ * which bounds the relative error of any percentile to about 6%. Recording
+ * is wait-free (relaxed atomics), so one thread can record while others read
+ * percentiles without taking a lock.
+ */
+class Histogram {
+public:
+    static constexpr int SubBucketBits = 4;
+    static constexpr int SubBucketCount = 1 << SubBucketBits;
+    static constexpr int BucketCount = (64 - SubBucketBits + 1) * SubBucketCount;
+
+    Histogram();
+
+    /**
+     * @brief Record one value (e.g. a duration in microseconds)
+     */
+    void record(std::uint64_t value);
+
+    /**
+     * @brief Value at or below which the given fraction of samples fall
+     * @param fraction Quantile in [0, 1], e.g. 0.99 for p99
+     */
+    std::uint64_t percentile(double fraction) const;
+
+    std::uint64_t getCount() const { return count.load(std::memory_order_relaxed); }
+    std::uint64_t getSum() const { return sum.load(std::memory_order_relaxed); }
+    std::uint64_t getMax() const { return max.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Number of samples that fell into a bucket
+     */
+    std::uint64_t getBucketCount(int bucket) const {
+        return buckets[bucket].load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Largest value that maps to a bucket
+     */
+    static std::uint64_t bucketUpperBound(int bucket);
+
+    /**
+     * @brief Add every sample of another histogram to this one
+     */
+    void merge(const Histogram& other);
+
+    /**
+     * @brief Discard all samples
+     */
+    void reset();
+
+private:
+    static int bucketIndex(std::uint64_t value);
+
+    std::array<std::atomic<std::uint64_t>, BucketCount> buckets;
+    std::atomic<std::uint64_t> count;
+    std::atomic<std::uint64_t> sum;
+    std::atomic<std::uint64_t> max;
+};
+
+} // namespace IsometricMUD
@@ -2,13 +2,39 @@
 
 #include <SFML/Graphics.hpp>
 #include "Vector3D.hpp"
+#include "TileBatch.hpp"
+#include "DrawList.hpp"
+#include "TextureAtlas.hpp"
+#include "TileChunkCache.hpp"
 #include <memory>
 #include <vector>
 
 namespace IsometricMUD {
 
+/**
+ * @brief What the engine drew and skipped since the last resetStats()
+ */
+struct RenderStats {
+    size_t chunksDrawn = 0;
+    size_t chunksCulled = 0;
+    size_t chunkTilesDrawn = 0;     // Tiles inside drawn chunks
+    size_t chunkTilesCulled = 0;
+    size_t tilesDrawn = 0;          // Tiles given one at a time (renderTile, addTile, addToDrawList)
+    size_t tilesCulled = 0;
+    float sortMs = 0.0f;            // Time spent sorting draw lists
+};
+
 /**
  * @brief Core isometric rendering engine
+ *
+ * Everything outside the window is culled before any vertex work: single
+ * tiles are tested against the view on their way in, and cached chunks by
+ * the screen area they cover.
+ *
+ * With an uploaded TextureAtlas set, batches, chunks and draw lists are
+ * drawn with its first page bound. Tiles given a sprite from
+ * getTileSprite() or getEntitySprite() are textured, the rest stay flat,
+ * and nothing switches texture mid-layer.
  */
 class IsometricEngine {
 public:
@@ -22,8 +48,86 @@ public:
 
     /**
      * @brief Render a tile at a given 3D position
+     *
+     * One draw call per tile; fine for a cursor or a handful of markers.
+     * Use a TileBatch for anything larger. Off-screen tiles are skipped.
+     */
+    void renderTile(sf::RenderTarget& target, const Vector3D& position, const sf::Color& color);
+
+    /**
+     * @brief Append a tile at a given 3D position to a batch, unless it is off screen
+     * @return False if the tile was culled
+     */
+    bool addTile(TileBatch& batch, const Vector3D& position, const sf::Color& color,
+                 const sf::IntRect& sprite = sf::IntRect());
+
+    /**
+     * @brief Draw a whole batch in one call, seen from the current camera
+     */
+    void renderBatch(sf::RenderTarget& target, const TileBatch& batch) const;
+
+    /**
+     * @brief Add a tile or entity at a given 3D position to a draw list, unless it is off screen
+     * @return False if the item was culled
+     */
+    bool addToDrawList(DrawList& list, const Vector3D& position, const sf::Color& color, DrawLayer layer,
+                       const sf::IntRect& sprite = sf::IntRect());
+
+    /**
+     * @brief Sort a draw list into painter's order and draw it in one call
+     *
+     * Everything already drawn ends up behind the list; use renderScene()
+     * to draw it among the level's chunks.
+     */
+    void renderDrawList(sf::RenderTarget& target, DrawList& list);
+
+    /**
+     * @brief Rebuild the cache's changed chunks, then draw the visible ones from the current camera
+     */
+    void renderChunks(sf::RenderTarget& target, TileChunkCache& cache);
+
+    /**
+     * @brief renderChunks() with a draw list merged in, so level tiles in front of an item cover it
+     *
+     * Chunks are drawn by diagonal (cx + cy) and the sorted list by x + y.
+     * Before each diagonal's chunks go the items lying wholly behind it, one
+     * call per slice. An item therefore comes after the ground under it and
+     * before every later diagonal; only tiles on the diagonal just before
+     * it can still be drawn under it.
+     */
+    void renderScene(sf::RenderTarget& target, TileChunkCache& cache, DrawList& list);
+
+    /**
+     * @brief Part of projected world space the window shows from the current camera
+     *
+     * Projected space is Vector3D::toIsometric's output, so the height
+     * offset is already applied: a tile is visible when its diamond
+     * overlaps this rectangle.
      */
-    void renderTile(sf::RenderWindow& window, const Vector3D& position, const sf::Color& color);
+    sf::FloatRect getViewRect() const;
+
+    /**
+     * @brief Whether any part of the tile (or its sprite) at a position is in the window
+     */
+    bool isVisible(const Vector3D& position, const sf::IntRect& sprite = sf::IntRect()) const;
+
+    /**
+     * @brief Draw with this atlas's first page bound (nullptr: untextured)
+     */
+    void setAtlas(const TextureAtlas* textureAtlas);
+
+    /**
+     * @brief Sprite of a tile type on the bound page; empty if there is none yet
+     */
+    sf::IntRect getTileSprite(int tileType) const;
+
+    /**
+     * @brief Sprite of an entity kind on the bound page; empty if there is none yet
+     */
+    sf::IntRect getEntitySprite(int entityKind) const;
+
+    const RenderStats& getStats() const { return stats; }
+    void resetStats() { stats = RenderStats(); }
 
     /**
      * @brief Set camera position for viewing
@@ -46,10 +150,21 @@ public:
     Vector3D screenToWorld(const sf::Vector2f& screenPos, float z = 0.0f) const;
 
 private:
+    /**
+     * @brief States that move projected world space to the screen for the current camera
+     */
+    sf::RenderStates getCameraStates() const;
+
+    void sortDrawList(DrawList& list);
+    void recordChunkStats(const TileChunkCache& cache, size_t chunksDrawn, size_t tilesDrawn);
+
     Vector3D cameraPosition;
     int windowWidth;
     int windowHeight;
     sf::Vector2f offset; // Screen offset for centering
+    RenderStats stats;
+    const TextureAtlas* atlas;
+    TileBatch drawListBatch;    // Refilled by every renderDrawList() and renderScene() slice
 };
 
 } // namespace IsometricMUD
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Vector3D.hpp"
+#include <string>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Tile types the editor can place
+ */
+enum class TileType {
+    GRASS,
+    STONE,
+    WOOD,
+    WATER,
+    SAND
+};
+
+/**
+ * @brief One tile of a level
+ */
+struct TileData {
+    Vector3D position;
+    int tileType;
+    std::string scriptName;
+};
+
+/**
+ * @brief Reads and writes the editor's level files
+ */
+class LevelFile {
+public:
+    /**
+     * @brief Write tiles to a level file
+     */
+    static bool save(const std::string& filename, const std::vector<TileData>& tiles);
+
+    /**
+     * @brief Read a level file, replacing the contents of tiles
+     * @return False if the file can't be opened or is truncated
+     */
+    static bool load(const std::string& filename, std::vector<TileData>& tiles);
+
+    /**
+     * @brief Whether a tile of this type blocks movement and can be stood on
+     */
+    static bool isSolid(int tileType);
+};
+
+} // namespace IsometricMUD
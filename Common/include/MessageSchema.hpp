@@ -0,0 +1,151 @@
+#pragma once
+
+#include "WireCodec.hpp"
+#include "NetworkProtocol.hpp"
+#include "Vector3D.hpp"
+#include <string_view>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Field codecs used to describe message layouts
+ *
+ * Each codec names the C++ type it carries (value_type) and knows how to
+ * write and read it. MessageSchema strings them together at compile time.
+ */
+namespace Field {
+
+/**
+ * @brief Unsigned integer as a LEB128 varint (ids, counts, sequences)
+ */
+struct VarUInt {
+    using value_type = sf::Uint32;
+    static void write(WireWriter& writer, sf::Uint32 value) { writer.writeVarUInt(value); }
+    static void read(WireReader& reader, sf::Uint32& value) {
+        value = static_cast<sf::Uint32>(reader.readVarUInt());
+    }
+};
+
+/**
+ * @brief Signed integer as a zigzag varint
+ */
+struct VarSInt {
+    using value_type = sf::Int32;
+    static void write(WireWriter& writer, sf::Int32 value) { writer.writeVarSInt(value); }
+    static void read(WireReader& reader, sf::Int32& value) {
+        value = static_cast<sf::Int32>(reader.readVarSInt());
+    }
+};
+
+/**
+ * @brief Enum packed into a fixed number of bits
+ *
+ * Placed first in a schema, it shares the header byte with the packet type.
+ */
+template <typename Enum, int Bits>
+struct PackedEnum {
+    using value_type = Enum;
+    static void write(WireWriter& writer, Enum value) {
+        writer.writeBits(static_cast<sf::Uint32>(value), Bits);
+    }
+    static void read(WireReader& reader, Enum& value) {
+        value = static_cast<Enum>(reader.readBits(Bits));
+    }
+};
+
+/**
+ * @brief World position as three 32-bit floats
+ */
+struct Position {
+    using value_type = Vector3D;
+    static void write(WireWriter& writer, const Vector3D& value) {
+        writer.writeFloat(value.x);
+        writer.writeFloat(value.y);
+        writer.writeFloat(value.z);
+    }
+    static void read(WireReader& reader, Vector3D& value) {
+        value.x = reader.readFloat();
+        value.y = reader.readFloat();
+        value.z = reader.readFloat();
+    }
+};
+
+/**
+ * @brief Length-prefixed bytes; decodes to a view into the receive buffer
+ */
+struct Text {
+    using value_type = std::string_view;
+    static void write(WireWriter& writer, std::string_view value) {
+        writer.writeVarUInt(value.size());
+        writer.writeBytes(value.data(), value.size());
+    }
+    static void read(WireReader& reader, std::string_view& value) {
+        sf::Uint64 length = reader.readVarUInt();
+        value = reader.readBytes(static_cast<size_t>(length));
+    }
+};
+
+} // namespace Field
+
+/**
+ * @brief Compile-time description of one message layout
+ *
+ * Every message starts with the packet type in the low PacketTypeBits of the
+ * first byte; leading PackedEnum fields fill the remaining bits of that byte.
+ * encode() and decode() are generated from the field list, so adding a
+ * message is a one-line alias.
+ */
+template <PacketType Type, typename... Fields>
+struct MessageSchema {
+    static constexpr PacketType type = Type;
+
+    static bool encode(WireWriter& writer, const typename Fields::value_type&... values) {
+        writer.writeBits(static_cast<sf::Uint32>(Type), PacketTypeBits);
+        (Fields::write(writer, values), ...);
+        return writer.finish();
+    }
+
+    static bool decode(WireReader& reader, typename Fields::value_type&... values) {
+        if (reader.readBits(PacketTypeBits) != static_cast<sf::Uint32>(Type)) {
+            return false;
+        }
+        (Fields::read(reader, values), ...);
+        return reader.ok();
+    }
+};
+
+/**
+ * @brief Layouts of every message in the protocol
+ */
+namespace Messages {
+
+using Connect = MessageSchema<PacketType::CONNECT,
+    Field::VarUInt, Field::VarUInt, Field::VarUInt>;                   // client, udp token, udp port
+using Move = MessageSchema<PacketType::MOVE,
+    Field::PackedEnum<Direction, 3>, Field::VarUInt>;                  // direction, entity
+using UpdatePosition = MessageSchema<PacketType::UPDATE_POSITION,
+    Field::VarUInt, Field::Position>;                                  // entity, position
+using SpawnEntity = MessageSchema<PacketType::SPAWN_ENTITY,
+    Field::VarUInt, Field::Position>;                                  // entity, position
+using RemoveEntity = MessageSchema<PacketType::REMOVE_ENTITY,
+    Field::VarUInt>;                                                   // entity
+using Chat = MessageSchema<PacketType::CHAT,
+    Field::PackedEnum<ChatChannel, 3>, Field::VarUInt, Field::Text>;   // channel, target or sender, message
+using ScriptEvent = MessageSchema<PacketType::SCRIPT_EVENT,
+    Field::Text>;                                                      // event name
+using SnapshotAck = MessageSchema<PacketType::SNAPSHOT_ACK,
+    Field::VarUInt>;                                                   // snapshot sequence
+using Login = MessageSchema<PacketType::LOGIN,
+    Field::Text>;                                                      // player name
+using Redirect = MessageSchema<PacketType::REDIRECT,
+    Field::VarUInt, Field::VarUInt>;                                   // port, token
+using Resume = MessageSchema<PacketType::RESUME,
+    Field::VarUInt>;                                                   // token
+using ChatSubscribe = MessageSchema<PacketType::CHAT_SUBSCRIBE,
+    Field::PackedEnum<ChatChannel, 3>, Field::VarUInt, Field::VarUInt>; // channel, topic, 1 = join / 0 = leave
+
+// SNAPSHOT carries a variable-length entity list; see SnapshotCodec
+
+} // namespace Messages
+
+} // namespace IsometricMUD
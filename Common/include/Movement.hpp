@@ -4,6 +4,8 @@
 
 namespace IsometricMUD {
 
+class VoxelGrid;
+
 /**
  * @brief Enumeration for the 6 degrees of movement
  */
@@ -44,6 +46,15 @@ public:
      * @return True if movement is valid
      */
     static bool isValidMovement(const Vector3D& from, const Vector3D& to);
+
+    /**
+     * @brief Check movement against a level's terrain
+     * @param grid Occupancy of the level; an empty grid allows any short move
+     * @param from Starting position
+     * @param to Ending position
+     * @return True if the move is short enough and ends on walkable ground
+     */
+    static bool isValidMovement(const VoxelGrid& grid, const Vector3D& from, const Vector3D& to);
 };
 
 } // namespace IsometricMUD
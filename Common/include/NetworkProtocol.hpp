@@ -4,6 +4,7 @@
 #include "Vector3D.hpp"
 #include "Movement.hpp"
 #include <string>
+#include <vector>
 
 namespace IsometricMUD {
 
@@ -18,14 +19,58 @@ enum class PacketType : sf::Uint8 {
     UPDATE_POSITION,
     SPAWN_ENTITY,
     REMOVE_ENTITY,
-    SCRIPT_EVENT
+    SCRIPT_EVENT,
+    BATCH,          // Several length-prefixed messages in one packet
+    SNAPSHOT,       // Delta-compressed view of every visible entity (see Snapshot.hpp)
+    SNAPSHOT_ACK,   // Client confirms a snapshot, making it the next baseline
+    LOGIN,          // Client names its player so the server can restore saved state
+    REDIRECT,       // Server hands the player to another zone server (port, token)
+    RESUME,         // Client presents a redirect token to the zone server it was sent to
+    CHAT_SUBSCRIBE  // Client joins or leaves a chat channel
 };
 
+/**
+ * @brief Audience of a chat message
+ */
+enum class ChatChannel : sf::Uint8 {
+    GLOBAL,         // Everyone subscribed, on every shard
+    ZONE,           // Everyone subscribed on this shard
+    PARTY,          // Members of one party, named by a number
+    WHISPER,        // One client, named by its id
+    PROXIMITY,      // Players close to the sender
+    COUNT
+};
+
+/**
+ * @brief The packet type occupies the low bits of a message's first byte;
+ * the remaining bits are free for small enum fields (see MessageSchema.hpp)
+ */
+constexpr int PacketTypeBits = 5;
+constexpr sf::Uint8 PacketTypeMask = (1 << PacketTypeBits) - 1;
+
+/**
+ * @brief Largest single message the compact encoders will produce
+ */
+constexpr size_t MaxMessageSize = 4096;
+
+/**
+ * @brief Longest player name a LOGIN may carry
+ */
+constexpr size_t MaxPlayerNameLength = 32;
+
 /**
  * @brief Network protocol handler
  */
 class NetworkProtocol {
 public:
+    /**
+     * @brief Create the server's welcome packet
+     * @param udpToken Secret the client quotes to bind its UDP endpoint
+     * @param udpPort Server's UDP port, or 0 if movement stays on TCP
+     */
+    static sf::Packet createConnectPacket(sf::Uint32 clientId, sf::Uint32 udpToken,
+                                          unsigned short udpPort);
+
     /**
      * @brief Create a movement packet
      */
@@ -36,16 +81,97 @@ public:
      */
     static sf::Packet createPositionPacket(sf::Uint32 entityId, const Vector3D& position);
 
+    /**
+     * @brief Create a packet announcing an entity that came into view
+     */
+    static sf::Packet createSpawnPacket(sf::Uint32 entityId, const Vector3D& position);
+
+    /**
+     * @brief Create a packet telling a client to forget an entity
+     */
+    static sf::Packet createRemovePacket(sf::Uint32 entityId);
+
     /**
      * @brief Create a chat message packet
+     * @param channel Where it goes
+     * @param peer From a client: the party or whisper recipient (0 otherwise).
+     *             From the server: the sender's entity id
+     */
+    static sf::Packet createChatPacket(ChatChannel channel, sf::Uint32 peer, const std::string& message);
+
+    /**
+     * @brief Create a packet joining or leaving a chat channel
+     * @param topic The party number for PARTY; ignored for other channels
+     */
+    static sf::Packet createChatSubscribePacket(ChatChannel channel, sf::Uint32 topic, bool subscribe);
+
+    /**
+     * @brief Create a script event packet naming the event to fire
+     */
+    static sf::Packet createScriptEventPacket(const std::string& eventName);
+
+    /**
+     * @brief Create a packet acknowledging a received snapshot
+     */
+    static sf::Packet createSnapshotAckPacket(sf::Uint32 sequence);
+
+    /**
+     * @brief Create a packet naming the player whose saved state to resume
+     */
+    static sf::Packet createLoginPacket(const std::string& playerName);
+
+    /**
+     * @brief Create a packet sending the client to the zone server on another port
+     */
+    static sf::Packet createRedirectPacket(unsigned short port, sf::Uint32 token);
+
+    /**
+     * @brief Create a packet claiming the player handed over under a redirect token
+     */
+    static sf::Packet createResumePacket(sf::Uint32 token);
+
+    /**
+     * @brief Start an empty batch packet
      */
-    static sf::Packet createChatPacket(const std::string& message);
+    static void beginBatch(sf::Packet& batch);
+
+    /**
+     * @brief Append a complete message to a batch packet
+     */
+    static void appendToBatch(sf::Packet& batch, const sf::Packet& message);
+
+    /**
+     * @brief Split a received batch packet back into its messages
+     * @return False if the batch is truncated or malformed
+     */
+    static bool unpackBatch(const sf::Packet& batch, std::vector<sf::Packet>& messages);
 
     /**
      * @brief Parse packet type from a received packet
      */
     static PacketType getPacketType(sf::Packet& packet);
 
+    /**
+     * @brief Read the packet type straight from a receive buffer
+     */
+    static PacketType getPacketType(const void* data, size_t size);
+
+    /**
+     * @brief Lower-case name of a packet type, for logs and metrics
+     */
+    static const char* getPacketTypeName(PacketType type);
+
+    /**
+     * @brief Lower-case name of a chat channel, for logs and command lines
+     */
+    static const char* getChatChannelName(ChatChannel channel);
+
+    /**
+     * @brief Extract the session details from the server's welcome packet
+     */
+    static bool parseConnectPacket(sf::Packet& packet, sf::Uint32& clientId, sf::Uint32& udpToken,
+                                   unsigned short& udpPort);
+
     /**
      * @brief Extract movement data from packet
      */
@@ -55,6 +181,47 @@ public:
      * @brief Extract position data from packet
      */
     static bool parsePositionPacket(sf::Packet& packet, sf::Uint32& entityId, Vector3D& position);
+
+    /**
+     * @brief Extract spawn data from packet
+     */
+    static bool parseSpawnPacket(sf::Packet& packet, sf::Uint32& entityId, Vector3D& position);
+
+    /**
+     * @brief Extract the entity id from a remove packet
+     */
+    static bool parseRemovePacket(sf::Packet& packet, sf::Uint32& entityId);
+
+    /**
+     * @brief Extract the channel, peer and text from a chat packet
+     */
+    static bool parseChatPacket(sf::Packet& packet, ChatChannel& channel, sf::Uint32& peer,
+                                std::string& message);
+
+    /**
+     * @brief Extract the event name from a script event packet
+     */
+    static bool parseScriptEventPacket(sf::Packet& packet, std::string& eventName);
+
+    /**
+     * @brief Extract the sequence number from a snapshot acknowledgement
+     */
+    static bool parseSnapshotAckPacket(sf::Packet& packet, sf::Uint32& sequence);
+
+    /**
+     * @brief Extract the player name from a login packet
+     */
+    static bool parseLoginPacket(sf::Packet& packet, std::string& playerName);
+
+    /**
+     * @brief Extract the zone server's port and token from a redirect packet
+     */
+    static bool parseRedirectPacket(sf::Packet& packet, unsigned short& port, sf::Uint32& token);
+
+    /**
+     * @brief Extract the token from a resume packet
+     */
+    static bool parseResumePacket(sf::Packet& packet, sf::Uint32& token);
 };
 
 } // namespace IsometricMUD
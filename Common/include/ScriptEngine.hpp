@@ -1,9 +1,11 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <map>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include <functional>
 
 namespace IsometricMUD {
@@ -36,15 +38,22 @@ struct ScriptVariable {
         float floatValue;
         bool boolValue;
     };
-    std::string stringValue;
+    std::pmr::string stringValue;   // Copies are made on the default resource
     
     ScriptVariable() : type(Type::INT), intValue(0) {}
+    explicit ScriptVariable(std::pmr::memory_resource* resource)
+        : type(Type::INT), intValue(0), stringValue(resource) {}
 };
 
+/**
+ * @brief Arguments to a script function
+ */
+using ScriptArgs = std::pmr::vector<ScriptVariable>;
+
 /**
  * @brief Script function
  */
-using ScriptFunction = std::function<void(ScriptEngine&, const std::vector<ScriptVariable>&)>;
+using ScriptFunction = std::function<void(ScriptEngine&, const ScriptArgs&)>;
 
 /**
  * @brief Papyrus-like scripting engine
@@ -62,7 +71,19 @@ public:
     /**
      * @brief Execute a script function
      */
-    bool executeFunction(const std::string& functionName, const std::vector<ScriptVariable>& args = {});
+    bool executeFunction(std::string_view functionName, const ScriptArgs& args = ScriptArgs());
+
+    /**
+     * @brief Whether a loaded script declares name with Event (not Function, and not a native)
+     */
+    bool isEvent(std::string_view name) const;
+
+    /**
+     * @brief Allocate the arguments a script builds while running from this resource
+     *
+     * Only valid while executeFunction() runs, so a per-tick arena works.
+     */
+    void setTemporaryResource(std::pmr::memory_resource* resource) { temporaries = resource; }
 
     /**
      * @brief Register a native function
@@ -87,15 +108,18 @@ public:
 private:
     struct ScriptFunctionDef {
         std::string name;
+        bool event = false;
         std::vector<std::string> parameters;
         std::vector<std::string> body;
     };
 
-    std::map<std::string, ScriptVariable> variables;
-    std::map<std::string, ScriptFunction> nativeFunctions;
-    std::map<std::string, ScriptFunctionDef> scriptFunctions;
+    // Transparent comparators let lookups take a string_view without building a string
+    std::map<std::string, ScriptVariable, std::less<>> variables;
+    std::map<std::string, ScriptFunction, std::less<>> nativeFunctions;
+    std::map<std::string, ScriptFunctionDef, std::less<>> scriptFunctions;
+    std::pmr::memory_resource* temporaries = std::pmr::get_default_resource();
     
-    void executeLine(const std::string& line);
+    void executeLine(std::string_view line);
 };
 
 } // namespace IsometricMUD
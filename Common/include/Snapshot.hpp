@@ -0,0 +1,96 @@
+#pragma once
+
+#include <SFML/Config.hpp>
+#include "Vector3D.hpp"
+#include "WireCodec.hpp"
+#include <array>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief One entity's position quantized to whole grid units
+ */
+struct SnapshotEntity {
+    sf::Uint32 entityId;
+    sf::Int32 x, y, z;
+
+    bool samePosition(const SnapshotEntity& other) const {
+        return x == other.x && y == other.y && z == other.z;
+    }
+};
+
+/**
+ * @brief Everything one client can see at one tick
+ */
+struct Snapshot {
+    sf::Uint32 sequence = 0;
+    std::vector<SnapshotEntity> entities; // Sorted by entityId
+
+    /**
+     * @brief Add an entity; callers must add in increasing id order
+     */
+    void add(sf::Uint32 entityId, const Vector3D& position);
+
+    const SnapshotEntity* find(sf::Uint32 entityId) const;
+
+    static sf::Int32 quantize(float coordinate);
+    static Vector3D toPosition(const SnapshotEntity& entity);
+};
+
+/**
+ * @brief Small ring of recent snapshots, looked up by sequence number
+ *
+ * The server keeps the snapshots it sent so it can delta against whichever
+ * one the client acknowledges; the client keeps the ones it received so it
+ * can resolve the baseline a delta refers to.
+ */
+class SnapshotHistory {
+public:
+    static const size_t Capacity = 32;
+
+    void store(const Snapshot& snapshot);
+    const Snapshot* find(sf::Uint32 sequence) const;
+    void clear();
+
+private:
+    std::array<Snapshot, Capacity> slots;
+};
+
+/**
+ * @brief Encoder and decoder for delta-compressed SNAPSHOT messages
+ *
+ * A snapshot is sent relative to a baseline the client has acknowledged
+ * (sequence 0 means "no baseline", i.e. a full snapshot). Entities whose
+ * quantized position is unchanged are omitted; entities that disappeared
+ * are listed by id. Ids are delta-coded in ascending order, and single-step
+ * moves - the common case on the movement grid - pack into one byte.
+ */
+class SnapshotCodec {
+public:
+    /**
+     * @brief Upper bound on the encoded size for a buffer allocation
+     */
+    static size_t maxEncodedSize(const Snapshot& baseline, const Snapshot& current);
+
+    /**
+     * @brief Encode current as a delta against baseline
+     * @return False if the buffer overflowed
+     */
+    static bool encode(WireWriter& writer, const Snapshot& baseline, const Snapshot& current);
+
+    /**
+     * @brief Read the sequence numbers at the start of a SNAPSHOT message
+     */
+    static bool readHeader(WireReader& reader, sf::Uint32& sequence, sf::Uint32& baselineSequence);
+
+    /**
+     * @brief Rebuild the full snapshot from its baseline and the delta
+     *
+     * Call after readHeader() on the same reader; the caller sets the
+     * result's sequence from the header.
+     */
+    static bool decode(WireReader& reader, const Snapshot& baseline, Snapshot& result);
+};
+
+} // namespace IsometricMUD
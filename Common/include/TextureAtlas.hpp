@@ -0,0 +1,160 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Places rectangles on a fixed-size page, lowest spot first
+ *
+ * Keeps the page's skyline (the top edge of everything placed so far) as
+ * segments. A rectangle goes where its bottom would sit lowest, then
+ * furthest left; that wastes little for sprites of similar height.
+ */
+class SkylinePacker {
+public:
+    SkylinePacker(unsigned int width, unsigned int height);
+
+    /**
+     * @brief Reserve space for a rectangle
+     * @return False if it doesn't fit anywhere on the page
+     */
+    bool insert(unsigned int width, unsigned int height, sf::Vector2u& position);
+
+private:
+    struct Segment {
+        unsigned int x;
+        unsigned int y;
+        unsigned int width;
+    };
+
+    /**
+     * @brief Height a rectangle would sit at starting on a segment, or -1
+     */
+    long fit(size_t index, unsigned int width, unsigned int height) const;
+
+    std::vector<Segment> skyline;
+    unsigned int width;
+    unsigned int height;
+};
+
+/**
+ * @brief Where a sprite lives in a TextureAtlas
+ */
+struct AtlasRegion {
+    sf::Uint16 page = 0;
+    sf::Uint16 left = 0;
+    sf::Uint16 top = 0;
+    sf::Uint16 width = 0;       // 0: no sprite
+    sf::Uint16 height = 0;
+
+    sf::IntRect getTextureRect() const { return sf::IntRect(left, top, width, height); }
+    bool isValid() const { return width > 0; }
+};
+
+/**
+ * @brief Tile and entity sprites packed into a few large textures
+ *
+ * Sprites are added as images, packed onto 1024x1024 pages with a
+ * SkylinePacker, tile sprites first so they share the first page, and
+ * looked up by tile type (TileData::tileType) or entity kind in small
+ * tables of AtlasRegions. Every page keeps a white texel at (0, 0), so
+ * untextured vertices (texture coordinates 0, 0) drawn with a page bound
+ * show their plain vertex colour: flat tiles and sprites mix in one draw.
+ *
+ * Packing only touches images, so build() can run on any thread;
+ * buildAsync() runs it on a worker while the caller carries on. upload()
+ * then turns the pages into textures on the thread that owns the GL
+ * context.
+ */
+class TextureAtlas {
+public:
+    static const unsigned int PageSize = 1024;
+
+    TextureAtlas();
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    // Before build() only
+    void addTileSprite(int tileType, const sf::Image& image);
+    void addEntitySprite(int entityKind, const sf::Image& image);
+
+    /**
+     * @brief Pack every sprite into page images
+     * @return False if a sprite doesn't fit on a page beside the white block
+     */
+    bool build();
+
+    /**
+     * @brief Run build() on a worker thread
+     */
+    void buildAsync();
+
+    /**
+     * @brief Check whether packing has finished (successfully or not)
+     */
+    bool isBuilt() const { return built.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Create a texture per page (GL thread); waits for buildAsync() to finish
+     * @return False if packing failed or a texture couldn't be created
+     */
+    bool upload();
+
+    bool isUploaded() const { return !textures.empty(); }
+
+    /**
+     * @brief Region of a tile type's sprite; invalid if it has none
+     */
+    const AtlasRegion& getTileRegion(int tileType) const;
+
+    /**
+     * @brief Region of an entity kind's sprite; invalid if it has none
+     */
+    const AtlasRegion& getEntityRegion(int entityKind) const;
+
+    size_t getPageCount() const { return pages.size(); }
+
+    /**
+     * @brief Texture of a page after upload(), else nullptr
+     */
+    const sf::Texture* getTexture(size_t page) const;
+
+    /**
+     * @brief Image of a page after build(), for saving a baked atlas
+     */
+    const sf::Image& getPageImage(size_t page) const { return pages[page]; }
+
+    /**
+     * @brief A flat tile the way IsometricEngine::renderTile draws it, for levels without art
+     */
+    static sf::Image makeTileSprite(const sf::Color& color);
+
+private:
+    struct Sprite {
+        bool entity;
+        int index;
+        sf::Image image;
+    };
+
+    static AtlasRegion& regionFor(std::vector<AtlasRegion>& table, int index);
+
+    std::vector<Sprite> sprites;
+    std::vector<AtlasRegion> tileRegions;       // Indexed by tile type
+    std::vector<AtlasRegion> entityRegions;     // Indexed by entity kind
+    std::vector<sf::Image> pages;
+    std::vector<std::unique_ptr<sf::Texture>> textures;
+
+    std::thread worker;
+    std::atomic<bool> built;
+    bool buildSucceeded;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Bump allocator for objects that live no longer than one tick
+ *
+ * A memory_resource, so std::pmr containers and strings can draw from it.
+ * Allocation moves a pointer through one block; deallocation does nothing,
+ * and reset() takes everything back at once when the tick ends. A tick that
+ * outgrows the block spills into extra blocks from the heap, and the next
+ * reset() replaces them all with one block big enough for that tick, so a
+ * steady load settles into no heap calls at all.
+ *
+ * Nothing allocated from the arena may be touched after reset(). Containers
+ * that outlive a tick must hand their storage back first with release().
+ * Not thread-safe: one arena belongs to one thread.
+ */
+class TickArena : public std::pmr::memory_resource {
+public:
+    explicit TickArena(size_t initialCapacity = 256 * 1024);
+    ~TickArena() override;
+
+    TickArena(const TickArena&) = delete;
+    TickArena& operator=(const TickArena&) = delete;
+
+    /**
+     * @brief Free everything allocated since the last reset
+     */
+    void reset();
+
+    /**
+     * @brief Drop a container's storage so the arena can be reset under it
+     *
+     * The container is left empty, still bound to the same resource.
+     */
+    template <typename Container>
+    static void release(Container& container) {
+        Container(container.get_allocator()).swap(container);
+    }
+
+    size_t getUsed() const { return spilledBytes + offset; }
+    size_t getCapacity() const { return capacity; }
+
+    /**
+     * @brief Most bytes any one tick has used
+     */
+    size_t getHighWater() const { return highWater; }
+
+    /**
+     * @brief Extra blocks taken from the heap because a tick outgrew the arena
+     */
+    std::uint64_t getSpillCount() const { return spillCount; }
+
+private:
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void*, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    static char* allocateBlock(size_t size);
+    static void freeBlock(char* data);
+
+    char* block;                // Current block
+    size_t blockSize;
+    size_t offset;              // Bytes used in the current block
+    size_t capacity;            // Size of the main block
+    char* mainBlock;
+    std::vector<Block> spills;  // Extra blocks this tick, freed by reset()
+    size_t spilledBytes;        // Bytes used in blocks before the current one
+    size_t highWater;
+    std::uint64_t spillCount;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Tiles collected into one vertex array and drawn with a single call
+ *
+ * Each tile is the same 64x32 diamond with a 1px black outline that
+ * IsometricEngine::renderTile draws, built from triangles: an opaque tile
+ * is a black diamond one outline wider with the fill on top (12 vertices),
+ * a translucent one is its fill plus a separate outline ring (30 vertices)
+ * so the black doesn't show through. A tile given a sprite is instead one
+ * textured quad (6 vertices) the size of the sprite, centred on the tile
+ * and tinted by its colour; draw the batch with the TextureAtlas page the
+ * sprite lives on. Flat tiles keep texture coordinates (0, 0), which every
+ * atlas page keeps white, so they can share that draw. Tiles are drawn in
+ * the order they were added, so add them back to front.
+ *
+ * Positions are in projected world space; IsometricEngine::renderBatch
+ * applies the camera when drawing, so a batch stays valid while the camera
+ * moves.
+ */
+class TileBatch : public sf::Drawable {
+public:
+    TileBatch();
+
+    /**
+     * @brief Append a tile centred on a projected position
+     * @param sprite Area of the bound texture to draw instead of a flat diamond (empty: none)
+     */
+    void addTile(const sf::Vector2f& center, const sf::Color& color, const sf::IntRect& sprite = sf::IntRect());
+
+    /**
+     * @brief Area a tile centred on a projected position covers, outline and sprite included
+     */
+    static sf::FloatRect getTileBounds(const sf::Vector2f& center, const sf::IntRect& sprite = sf::IntRect());
+
+    /**
+     * @brief Drop every tile but keep the vertex storage for the next frame
+     */
+    void clear();
+
+    size_t getTileCount() const { return tileCount; }
+    size_t getVertexCount() const { return vertices.getVertexCount(); }
+    const sf::Vertex* getVertices() const { return tileCount > 0 ? &vertices[0] : nullptr; }
+    bool isEmpty() const { return tileCount == 0; }
+
+private:
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+
+    void appendDiamond(const sf::Vector2f& center, float halfWidth, float halfHeight, const sf::Color& color);
+
+    sf::VertexArray vertices;
+    size_t tileCount;
+};
+
+} // namespace IsometricMUD
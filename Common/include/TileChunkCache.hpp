@@ -0,0 +1,154 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include "TileBatch.hpp"
+#include "Vector3D.hpp"
+#include <climits>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Level tiles kept as prebuilt geometry, one buffer per chunk
+ *
+ * The level is split into columns of 16x16 tiles covering every height.
+ * Each chunk's tiles are projected and turned into triangles once and
+ * uploaded to an sf::VertexBuffer (kept as a vertex array where the driver
+ * has no buffer objects). Changing a tile marks only its chunk dirty, and
+ * update() rebuilds just the dirty chunks. Geometry is in projected world
+ * space and IsometricEngine::renderChunks draws it through the camera
+ * transform, so a frame with no edits costs one draw call per visible
+ * chunk however many tiles they hold.
+ *
+ * Tiles inside a chunk are drawn back to front (by x + y, then z), and
+ * chunks by cx + cy. Tiles that overlap on screen are never more than a
+ * chunk apart, so this gives the same order as sorting every tile.
+ *
+ * Each chunk remembers the screen area its tiles cover. drawVisible() only
+ * walks the chunk diagonals (cx + cy) that the view can reach given the
+ * level's height range, and skips chunks whose area misses the view. It
+ * can stop before each diagonal so the caller can draw its own
+ * back-to-front items in between.
+ */
+class TileChunkCache {
+public:
+    static constexpr int ChunkBits = 4;
+    static constexpr int ChunkSize = 1 << ChunkBits;
+
+    TileChunkCache();
+
+    /**
+     * @brief Add a tile, or change the one already at that position
+     * @param sprite Atlas area to draw instead of a flat diamond, tinted by color (empty: none)
+     */
+    void setTile(const Vector3D& position, const sf::Color& color, const sf::IntRect& sprite = sf::IntRect());
+
+    /**
+     * @brief Remove the tile at a position, if any
+     */
+    void removeTile(const Vector3D& position);
+
+    void clear();
+
+    /**
+     * @brief Rebuild the geometry of every chunk changed since the last update
+     */
+    void update();
+
+    /**
+     * @brief Draw the chunks that overlap a projected view rectangle
+     * @param tilesDrawn Set to the number of tiles in the drawn chunks
+     * @return Chunks drawn
+     */
+    size_t drawVisible(sf::RenderTarget& target, const sf::RenderStates& states, const sf::FloatRect& view,
+                       size_t& tilesDrawn) const {
+        return drawVisible(target, states, view, tilesDrawn, [](int) {});
+    }
+
+    /**
+     * @brief drawVisible(), calling beforeDiagonal(d) ahead of the chunks drawn on each diagonal d = cx + cy
+     *
+     * Diagonals come in increasing order, and only those with a visible chunk.
+     */
+    template <typename Callback>
+    size_t drawVisible(sf::RenderTarget& target, const sf::RenderStates& states, const sf::FloatRect& view,
+                       size_t& tilesDrawn, Callback&& beforeDiagonal) const {
+        tilesDrawn = 0;
+        int firstDiagonal, lastDiagonal;
+        if (!getVisibleDiagonals(view, firstDiagonal, lastDiagonal)) {
+            return 0;
+        }
+        
+        size_t drawn = 0;
+        int diagonal = INT_MIN;
+        auto it = chunks.lower_bound(ChunkKey(firstDiagonal, INT_MIN));
+        for (; it != chunks.end() && it->first.first <= lastDiagonal; ++it) {
+            const Chunk& chunk = it->second;
+            if (!chunk.bounds.intersects(view)) {
+                continue;
+            }
+            if (it->first.first != diagonal) {
+                diagonal = it->first.first;
+                beforeDiagonal(diagonal);
+            }
+            drawChunk(target, states, chunk);
+            drawn++;
+            tilesDrawn += chunk.tiles.size();
+        }
+        return drawn;
+    }
+
+    size_t getChunkCount() const { return chunks.size(); }
+    size_t getTileCount() const { return tileCount; }
+
+    /**
+     * @brief Chunks rebuilt by update() so far
+     */
+    size_t getRebuildCount() const { return rebuildCount; }
+
+private:
+    struct ChunkTile {
+        Vector3D position;
+        sf::Color color;
+        sf::IntRect sprite;
+    };
+
+    struct Chunk {
+        std::vector<ChunkTile> tiles;
+        TileBatch geometry;         // Only kept when there is no vertex buffer
+        sf::VertexBuffer buffer;
+        sf::FloatRect bounds;       // Projected area of every tile, outlines included
+        bool dirty = false;
+    };
+
+    // (cx + cy, cx): iterating the map visits chunks back to front
+    using ChunkKey = std::pair<int, int>;
+
+    static ChunkKey keyFor(const Vector3D& position);
+
+    /**
+     * @brief Range of chunk diagonals the view can reach; false if there are no chunks
+     */
+    bool getVisibleDiagonals(const sf::FloatRect& view, int& firstDiagonal, int& lastDiagonal) const;
+    static void drawChunk(sf::RenderTarget& target, const sf::RenderStates& states, const Chunk& chunk);
+
+    void markDirty(const ChunkKey& key, Chunk& chunk);
+    void rebuild(Chunk& chunk);
+
+    std::map<ChunkKey, Chunk> chunks;
+    std::vector<ChunkKey> dirtyChunks;
+    size_t tileCount;
+    size_t rebuildCount;
+
+    // Height range of every tile added since the last clear, and how far
+    // the tallest reaches above and below its centre (never shrink)
+    float minZ;
+    float maxZ;
+    float tileHalfHeight;
+
+    bool useBuffers;
+};
+
+} // namespace IsometricMUD
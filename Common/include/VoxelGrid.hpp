@@ -0,0 +1,113 @@
+#pragma once
+
+#include "LevelFile.hpp"
+#include "Vector3D.hpp"
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Solid/empty occupancy of a level, for movement checks
+ *
+ * The level's bounding box is split into 16x16x16 chunks. Each chunk that
+ * holds any solid tile owns a 4096-bit bitset; a dense index maps chunk
+ * coordinates to bitsets, with empty chunks sharing none. A query is a
+ * bounds check, an index load and a bit test, whatever the level's size,
+ * and a 1024x1024x16 map of solid ground needs about 2 MB.
+ *
+ * A tile is the floor of the cell it occupies: a player at (x, y, z) stands
+ * on the tile at (x, y, z), and a tile at (x, y, z + 1) is a wall in its way.
+ */
+class VoxelGrid {
+public:
+    static constexpr int ChunkBits = 4;
+    static constexpr int ChunkSize = 1 << ChunkBits;
+    static constexpr int ChunkVolume = ChunkSize * ChunkSize * ChunkSize;
+
+    VoxelGrid();
+
+    /**
+     * @brief Rebuild the grid from a level's tiles
+     */
+    void build(const std::vector<TileData>& tiles);
+
+    void clear();
+
+    /**
+     * @brief True when no level is loaded
+     */
+    bool empty() const { return chunks.empty(); }
+
+    /**
+     * @brief Whether a solid tile occupies the cell (outside the level: no)
+     */
+    bool isSolid(int x, int y, int z) const {
+        unsigned int localX = static_cast<unsigned int>(x - originX);
+        unsigned int localY = static_cast<unsigned int>(y - originY);
+        unsigned int localZ = static_cast<unsigned int>(z - originZ);
+        if (localX >= sizeX || localY >= sizeY || localZ >= sizeZ) {
+            return false;
+        }
+        std::int32_t chunk = chunkIndex[((localZ >> ChunkBits) * chunksY + (localY >> ChunkBits)) * chunksX +
+                                        (localX >> ChunkBits)];
+        if (chunk < 0) {
+            return false;
+        }
+        const unsigned int mask = ChunkSize - 1;
+        return chunks[chunk][((localZ & mask) << (2 * ChunkBits)) | ((localY & mask) << ChunkBits) |
+                             (localX & mask)];
+    }
+
+    /**
+     * @brief Whether a player can stand in the cell: floor under it, no wall above
+     */
+    bool isWalkable(int x, int y, int z) const {
+        return isSolid(x, y, z) && !isSolid(x, y, z + 1);
+    }
+
+    bool isWalkable(const Vector3D& position) const;
+
+    /**
+     * @brief Change one cell after the grid was built
+     * @return False if the cell lies outside the grid, which never grows
+     */
+    bool setSolid(int x, int y, int z, bool solid);
+
+    // Bounds in cells; the grid covers whole chunks starting at the origin
+    int getOriginX() const { return originX; }
+    int getOriginY() const { return originY; }
+    int getOriginZ() const { return originZ; }
+    int getSizeX() const { return static_cast<int>(sizeX); }
+    int getSizeY() const { return static_cast<int>(sizeY); }
+    int getSizeZ() const { return static_cast<int>(sizeZ); }
+
+    size_t getChunkCount() const { return chunks.size(); }
+
+    /**
+     * @brief Bytes held by chunk bitsets and the chunk index
+     */
+    size_t getMemoryUsage() const;
+
+private:
+    using Chunk = std::bitset<ChunkVolume>;
+
+    std::int32_t& getChunkSlot(unsigned int localX, unsigned int localY, unsigned int localZ) {
+        return chunkIndex[((localZ >> ChunkBits) * chunksY + (localY >> ChunkBits)) * chunksX +
+                          (localX >> ChunkBits)];
+    }
+
+    int originX;
+    int originY;
+    int originZ;
+    unsigned int sizeX;         // Extent in cells, a whole number of chunks
+    unsigned int sizeY;
+    unsigned int sizeZ;
+    unsigned int chunksX;
+    unsigned int chunksY;
+    std::vector<std::int32_t> chunkIndex;   // -1 for chunks with nothing solid
+    std::vector<Chunk> chunks;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <SFML/Config.hpp>
+#include <cstddef>
+#include <string_view>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Compact binary writer over a caller-owned buffer
+ *
+ * Supports sub-byte bit fields (packed LSB-first into the current byte),
+ * LEB128 varints, fixed-width little-endian integers and raw bytes.
+ * Byte-aligned writes first close any partly filled bit byte. Writing past
+ * the end of the buffer sets an overflow flag instead of allocating.
+ */
+class WireWriter {
+public:
+    WireWriter(char* buffer, size_t capacity);
+
+    void writeBits(sf::Uint32 value, int bitCount);
+    void writeByte(sf::Uint8 value);
+    void writeVarUInt(sf::Uint64 value);
+    void writeVarSInt(sf::Int64 value);
+    void writeUInt16(sf::Uint16 value);
+    void writeUInt32(sf::Uint32 value);
+    void writeFloat(float value);
+    void writeBytes(const void* data, size_t size);
+
+    /**
+     * @brief Flush any partial bit byte
+     * @return False if the buffer overflowed
+     */
+    bool finish();
+
+    size_t getSize() const { return size; }
+    bool hasOverflowed() const { return overflowed; }
+
+private:
+    void alignToByte();
+
+    char* buffer;
+    size_t capacity;
+    size_t size;
+    sf::Uint32 bitBuffer;
+    int bitCount;
+    bool overflowed;
+};
+
+/**
+ * @brief Allocation-free reader over a received buffer
+ *
+ * Mirrors WireWriter. Reads past the end clear the ok flag and return zero,
+ * so a decoder can read every field and check ok() once at the end.
+ */
+class WireReader {
+public:
+    WireReader(const void* data, size_t size);
+
+    sf::Uint32 readBits(int bitCount);
+    sf::Uint8 readByte();
+    sf::Uint64 readVarUInt();
+    sf::Int64 readVarSInt();
+    sf::Uint16 readUInt16();
+    sf::Uint32 readUInt32();
+    float readFloat();
+
+    /**
+     * @brief View of the next size bytes, pointing into the source buffer
+     */
+    std::string_view readBytes(size_t size);
+
+    bool ok() const { return valid; }
+    size_t getRemaining() const { return size - offset; }
+
+private:
+    void alignToByte();
+
+    const unsigned char* data;
+    size_t size;
+    size_t offset;
+    sf::Uint32 bitBuffer;
+    int bitCount;
+    bool valid;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,135 @@
+#include "AllocationCounter.hpp"
+
+#ifdef ISOMUD_COUNT_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#endif
+
+namespace IsometricMUD {
+
+#ifdef ISOMUD_COUNT_ALLOCATIONS
+
+namespace {
+
+// Constant-initialized, so it is safe to touch from operator new at any point
+thread_local std::uint64_t threadAllocations = 0;
+
+void* allocate(std::size_t size) {
+    threadAllocations++;
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* allocateAligned(std::size_t size, std::size_t alignment) {
+    threadAllocations++;
+    size = size > 0 ? size : 1;
+#ifdef _WIN32
+    return _aligned_malloc(size, alignment);
+#else
+    // aligned_alloc wants a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+void freeAligned(void* pointer) {
+#ifdef _WIN32
+    _aligned_free(pointer);
+#else
+    std::free(pointer);
+#endif
+}
+
+} // namespace
+
+bool AllocationCounter::isEnabled() {
+    return true;
+}
+
+std::uint64_t AllocationCounter::getThreadCount() {
+    return threadAllocations;
+}
+
+#else
+
+bool AllocationCounter::isEnabled() {
+    return false;
+}
+
+std::uint64_t AllocationCounter::getThreadCount() {
+    return 0;
+}
+
+#endif
+
+} // namespace IsometricMUD
+
+#ifdef ISOMUD_COUNT_ALLOCATIONS
+
+// Replacing the global operators counts every new, std::allocator and
+// make_shared call in the program, including ones inside SFML's headers
+
+void* operator new(std::size_t size) {
+    if (void* pointer = IsometricMUD::allocate(size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return IsometricMUD::allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return IsometricMUD::allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (void* pointer = IsometricMUD::allocateAligned(size, static_cast<std::size_t>(alignment))) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    IsometricMUD::freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+    IsometricMUD::freeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    IsometricMUD::freeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+    IsometricMUD::freeAligned(pointer);
+}
+
+#endif
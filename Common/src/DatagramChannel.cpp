@@ -0,0 +1,138 @@
+#include "DatagramChannel.hpp"
+
+namespace IsometricMUD {
+
+DatagramChannel::DatagramChannel()
+    : localSequence(1), remoteSequence(0), receivedBits(0), ackedCount(0), lostCount(0) {
+}
+
+sf::Uint16 DatagramChannel::writeHeader(WireWriter& writer) {
+    sf::Uint16 sequence = localSequence++;
+    if (localSequence == 0) {
+        localSequence = 1;
+    }
+    
+    // Whatever is being overwritten was never acknowledged in time
+    SentRecord& record = sent[sequence % SentHistory];
+    if (record.sequence != 0 && !record.acked) {
+        lostCount++;
+    }
+    record.sequence = sequence;
+    record.acked = false;
+    record.sentAt = clock.getElapsedTime();
+    
+    writer.writeUInt16(sequence);
+    writer.writeUInt16(remoteSequence);
+    writer.writeUInt32(receivedBits);
+    return sequence;
+}
+
+bool DatagramChannel::readHeader(WireReader& reader, std::vector<sf::Uint16>& newlyAcked) {
+    sf::Uint16 sequence = reader.readUInt16();
+    sf::Uint16 ack = reader.readUInt16();
+    sf::Uint32 ackBits = reader.readUInt32();
+    if (!reader.ok() || sequence == 0) {
+        return false;
+    }
+    
+    // Acknowledgements are worth processing even from a stale datagram
+    if (ack != 0) {
+        acknowledge(ack, newlyAcked);
+        for (sf::Uint16 i = 0; i < 32; i++) {
+            if (ackBits & (1u << i)) {
+                acknowledge(static_cast<sf::Uint16>(ack - 1 - i), newlyAcked);
+            }
+        }
+    }
+    
+    if (remoteSequence == 0 || isNewer(sequence, remoteSequence)) {
+        sf::Uint16 shift = static_cast<sf::Uint16>(sequence - remoteSequence);
+        if (remoteSequence == 0 || shift > 32) {
+            receivedBits = 0;
+        } else {
+            // The previous newest becomes bit shift - 1
+            receivedBits = shift == 32 ? 0 : receivedBits << shift;
+            receivedBits |= 1u << (shift - 1);
+        }
+        remoteSequence = sequence;
+        return true;
+    }
+    
+    // Older than the newest: note it for the ack field, but its payload is stale
+    sf::Uint16 age = static_cast<sf::Uint16>(remoteSequence - sequence);
+    if (age >= 1 && age <= 32) {
+        receivedBits |= 1u << (age - 1);
+    }
+    return false;
+}
+
+void DatagramChannel::acknowledge(sf::Uint16 sequence, std::vector<sf::Uint16>& newlyAcked) {
+    SentRecord& record = sent[sequence % SentHistory];
+    if (record.sequence != sequence || record.acked) {
+        return;
+    }
+    record.acked = true;
+    ackedCount++;
+    newlyAcked.push_back(sequence);
+    
+    sf::Time sample = clock.getElapsedTime() - record.sentAt;
+    if (roundTripTime == sf::Time::Zero) {
+        roundTripTime = sample;
+    } else {
+        roundTripTime = sf::microseconds(
+            (roundTripTime.asMicroseconds() * 7 + sample.asMicroseconds()) / 8);
+    }
+}
+
+float DatagramChannel::getLossRatio() const {
+    sf::Uint32 total = ackedCount + lostCount;
+    return total > 0 ? static_cast<float>(lostCount) / static_cast<float>(total) : 0.0f;
+}
+
+bool DatagramChannel::isNewer(sf::Uint16 a, sf::Uint16 b) {
+    return a != b && static_cast<sf::Uint16>(a - b) < 0x8000;
+}
+
+DatagramSocket::DatagramSocket() : lossRatio(0.0f), random(std::random_device{}()) {
+}
+
+void DatagramSocket::setSimulation(float loss, sf::Time delay, sf::Time variation) {
+    lossRatio = loss;
+    latency = delay;
+    jitter = variation;
+}
+
+sf::Socket::Status DatagramSocket::sendDatagram(const void* data, size_t size,
+                                                const sf::IpAddress& address, unsigned short port) {
+    if (lossRatio > 0.0f && std::uniform_real_distribution<float>(0.0f, 1.0f)(random) < lossRatio) {
+        return sf::Socket::Done;
+    }
+    
+    if (latency == sf::Time::Zero && jitter == sf::Time::Zero) {
+        return send(data, size, address, port);
+    }
+    
+    sf::Int64 delay = latency.asMicroseconds();
+    if (jitter > sf::Time::Zero) {
+        delay += std::uniform_int_distribution<sf::Int64>(0, jitter.asMicroseconds())(random);
+    }
+    
+    DelayedDatagram datagram;
+    const char* bytes = static_cast<const char*>(data);
+    datagram.bytes.assign(bytes, bytes + size);
+    datagram.address = address;
+    datagram.port = port;
+    delayed.emplace(clock.getElapsedTime().asMicroseconds() + delay, std::move(datagram));
+    return sf::Socket::Done;
+}
+
+void DatagramSocket::releaseDelayed() {
+    sf::Int64 now = clock.getElapsedTime().asMicroseconds();
+    while (!delayed.empty() && delayed.begin()->first <= now) {
+        const DelayedDatagram& datagram = delayed.begin()->second;
+        send(datagram.bytes.data(), datagram.bytes.size(), datagram.address, datagram.port);
+        delayed.erase(delayed.begin());
+    }
+}
+
+} // namespace IsometricMUD
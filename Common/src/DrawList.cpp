@@ -0,0 +1,95 @@
+#include "DrawList.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace IsometricMUD {
+
+namespace {
+
+const int DepthBias = 32768;
+const int HeightBias = 128;
+
+// Bytes of the key, least significant first
+const int KeyBytes = 4;
+
+int clampField(float value, int bias, int maxValue) {
+    int biased = static_cast<int>(std::floor(value)) + bias;
+    return std::min(std::max(biased, 0), maxValue);
+}
+
+} // namespace
+
+std::uint32_t DrawList::makeKey(const Vector3D& position, DrawLayer layer) {
+    std::uint32_t depth = static_cast<std::uint32_t>(clampField(position.x + position.y, DepthBias, 0xFFFF));
+    std::uint32_t height = static_cast<std::uint32_t>(clampField(position.z, HeightBias, 0xFF));
+    return (depth << 16) | (height << 8) | static_cast<std::uint32_t>(layer);
+}
+
+void DrawList::add(std::uint32_t key, const sf::Vector2f& center, const sf::Color& color,
+                   const sf::IntRect& sprite) {
+    order.push_back({key, static_cast<std::uint32_t>(items.size())});
+    items.push_back({center, color, sprite});
+}
+
+void DrawList::clear() {
+    items.clear();
+    order.clear();
+}
+
+void DrawList::sort() {
+    size_t count = order.size();
+    if (count < 2) {
+        return;
+    }
+    scratch.resize(count);
+    
+    // One histogram per key byte, all counted in a single read of the keys
+    size_t counts[KeyBytes][256] = {};
+    for (const SortEntry& entry : order) {
+        for (int byte = 0; byte < KeyBytes; byte++) {
+            counts[byte][(entry.key >> (byte * 8)) & 0xFF]++;
+        }
+    }
+    
+    for (int byte = 0; byte < KeyBytes; byte++) {
+        size_t* bucket = counts[byte];
+        int shift = byte * 8;
+        
+        // Every key has the same value here: this pass wouldn't move anything
+        if (bucket[(order[0].key >> shift) & 0xFF] == count) {
+            continue;
+        }
+        
+        size_t offset = 0;
+        for (int value = 0; value < 256; value++) {
+            size_t n = bucket[value];
+            bucket[value] = offset;
+            offset += n;
+        }
+        for (const SortEntry& entry : order) {
+            scratch[bucket[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        order.swap(scratch);
+    }
+}
+
+void DrawList::build(TileBatch& batch) const {
+    batch.clear();
+    for (const SortEntry& entry : order) {
+        const Item& item = items[entry.item];
+        batch.addTile(item.center, item.color, item.sprite);
+    }
+}
+
+size_t DrawList::append(TileBatch& batch, size_t first, int depth) const {
+    // Keys hold floor(x + y), so x + y < depth exactly when the field is below the biased depth
+    long long limit = static_cast<long long>(depth) + DepthBias;
+    size_t index = first;
+    for (; index < order.size() && static_cast<long long>(order[index].key >> 16) < limit; index++) {
+        const Item& item = items[order[index].item];
+        batch.addTile(item.center, item.color, item.sprite);
+    }
+    return index;
+}
+
+} // namespace IsometricMUD
@@ -0,0 +1,74 @@
+#include "EntityStore.hpp"
+
+namespace IsometricMUD {
+
+EntityHandle EntityStore::create(const Vector3D& position, sf::Uint32 owner, sf::Uint8 entityFlags) {
+    sf::Uint32 slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<sf::Uint32>(slots.size());
+        slots.push_back(Slot{1, 0});
+    }
+    
+    slots[slot].denseIndex = static_cast<sf::Uint32>(positions.size());
+    positions.push_back(position);
+    velocities.push_back(Vector3D(0, 0, 0));
+    owners.push_back(owner);
+    flags.push_back(entityFlags);
+    denseSlots.push_back(slot);
+    
+    return EntityHandle{slot, slots[slot].generation};
+}
+
+bool EntityStore::destroy(EntityHandle handle) {
+    if (!isAlive(handle)) {
+        return false;
+    }
+    
+    // Swap-remove keeps every component dense; the moved entity's slot follows it
+    size_t index = slots[handle.index].denseIndex;
+    size_t last = positions.size() - 1;
+    if (index != last) {
+        positions[index] = positions[last];
+        velocities[index] = velocities[last];
+        owners[index] = owners[last];
+        flags[index] = flags[last];
+        denseSlots[index] = denseSlots[last];
+        slots[denseSlots[index]].denseIndex = static_cast<sf::Uint32>(index);
+    }
+    positions.pop_back();
+    velocities.pop_back();
+    owners.pop_back();
+    flags.pop_back();
+    denseSlots.pop_back();
+    
+    // Generation 0 is reserved for null handles
+    Slot& slot = slots[handle.index];
+    if (++slot.generation == 0) {
+        slot.generation = 1;
+    }
+    freeSlots.push_back(handle.index);
+    return true;
+}
+
+void EntityStore::clear() {
+    positions.clear();
+    velocities.clear();
+    owners.clear();
+    flags.clear();
+    denseSlots.clear();
+    
+    // Keep the generations so handles from before the clear stay stale
+    freeSlots.clear();
+    for (size_t i = slots.size(); i > 0; i--) {
+        Slot& slot = slots[i - 1];
+        if (++slot.generation == 0) {
+            slot.generation = 1;
+        }
+        freeSlots.push_back(static_cast<sf::Uint32>(i - 1));
+    }
+}
+
+} // namespace IsometricMUD
@@ -0,0 +1,117 @@
+#include "Histogram.hpp"
+
+namespace IsometricMUD {
+
+namespace {
+
+int highestBit(std::uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1) {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+} // namespace
+
+Histogram::Histogram() {
+    reset();
+}
+
+int Histogram::bucketIndex(std::uint64_t value) {
+    if (value < static_cast<std::uint64_t>(SubBucketCount)) {
+        return static_cast<int>(value);
+    }
+    
+    // Group by power of two, then take the next SubBucketBits bits as the
+    // linear position inside that power of two
+    int msb = highestBit(value);
+    int shift = msb - SubBucketBits;
+    int group = shift + 1;
+    int sub = static_cast<int>(value >> shift) - SubBucketCount;
+    return group * SubBucketCount + sub;
+}
+
+std::uint64_t Histogram::bucketUpperBound(int bucket) {
+    int group = bucket / SubBucketCount;
+    int sub = bucket % SubBucketCount;
+    if (group == 0) {
+        return static_cast<std::uint64_t>(sub);
+    }
+    
+    int shift = group - 1;
+    return ((static_cast<std::uint64_t>(SubBucketCount + sub + 1)) << shift) - 1;
+}
+
+void Histogram::record(std::uint64_t value) {
+    buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+    
+    std::uint64_t currentMax = max.load(std::memory_order_relaxed);
+    while (value > currentMax &&
+           !max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) {
+    }
+}
+
+std::uint64_t Histogram::percentile(double fraction) const {
+    std::uint64_t total = getCount();
+    if (total == 0) {
+        return 0;
+    }
+    
+    if (fraction < 0.0) {
+        fraction = 0.0;
+    } else if (fraction > 1.0) {
+        fraction = 1.0;
+    }
+    
+    std::uint64_t rank = static_cast<std::uint64_t>(fraction * static_cast<double>(total));
+    if (rank == 0) {
+        rank = 1;
+    }
+    
+    std::uint64_t seen = 0;
+    for (int i = 0; i < BucketCount; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            // Never report more than the largest value actually recorded
+            std::uint64_t bound = bucketUpperBound(i);
+            std::uint64_t largest = getMax();
+            return bound < largest ? bound : largest;
+        }
+    }
+    return getMax();
+}
+
+void Histogram::merge(const Histogram& other) {
+    for (int i = 0; i < BucketCount; i++) {
+        std::uint64_t n = other.buckets[i].load(std::memory_order_relaxed);
+        if (n != 0) {
+            buckets[i].fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+    count.fetch_add(other.getCount(), std::memory_order_relaxed);
+    sum.fetch_add(other.getSum(), std::memory_order_relaxed);
+    
+    std::uint64_t otherMax = other.getMax();
+    std::uint64_t currentMax = max.load(std::memory_order_relaxed);
+    while (otherMax > currentMax &&
+           !max.compare_exchange_weak(currentMax, otherMax, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::reset() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+} // namespace IsometricMUD
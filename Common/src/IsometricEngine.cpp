@@ -1,10 +1,11 @@
 #include "IsometricEngine.hpp"
+#include <climits>
 #include <cmath>
 
 namespace IsometricMUD {
 
 IsometricEngine::IsometricEngine() 
-    : cameraPosition(0, 0, 0), windowWidth(800), windowHeight(600) {
+    : cameraPosition(0, 0, 0), windowWidth(800), windowHeight(600), atlas(nullptr) {
 }
 
 IsometricEngine::~IsometricEngine() {
@@ -17,7 +18,13 @@ bool IsometricEngine::initialize(int width, int height) {
     return true;
 }
 
-void IsometricEngine::renderTile(sf::RenderWindow& window, const Vector3D& position, const sf::Color& color) {
+void IsometricEngine::renderTile(sf::RenderTarget& target, const Vector3D& position, const sf::Color& color) {
+    if (!isVisible(position)) {
+        stats.tilesCulled++;
+        return;
+    }
+    stats.tilesDrawn++;
+    
     // Calculate relative position from camera
     Vector3D relativePos = position - cameraPosition;
     
@@ -39,7 +46,140 @@ void IsometricEngine::renderTile(sf::RenderWindow& window, const Vector3D& posit
     tile.setOutlineColor(sf::Color::Black);
     tile.setOutlineThickness(1.0f);
     
-    window.draw(tile);
+    target.draw(tile);
+}
+
+bool IsometricEngine::addTile(TileBatch& batch, const Vector3D& position, const sf::Color& color,
+                              const sf::IntRect& sprite) {
+    if (!isVisible(position, sprite)) {
+        stats.tilesCulled++;
+        return false;
+    }
+    stats.tilesDrawn++;
+    
+    float screenX, screenY;
+    position.toIsometric(screenX, screenY);
+    batch.addTile(sf::Vector2f(screenX, screenY), color, sprite);
+    return true;
+}
+
+void IsometricEngine::renderBatch(sf::RenderTarget& target, const TileBatch& batch) const {
+    target.draw(batch, getCameraStates());
+}
+
+bool IsometricEngine::addToDrawList(DrawList& list, const Vector3D& position, const sf::Color& color,
+                                    DrawLayer layer, const sf::IntRect& sprite) {
+    if (!isVisible(position, sprite)) {
+        stats.tilesCulled++;
+        return false;
+    }
+    stats.tilesDrawn++;
+    
+    float screenX, screenY;
+    position.toIsometric(screenX, screenY);
+    list.add(DrawList::makeKey(position, layer), sf::Vector2f(screenX, screenY), color, sprite);
+    return true;
+}
+
+void IsometricEngine::renderDrawList(sf::RenderTarget& target, DrawList& list) {
+    sortDrawList(list);
+    list.build(drawListBatch);
+    target.draw(drawListBatch, getCameraStates());
+}
+
+void IsometricEngine::renderChunks(sf::RenderTarget& target, TileChunkCache& cache) {
+    cache.update();
+    
+    size_t tilesDrawn = 0;
+    size_t chunksDrawn = cache.drawVisible(target, getCameraStates(), getViewRect(), tilesDrawn);
+    recordChunkStats(cache, chunksDrawn, tilesDrawn);
+}
+
+void IsometricEngine::renderScene(sf::RenderTarget& target, TileChunkCache& cache, DrawList& list) {
+    cache.update();
+    sortDrawList(list);
+    
+    sf::RenderStates states = getCameraStates();
+    size_t nextItem = 0;
+    auto drawItemsBefore = [&](int depth) {
+        drawListBatch.clear();
+        nextItem = list.append(drawListBatch, nextItem, depth);
+        if (!drawListBatch.isEmpty()) {
+            target.draw(drawListBatch, states);
+        }
+    };
+    
+    // A chunk on diagonal d starts at x + y = 16d. Items with x + y below
+    // that are behind all of it, and the ground under them (diagonal d - 1
+    // or d - 2) is already drawn
+    size_t tilesDrawn = 0;
+    size_t chunksDrawn = cache.drawVisible(target, states, getViewRect(), tilesDrawn, [&](int diagonal) {
+        drawItemsBefore(diagonal * TileChunkCache::ChunkSize);
+    });
+    drawItemsBefore(INT_MAX);
+    recordChunkStats(cache, chunksDrawn, tilesDrawn);
+}
+
+void IsometricEngine::sortDrawList(DrawList& list) {
+    sf::Clock sortClock;
+    list.sort();
+    stats.sortMs += sortClock.getElapsedTime().asMicroseconds() / 1000.0f;
+}
+
+void IsometricEngine::recordChunkStats(const TileChunkCache& cache, size_t chunksDrawn, size_t tilesDrawn) {
+    stats.chunksDrawn += chunksDrawn;
+    stats.chunksCulled += cache.getChunkCount() - chunksDrawn;
+    stats.chunkTilesDrawn += tilesDrawn;
+    stats.chunkTilesCulled += cache.getTileCount() - tilesDrawn;
+}
+
+sf::FloatRect IsometricEngine::getViewRect() const {
+    // Screen = projected - camera + offset, so the window's corner sits here
+    float cameraX, cameraY;
+    cameraPosition.toIsometric(cameraX, cameraY);
+    return sf::FloatRect(cameraX - offset.x, cameraY - offset.y,
+                         static_cast<float>(windowWidth), static_cast<float>(windowHeight));
+}
+
+bool IsometricEngine::isVisible(const Vector3D& position, const sf::IntRect& sprite) const {
+    float screenX, screenY;
+    position.toIsometric(screenX, screenY);
+    return TileBatch::getTileBounds(sf::Vector2f(screenX, screenY), sprite).intersects(getViewRect());
+}
+
+void IsometricEngine::setAtlas(const TextureAtlas* textureAtlas) {
+    atlas = textureAtlas;
+}
+
+sf::IntRect IsometricEngine::getTileSprite(int tileType) const {
+    // Only the first page is ever bound; sprites on other pages draw flat
+    if (!atlas || !atlas->isUploaded()) {
+        return sf::IntRect();
+    }
+    const AtlasRegion& region = atlas->getTileRegion(tileType);
+    return region.isValid() && region.page == 0 ? region.getTextureRect() : sf::IntRect();
+}
+
+sf::IntRect IsometricEngine::getEntitySprite(int entityKind) const {
+    if (!atlas || !atlas->isUploaded()) {
+        return sf::IntRect();
+    }
+    const AtlasRegion& region = atlas->getEntityRegion(entityKind);
+    return region.isValid() && region.page == 0 ? region.getTextureRect() : sf::IntRect();
+}
+
+sf::RenderStates IsometricEngine::getCameraStates() const {
+    // The projection is linear, so the camera is just a translation
+    float cameraX, cameraY;
+    cameraPosition.toIsometric(cameraX, cameraY);
+    
+    sf::Transform camera;
+    camera.translate(offset.x - cameraX, offset.y - cameraY);
+    sf::RenderStates states(camera);
+    if (atlas) {
+        states.texture = atlas->getTexture(0);
+    }
+    return states;
 }
 
 void IsometricEngine::setCameraPosition(const Vector3D& position) {
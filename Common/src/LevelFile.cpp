@@ -0,0 +1,90 @@
+#include "LevelFile.hpp"
+#include <fstream>
+#include <iostream>
+
+namespace IsometricMUD {
+
+namespace {
+
+// Script names longer than this mean the file is corrupt, not that a tile has a long name
+const size_t MaxScriptNameLength = 4096;
+
+} // namespace
+
+bool LevelFile::save(const std::string& filename, const std::vector<TileData>& tiles) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to save level: " << filename << std::endl;
+        return false;
+    }
+    
+    // Write number of tiles
+    size_t numTiles = tiles.size();
+    file.write(reinterpret_cast<const char*>(&numTiles), sizeof(numTiles));
+    
+    // Write each tile
+    for (const auto& tile : tiles) {
+        file.write(reinterpret_cast<const char*>(&tile.position.x), sizeof(float));
+        file.write(reinterpret_cast<const char*>(&tile.position.y), sizeof(float));
+        file.write(reinterpret_cast<const char*>(&tile.position.z), sizeof(float));
+        file.write(reinterpret_cast<const char*>(&tile.tileType), sizeof(int));
+        
+        size_t nameLen = tile.scriptName.length();
+        file.write(reinterpret_cast<const char*>(&nameLen), sizeof(nameLen));
+        file.write(tile.scriptName.c_str(), nameLen);
+    }
+    
+    file.close();
+    std::cout << "Level saved: " << filename << " (" << numTiles << " tiles)" << std::endl;
+    return true;
+}
+
+bool LevelFile::load(const std::string& filename, std::vector<TileData>& tiles) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to load level: " << filename << std::endl;
+        return false;
+    }
+    
+    tiles.clear();
+    
+    // Read number of tiles
+    size_t numTiles = 0;
+    file.read(reinterpret_cast<char*>(&numTiles), sizeof(numTiles));
+    
+    // Read each tile
+    for (size_t i = 0; i < numTiles && file; i++) {
+        TileData tile;
+        file.read(reinterpret_cast<char*>(&tile.position.x), sizeof(float));
+        file.read(reinterpret_cast<char*>(&tile.position.y), sizeof(float));
+        file.read(reinterpret_cast<char*>(&tile.position.z), sizeof(float));
+        file.read(reinterpret_cast<char*>(&tile.tileType), sizeof(int));
+        
+        size_t nameLen = 0;
+        file.read(reinterpret_cast<char*>(&nameLen), sizeof(nameLen));
+        if (nameLen > MaxScriptNameLength) {
+            file.setstate(std::ios::failbit);
+            break;
+        }
+        tile.scriptName.resize(nameLen);
+        file.read(&tile.scriptName[0], nameLen);
+        
+        tiles.push_back(tile);
+    }
+    
+    if (!file) {
+        std::cerr << "Level file is truncated or corrupt: " << filename << std::endl;
+        tiles.clear();
+        return false;
+    }
+    
+    std::cout << "Level loaded: " << filename << " (" << numTiles << " tiles)" << std::endl;
+    return true;
+}
+
+bool LevelFile::isSolid(int tileType) {
+    // Water can't be stood on, but doesn't block either
+    return static_cast<TileType>(tileType) != TileType::WATER;
+}
+
+} // namespace IsometricMUD
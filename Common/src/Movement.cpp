@@ -1,4 +1,5 @@
 #include "Movement.hpp"
+#include "VoxelGrid.hpp"
 
 namespace IsometricMUD {
 
@@ -33,4 +34,11 @@ bool Movement::isValidMovement(const Vector3D& from, const Vector3D& to) {
     return dist > 0 && dist <= 10.0f; // Max movement per step
 }
 
+bool Movement::isValidMovement(const VoxelGrid& grid, const Vector3D& from, const Vector3D& to) {
+    if (!isValidMovement(from, to)) {
+        return false;
+    }
+    return grid.empty() || grid.isWalkable(to);
+}
+
 } // namespace IsometricMUD
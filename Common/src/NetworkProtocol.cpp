@@ -1,47 +1,269 @@
 #include "NetworkProtocol.hpp"
+#include "MessageSchema.hpp"
 
 namespace IsometricMUD {
 
-sf::Packet NetworkProtocol::createMovePacket(sf::Uint32 entityId, Direction dir) {
+namespace {
+
+/**
+ * @brief Encode a message with its schema into a new sf::Packet
+ */
+template <typename Schema, typename... Values>
+sf::Packet encodePacket(const Values&... values) {
+    char buffer[MaxMessageSize];
+    WireWriter writer(buffer, sizeof(buffer));
+    
     sf::Packet packet;
-    packet << static_cast<sf::Uint8>(PacketType::MOVE);
-    packet << entityId;
-    packet << static_cast<sf::Uint8>(dir);
+    if (Schema::encode(writer, values...)) {
+        packet.append(buffer, writer.getSize());
+    }
     return packet;
 }
 
+/**
+ * @brief Decode a message with its schema, reading the packet's buffer in place
+ */
+template <typename Schema, typename... Values>
+bool decodePacket(const sf::Packet& packet, Values&... values) {
+    WireReader reader(packet.getData(), packet.getDataSize());
+    return Schema::decode(reader, values...);
+}
+
+// Text fields longer than this are truncated so the message always fits
+const size_t MaxTextLength = MaxMessageSize - 16;
+
+std::string_view clampText(const std::string& text) {
+    return std::string_view(text).substr(0, MaxTextLength);
+}
+
+} // namespace
+
+sf::Packet NetworkProtocol::createConnectPacket(sf::Uint32 clientId, sf::Uint32 udpToken,
+                                                unsigned short udpPort) {
+    return encodePacket<Messages::Connect>(clientId, udpToken, static_cast<sf::Uint32>(udpPort));
+}
+
+sf::Packet NetworkProtocol::createMovePacket(sf::Uint32 entityId, Direction dir) {
+    return encodePacket<Messages::Move>(dir, entityId);
+}
+
 sf::Packet NetworkProtocol::createPositionPacket(sf::Uint32 entityId, const Vector3D& position) {
-    sf::Packet packet;
-    packet << static_cast<sf::Uint8>(PacketType::UPDATE_POSITION);
-    packet << entityId;
-    packet << position.x << position.y << position.z;
-    return packet;
+    return encodePacket<Messages::UpdatePosition>(entityId, position);
 }
 
-sf::Packet NetworkProtocol::createChatPacket(const std::string& message) {
-    sf::Packet packet;
-    packet << static_cast<sf::Uint8>(PacketType::CHAT);
-    packet << message;
-    return packet;
+sf::Packet NetworkProtocol::createSpawnPacket(sf::Uint32 entityId, const Vector3D& position) {
+    return encodePacket<Messages::SpawnEntity>(entityId, position);
+}
+
+sf::Packet NetworkProtocol::createRemovePacket(sf::Uint32 entityId) {
+    return encodePacket<Messages::RemoveEntity>(entityId);
+}
+
+sf::Packet NetworkProtocol::createChatPacket(ChatChannel channel, sf::Uint32 peer, const std::string& message) {
+    return encodePacket<Messages::Chat>(channel, peer, clampText(message));
+}
+
+sf::Packet NetworkProtocol::createChatSubscribePacket(ChatChannel channel, sf::Uint32 topic, bool subscribe) {
+    return encodePacket<Messages::ChatSubscribe>(channel, topic, static_cast<sf::Uint32>(subscribe ? 1 : 0));
+}
+
+sf::Packet NetworkProtocol::createScriptEventPacket(const std::string& eventName) {
+    return encodePacket<Messages::ScriptEvent>(clampText(eventName));
+}
+
+sf::Packet NetworkProtocol::createLoginPacket(const std::string& playerName) {
+    return encodePacket<Messages::Login>(clampText(playerName));
+}
+
+sf::Packet NetworkProtocol::createRedirectPacket(unsigned short port, sf::Uint32 token) {
+    return encodePacket<Messages::Redirect>(static_cast<sf::Uint32>(port), token);
+}
+
+sf::Packet NetworkProtocol::createResumePacket(sf::Uint32 token) {
+    return encodePacket<Messages::Resume>(token);
+}
+
+sf::Packet NetworkProtocol::createSnapshotAckPacket(sf::Uint32 sequence) {
+    return encodePacket<Messages::SnapshotAck>(sequence);
+}
+
+void NetworkProtocol::beginBatch(sf::Packet& batch) {
+    batch.clear();
+    batch << static_cast<sf::Uint8>(PacketType::BATCH);
+}
+
+void NetworkProtocol::appendToBatch(sf::Packet& batch, const sf::Packet& message) {
+    batch << static_cast<sf::Uint32>(message.getDataSize());
+    batch.append(message.getData(), message.getDataSize());
+}
+
+bool NetworkProtocol::unpackBatch(const sf::Packet& batch, std::vector<sf::Packet>& messages) {
+    const unsigned char* data = static_cast<const unsigned char*>(batch.getData());
+    size_t size = batch.getDataSize();
+    
+    if (getPacketType(data, size) != PacketType::BATCH) {
+        return false;
+    }
+    
+    // sf::Packet writes the length prefix in network byte order
+    size_t offset = 1;
+    while (offset < size) {
+        if (size - offset < 4) {
+            return false;
+        }
+        size_t length = (static_cast<size_t>(data[offset]) << 24) |
+                        (static_cast<size_t>(data[offset + 1]) << 16) |
+                        (static_cast<size_t>(data[offset + 2]) << 8) |
+                        static_cast<size_t>(data[offset + 3]);
+        offset += 4;
+        
+        if (length > size - offset) {
+            return false;
+        }
+        
+        messages.emplace_back();
+        messages.back().append(data + offset, length);
+        offset += length;
+    }
+    return true;
 }
 
 PacketType NetworkProtocol::getPacketType(sf::Packet& packet) {
-    sf::Uint8 type;
-    packet >> type;
-    return static_cast<PacketType>(type);
+    sf::Uint8 header = 0;
+    packet >> header;
+    return static_cast<PacketType>(header & PacketTypeMask);
 }
 
-bool NetworkProtocol::parseMovePacket(sf::Packet& packet, sf::Uint32& entityId, Direction& dir) {
-    sf::Uint8 dirValue;
-    if (packet >> entityId >> dirValue) {
-        dir = static_cast<Direction>(dirValue);
-        return true;
+PacketType NetworkProtocol::getPacketType(const void* data, size_t size) {
+    if (size == 0) {
+        return PacketType::DISCONNECT;
     }
-    return false;
+    return static_cast<PacketType>(*static_cast<const sf::Uint8*>(data) & PacketTypeMask);
+}
+
+const char* NetworkProtocol::getPacketTypeName(PacketType type) {
+    switch (type) {
+        case PacketType::CONNECT:
+            return "connect";
+        case PacketType::DISCONNECT:
+            return "disconnect";
+        case PacketType::MOVE:
+            return "move";
+        case PacketType::CHAT:
+            return "chat";
+        case PacketType::UPDATE_POSITION:
+            return "update_position";
+        case PacketType::SPAWN_ENTITY:
+            return "spawn_entity";
+        case PacketType::REMOVE_ENTITY:
+            return "remove_entity";
+        case PacketType::SCRIPT_EVENT:
+            return "script_event";
+        case PacketType::BATCH:
+            return "batch";
+        case PacketType::SNAPSHOT:
+            return "snapshot";
+        case PacketType::SNAPSHOT_ACK:
+            return "snapshot_ack";
+        case PacketType::LOGIN:
+            return "login";
+        case PacketType::REDIRECT:
+            return "redirect";
+        case PacketType::RESUME:
+            return "resume";
+        case PacketType::CHAT_SUBSCRIBE:
+            return "chat_subscribe";
+        default:
+            return "unknown";
+    }
+}
+
+const char* NetworkProtocol::getChatChannelName(ChatChannel channel) {
+    switch (channel) {
+        case ChatChannel::GLOBAL:
+            return "global";
+        case ChatChannel::ZONE:
+            return "zone";
+        case ChatChannel::PARTY:
+            return "party";
+        case ChatChannel::WHISPER:
+            return "whisper";
+        case ChatChannel::PROXIMITY:
+            return "proximity";
+        default:
+            return "unknown";
+    }
+}
+
+bool NetworkProtocol::parseConnectPacket(sf::Packet& packet, sf::Uint32& clientId, sf::Uint32& udpToken,
+                                         unsigned short& udpPort) {
+    sf::Uint32 port = 0;
+    if (!decodePacket<Messages::Connect>(packet, clientId, udpToken, port) || port > 65535) {
+        return false;
+    }
+    udpPort = static_cast<unsigned short>(port);
+    return true;
+}
+
+bool NetworkProtocol::parseMovePacket(sf::Packet& packet, sf::Uint32& entityId, Direction& dir) {
+    return decodePacket<Messages::Move>(packet, dir, entityId);
 }
 
 bool NetworkProtocol::parsePositionPacket(sf::Packet& packet, sf::Uint32& entityId, Vector3D& position) {
-    return (packet >> entityId >> position.x >> position.y >> position.z);
+    return decodePacket<Messages::UpdatePosition>(packet, entityId, position);
+}
+
+bool NetworkProtocol::parseSpawnPacket(sf::Packet& packet, sf::Uint32& entityId, Vector3D& position) {
+    return decodePacket<Messages::SpawnEntity>(packet, entityId, position);
+}
+
+bool NetworkProtocol::parseRemovePacket(sf::Packet& packet, sf::Uint32& entityId) {
+    return decodePacket<Messages::RemoveEntity>(packet, entityId);
+}
+
+bool NetworkProtocol::parseChatPacket(sf::Packet& packet, ChatChannel& channel, sf::Uint32& peer,
+                                      std::string& message) {
+    std::string_view text;
+    if (!decodePacket<Messages::Chat>(packet, channel, peer, text) || channel >= ChatChannel::COUNT) {
+        return false;
+    }
+    message.assign(text.data(), text.size());
+    return true;
+}
+
+bool NetworkProtocol::parseScriptEventPacket(sf::Packet& packet, std::string& eventName) {
+    std::string_view text;
+    if (!decodePacket<Messages::ScriptEvent>(packet, text)) {
+        return false;
+    }
+    eventName.assign(text.data(), text.size());
+    return true;
+}
+
+bool NetworkProtocol::parseSnapshotAckPacket(sf::Packet& packet, sf::Uint32& sequence) {
+    return decodePacket<Messages::SnapshotAck>(packet, sequence);
+}
+
+bool NetworkProtocol::parseLoginPacket(sf::Packet& packet, std::string& playerName) {
+    std::string_view text;
+    if (!decodePacket<Messages::Login>(packet, text)) {
+        return false;
+    }
+    playerName.assign(text.data(), text.size());
+    return true;
+}
+
+bool NetworkProtocol::parseRedirectPacket(sf::Packet& packet, unsigned short& port, sf::Uint32& token) {
+    sf::Uint32 value = 0;
+    if (!decodePacket<Messages::Redirect>(packet, value, token) || value == 0 || value > 65535) {
+        return false;
+    }
+    port = static_cast<unsigned short>(value);
+    return true;
+}
+
+bool NetworkProtocol::parseResumePacket(sf::Packet& packet, sf::Uint32& token) {
+    return decodePacket<Messages::Resume>(packet, token);
 }
 
 } // namespace IsometricMUD
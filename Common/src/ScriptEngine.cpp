@@ -3,12 +3,26 @@
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <charconv>
 
 namespace IsometricMUD {
 
+namespace {
+
+std::string_view trim(std::string_view text) {
+    size_t start = text.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+        return std::string_view();
+    }
+    size_t end = text.find_last_not_of(" \t");
+    return text.substr(start, end - start + 1);
+}
+
+} // namespace
+
 ScriptEngine::ScriptEngine() {
     // Register built-in functions
-    registerFunction("Print", [](ScriptEngine& engine, const std::vector<ScriptVariable>& args) {
+    registerFunction("Print", [](ScriptEngine& engine, const ScriptArgs& args) {
         for (const auto& arg : args) {
             if (arg.type == ScriptVariable::Type::STRING) {
                 std::cout << arg.stringValue;
@@ -63,6 +77,7 @@ bool ScriptEngine::parseScript(const std::string& source) {
             if (nameEnd != std::string::npos) {
                 ScriptFunctionDef func;
                 func.name = line.substr(nameStart, nameEnd - nameStart);
+                func.event = line.find("Event ") == 0;
                 
                 scriptFunctions[func.name] = func;
                 currentFunction = &scriptFunctions[func.name];
@@ -77,7 +92,7 @@ bool ScriptEngine::parseScript(const std::string& source) {
     return true;
 }
 
-bool ScriptEngine::executeFunction(const std::string& functionName, const std::vector<ScriptVariable>& args) {
+bool ScriptEngine::executeFunction(std::string_view functionName, const ScriptArgs& args) {
     // Check native functions first
     auto nativeIt = nativeFunctions.find(functionName);
     if (nativeIt != nativeFunctions.end()) {
@@ -98,6 +113,11 @@ bool ScriptEngine::executeFunction(const std::string& functionName, const std::v
     return false;
 }
 
+bool ScriptEngine::isEvent(std::string_view name) const {
+    auto it = scriptFunctions.find(name);
+    return it != scriptFunctions.end() && it->second.event;
+}
+
 void ScriptEngine::registerFunction(const std::string& name, ScriptFunction func) {
     nativeFunctions[name] = func;
 }
@@ -114,45 +134,47 @@ ScriptVariable ScriptEngine::getVariable(const std::string& name) const {
     return ScriptVariable();
 }
 
-void ScriptEngine::executeLine(const std::string& line) {
-    // Parse and execute script commands
-    std::string trimmed = line;
-    trimmed.erase(0, trimmed.find_first_not_of(" \t"));
-    trimmed.erase(trimmed.find_last_not_of(" \t") + 1);
+void ScriptEngine::executeLine(std::string_view line) {
+    // Parse and execute script commands; views into the line, so nothing is copied
+    std::string_view trimmed = trim(line);
     
     // Handle Print statements
     if (trimmed.find("Print(") == 0) {
         size_t start = trimmed.find('"');
         size_t end = trimmed.rfind('"');
-        if (start != std::string::npos && end != std::string::npos && start < end) {
-            std::string text = trimmed.substr(start + 1, end - start - 1);
-            ScriptVariable arg;
+        if (start != std::string_view::npos && end != std::string_view::npos && start < end) {
+            ScriptArgs args(temporaries);
+            ScriptVariable& arg = args.emplace_back(temporaries);
             arg.type = ScriptVariable::Type::STRING;
-            arg.stringValue = text;
-            executeFunction("Print", {arg});
+            arg.stringValue = trimmed.substr(start + 1, end - start - 1);
+            executeFunction("Print", args);
         }
     }
     // Handle variable assignments (e.g., "x = 5")
-    else if (trimmed.find('=') != std::string::npos) {
+    else if (trimmed.find('=') != std::string_view::npos) {
         size_t eqPos = trimmed.find('=');
-        std::string varName = trimmed.substr(0, eqPos);
-        std::string value = trimmed.substr(eqPos + 1);
-        
-        // Trim whitespace
-        varName.erase(0, varName.find_first_not_of(" \t"));
-        varName.erase(varName.find_last_not_of(" \t") + 1);
-        value.erase(0, value.find_first_not_of(" \t"));
-        value.erase(value.find_last_not_of(" \t") + 1);
+        std::string_view varName = trim(trimmed.substr(0, eqPos));
+        std::string_view value = trim(trimmed.substr(eqPos + 1));
         
-        // Simple integer assignment with error handling
-        try {
-            ScriptVariable var;
-            var.type = ScriptVariable::Type::INT;
-            var.intValue = std::stoi(value);
-            setVariable(varName, var);
-        } catch (const std::exception& e) {
+        // Simple integer assignment with error handling; like stoi, a leading
+        // '+' is accepted and anything after the digits is ignored
+        std::string_view digits = value.size() > 1 && value[0] == '+' ? value.substr(1) : value;
+        int number = 0;
+        std::from_chars_result parsed = std::from_chars(digits.data(), digits.data() + digits.size(), number);
+        if (parsed.ec != std::errc()) {
             std::cerr << "Script error: Invalid integer value '" << value << "' for variable '" << varName << "'" << std::endl;
+            return;
+        }
+        
+        // Only a new variable needs a name of its own
+        auto it = variables.find(varName);
+        if (it == variables.end()) {
+            it = variables.emplace(std::string(varName), ScriptVariable()).first;
         }
+        ScriptVariable& var = it->second;
+        var.type = ScriptVariable::Type::INT;
+        var.intValue = number;
+        var.stringValue.clear();
     }
     // More command parsing can be added here for:
     // - Conditional statements (if/else)
@@ -0,0 +1,238 @@
+#include "Snapshot.hpp"
+#include "NetworkProtocol.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace IsometricMUD {
+
+namespace {
+
+// Per-entity encoding, in the two bits after the id delta
+enum EntryMode : sf::Uint32 {
+    ENTRY_STEP = 0,     // Each axis moved -1, 0 or +1; packed into the same byte
+    ENTRY_DELTA = 1,    // Zigzag varint delta per axis against the baseline
+    ENTRY_ABSOLUTE = 2  // Not in the baseline; zigzag varint per axis
+};
+
+bool isStep(sf::Int32 delta) {
+    return delta >= -1 && delta <= 1;
+}
+
+void writeEntry(WireWriter& writer, const SnapshotEntity& entity, const SnapshotEntity* base) {
+    if (!base) {
+        writer.writeBits(ENTRY_ABSOLUTE, 2);
+        writer.writeVarSInt(entity.x);
+        writer.writeVarSInt(entity.y);
+        writer.writeVarSInt(entity.z);
+        return;
+    }
+    
+    sf::Int32 dx = entity.x - base->x;
+    sf::Int32 dy = entity.y - base->y;
+    sf::Int32 dz = entity.z - base->z;
+    if (isStep(dx) && isStep(dy) && isStep(dz)) {
+        writer.writeBits(ENTRY_STEP, 2);
+        writer.writeBits(static_cast<sf::Uint32>(dx + 1), 2);
+        writer.writeBits(static_cast<sf::Uint32>(dy + 1), 2);
+        writer.writeBits(static_cast<sf::Uint32>(dz + 1), 2);
+    } else {
+        writer.writeBits(ENTRY_DELTA, 2);
+        writer.writeVarSInt(dx);
+        writer.writeVarSInt(dy);
+        writer.writeVarSInt(dz);
+    }
+}
+
+} // namespace
+
+void Snapshot::add(sf::Uint32 entityId, const Vector3D& position) {
+    entities.push_back({entityId, quantize(position.x), quantize(position.y), quantize(position.z)});
+}
+
+const SnapshotEntity* Snapshot::find(sf::Uint32 entityId) const {
+    auto it = std::lower_bound(entities.begin(), entities.end(), entityId,
+        [](const SnapshotEntity& entity, sf::Uint32 id) { return entity.entityId < id; });
+    if (it == entities.end() || it->entityId != entityId) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+sf::Int32 Snapshot::quantize(float coordinate) {
+    return static_cast<sf::Int32>(std::lround(coordinate));
+}
+
+Vector3D Snapshot::toPosition(const SnapshotEntity& entity) {
+    return Vector3D(static_cast<float>(entity.x), static_cast<float>(entity.y),
+                    static_cast<float>(entity.z));
+}
+
+void SnapshotHistory::store(const Snapshot& snapshot) {
+    // Assign rather than replace so the slot keeps its allocation
+    Snapshot& slot = slots[snapshot.sequence % Capacity];
+    slot.sequence = snapshot.sequence;
+    slot.entities.assign(snapshot.entities.begin(), snapshot.entities.end());
+}
+
+const Snapshot* SnapshotHistory::find(sf::Uint32 sequence) const {
+    const Snapshot& slot = slots[sequence % Capacity];
+    if (sequence == 0 || slot.sequence != sequence) {
+        return nullptr;
+    }
+    return &slot;
+}
+
+void SnapshotHistory::clear() {
+    for (auto& slot : slots) {
+        slot.sequence = 0;
+        slot.entities.clear();
+    }
+}
+
+size_t SnapshotCodec::maxEncodedSize(const Snapshot& baseline, const Snapshot& current) {
+    // Header, counts, then per entity: id (5) + mode byte (1) + three varints (15)
+    return 32 + current.entities.size() * 21 + baseline.entities.size() * 5;
+}
+
+bool SnapshotCodec::encode(WireWriter& writer, const Snapshot& baseline, const Snapshot& current) {
+    // First pass: count what changed so the counts can lead each section
+    size_t removedCount = 0;
+    size_t changedCount = 0;
+    auto base = baseline.entities.begin();
+    for (const auto& entity : current.entities) {
+        while (base != baseline.entities.end() && base->entityId < entity.entityId) {
+            ++removedCount;
+            ++base;
+        }
+        if (base != baseline.entities.end() && base->entityId == entity.entityId) {
+            if (!entity.samePosition(*base)) {
+                ++changedCount;
+            }
+            ++base;
+        } else {
+            ++changedCount;
+        }
+    }
+    removedCount += baseline.entities.end() - base;
+    
+    writer.writeBits(static_cast<sf::Uint32>(PacketType::SNAPSHOT), PacketTypeBits);
+    writer.writeVarUInt(current.sequence);
+    writer.writeVarUInt(baseline.sequence);
+    
+    // Removed ids: in the baseline but no longer visible
+    writer.writeVarUInt(removedCount);
+    sf::Uint32 previousId = 0;
+    auto now = current.entities.begin();
+    for (const auto& entity : baseline.entities) {
+        while (now != current.entities.end() && now->entityId < entity.entityId) {
+            ++now;
+        }
+        if (now == current.entities.end() || now->entityId != entity.entityId) {
+            writer.writeVarUInt(entity.entityId - previousId);
+            previousId = entity.entityId;
+        }
+    }
+    
+    // Changed or new entities; unchanged ones are left out entirely
+    writer.writeVarUInt(changedCount);
+    previousId = 0;
+    base = baseline.entities.begin();
+    for (const auto& entity : current.entities) {
+        while (base != baseline.entities.end() && base->entityId < entity.entityId) {
+            ++base;
+        }
+        const SnapshotEntity* baseEntity = nullptr;
+        if (base != baseline.entities.end() && base->entityId == entity.entityId) {
+            baseEntity = &*base;
+            if (entity.samePosition(*baseEntity)) {
+                continue;
+            }
+        }
+        writer.writeVarUInt(entity.entityId - previousId);
+        previousId = entity.entityId;
+        writeEntry(writer, entity, baseEntity);
+    }
+    
+    return writer.finish();
+}
+
+bool SnapshotCodec::readHeader(WireReader& reader, sf::Uint32& sequence, sf::Uint32& baselineSequence) {
+    if (reader.readBits(PacketTypeBits) != static_cast<sf::Uint32>(PacketType::SNAPSHOT)) {
+        return false;
+    }
+    sequence = static_cast<sf::Uint32>(reader.readVarUInt());
+    baselineSequence = static_cast<sf::Uint32>(reader.readVarUInt());
+    return reader.ok();
+}
+
+bool SnapshotCodec::decode(WireReader& reader, const Snapshot& baseline, Snapshot& result) {
+    result.entities.clear();
+    
+    // Start from the baseline minus the removed ids (both lists are sorted)
+    sf::Uint64 removedCount = reader.readVarUInt();
+    if (removedCount > baseline.entities.size()) {
+        return false;
+    }
+    sf::Uint32 removedId = 0;
+    sf::Uint64 removedRead = 0;
+    bool haveRemoved = false;
+    for (const auto& entity : baseline.entities) {
+        if (!haveRemoved && removedRead < removedCount) {
+            removedId += static_cast<sf::Uint32>(reader.readVarUInt());
+            removedRead++;
+            haveRemoved = true;
+        }
+        if (haveRemoved && removedId == entity.entityId) {
+            haveRemoved = false;
+            continue;
+        }
+        result.entities.push_back(entity);
+    }
+    if (haveRemoved || removedRead != removedCount || !reader.ok()) {
+        return false;
+    }
+    
+    // Apply changed entities; new ones are appended and sorted in afterwards
+    sf::Uint64 changedCount = reader.readVarUInt();
+    size_t existingCount = result.entities.size();
+    sf::Uint32 entityId = 0;
+    for (sf::Uint64 i = 0; i < changedCount && reader.ok(); i++) {
+        entityId += static_cast<sf::Uint32>(reader.readVarUInt());
+        sf::Uint32 mode = reader.readBits(2);
+        
+        const SnapshotEntity* base = baseline.find(entityId);
+        SnapshotEntity entity{entityId, 0, 0, 0};
+        if (mode == ENTRY_STEP && base) {
+            entity.x = base->x + static_cast<sf::Int32>(reader.readBits(2)) - 1;
+            entity.y = base->y + static_cast<sf::Int32>(reader.readBits(2)) - 1;
+            entity.z = base->z + static_cast<sf::Int32>(reader.readBits(2)) - 1;
+        } else if (mode == ENTRY_DELTA && base) {
+            entity.x = base->x + static_cast<sf::Int32>(reader.readVarSInt());
+            entity.y = base->y + static_cast<sf::Int32>(reader.readVarSInt());
+            entity.z = base->z + static_cast<sf::Int32>(reader.readVarSInt());
+        } else if (mode == ENTRY_ABSOLUTE && !base) {
+            entity.x = static_cast<sf::Int32>(reader.readVarSInt());
+            entity.y = static_cast<sf::Int32>(reader.readVarSInt());
+            entity.z = static_cast<sf::Int32>(reader.readVarSInt());
+        } else {
+            return false;
+        }
+        
+        auto end = result.entities.begin() + existingCount;
+        auto it = std::lower_bound(result.entities.begin(), end, entityId,
+            [](const SnapshotEntity& existing, sf::Uint32 id) { return existing.entityId < id; });
+        if (it != end && it->entityId == entityId) {
+            *it = entity;
+        } else {
+            result.entities.push_back(entity);
+        }
+    }
+    
+    if (result.entities.size() > existingCount) {
+        std::sort(result.entities.begin(), result.entities.end(),
+            [](const SnapshotEntity& a, const SnapshotEntity& b) { return a.entityId < b.entityId; });
+    }
+    return reader.ok();
+}
+
+} // namespace IsometricMUD
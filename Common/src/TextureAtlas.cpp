@@ -0,0 +1,268 @@
+#include "TextureAtlas.hpp"
+#include "TileBatch.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+namespace IsometricMUD {
+
+namespace {
+
+// Empty pixels kept around each sprite so filtering never reads a neighbour
+const unsigned int SpritePadding = 1;
+
+// The white block untextured vertices sample
+const unsigned int WhiteTexelSize = 2;
+
+const AtlasRegion NoRegion;
+
+} // namespace
+
+SkylinePacker::SkylinePacker(unsigned int width, unsigned int height)
+    : width(width), height(height) {
+    skyline.push_back({0, 0, width});
+}
+
+long SkylinePacker::fit(size_t index, unsigned int rectWidth, unsigned int rectHeight) const {
+    unsigned int x = skyline[index].x;
+    if (x + rectWidth > width) {
+        return -1;
+    }
+    
+    // Rest on the highest segment the rectangle spans
+    unsigned int y = 0;
+    unsigned int remaining = rectWidth;
+    for (size_t i = index; remaining > 0; i++) {
+        y = std::max(y, skyline[i].y);
+        if (y + rectHeight > height) {
+            return -1;
+        }
+        remaining -= std::min(remaining, skyline[i].width);
+    }
+    return y;
+}
+
+bool SkylinePacker::insert(unsigned int rectWidth, unsigned int rectHeight, sf::Vector2u& position) {
+    size_t best = skyline.size();
+    unsigned int bestBottom = std::numeric_limits<unsigned int>::max();
+    unsigned int bestY = 0;
+    
+    for (size_t i = 0; i < skyline.size(); i++) {
+        long y = fit(i, rectWidth, rectHeight);
+        if (y >= 0 && static_cast<unsigned int>(y) + rectHeight < bestBottom) {
+            best = i;
+            bestY = static_cast<unsigned int>(y);
+            bestBottom = bestY + rectHeight;
+        }
+    }
+    if (best == skyline.size()) {
+        return false;
+    }
+    
+    position = sf::Vector2u(skyline[best].x, bestY);
+    skyline.insert(skyline.begin() + best, {position.x, bestBottom, rectWidth});
+    
+    // Cut the new segment's span out of the ones after it
+    unsigned int end = position.x + rectWidth;
+    size_t i = best + 1;
+    while (i < skyline.size() && skyline[i].x < end) {
+        unsigned int segmentEnd = skyline[i].x + skyline[i].width;
+        if (segmentEnd <= end) {
+            skyline.erase(skyline.begin() + i);
+        } else {
+            skyline[i].width = segmentEnd - end;
+            skyline[i].x = end;
+            break;
+        }
+    }
+    
+    // Merge neighbours of the same height
+    for (size_t j = 0; j + 1 < skyline.size();) {
+        if (skyline[j].y == skyline[j + 1].y) {
+            skyline[j].width += skyline[j + 1].width;
+            skyline.erase(skyline.begin() + j + 1);
+        } else {
+            j++;
+        }
+    }
+    return true;
+}
+
+TextureAtlas::TextureAtlas()
+    : built(false), buildSucceeded(false) {
+}
+
+TextureAtlas::~TextureAtlas() {
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void TextureAtlas::addTileSprite(int tileType, const sf::Image& image) {
+    sprites.push_back({false, tileType, image});
+}
+
+void TextureAtlas::addEntitySprite(int entityKind, const sf::Image& image) {
+    sprites.push_back({true, entityKind, image});
+}
+
+bool TextureAtlas::build() {
+    pages.clear();
+    tileRegions.clear();
+    entityRegions.clear();
+    
+    // Tiles first so a level's tiles share a page; tallest first within each
+    std::vector<const Sprite*> order;
+    order.reserve(sprites.size());
+    for (const Sprite& sprite : sprites) {
+        order.push_back(&sprite);
+    }
+    std::stable_sort(order.begin(), order.end(), [](const Sprite* a, const Sprite* b) {
+        if (a->entity != b->entity) {
+            return !a->entity;
+        }
+        return a->image.getSize().y > b->image.getSize().y;
+    });
+    
+    std::vector<SkylinePacker> packers;
+    bool succeeded = true;
+    for (const Sprite* sprite : order) {
+        sf::Vector2u size = sprite->image.getSize();
+        if (sprite->index < 0 || size.x == 0 || size.y == 0) {
+            continue;
+        }
+        // A fresh page already holds the white block in its top-left corner;
+        // the sprite has to fit beside or below it
+        unsigned int paddedWidth = size.x + SpritePadding;
+        unsigned int paddedHeight = size.y + SpritePadding;
+        unsigned int whiteBlock = WhiteTexelSize + SpritePadding;
+        if (paddedWidth > PageSize || paddedHeight > PageSize ||
+            (paddedWidth + whiteBlock > PageSize && paddedHeight + whiteBlock > PageSize)) {
+            std::cerr << "Sprite of " << size.x << "x" << size.y << " doesn't fit a "
+                      << PageSize << "x" << PageSize << " atlas page" << std::endl;
+            succeeded = false;
+            continue;
+        }
+        
+        // Earlier pages first, so a page only opens once the others are full
+        sf::Vector2u position;
+        size_t page = 0;
+        while (page < packers.size() && !packers[page].insert(paddedWidth, paddedHeight, position)) {
+            page++;
+        }
+        if (page == packers.size()) {
+            packers.emplace_back(PageSize, PageSize);
+            packers.back().insert(whiteBlock, whiteBlock, position);
+            pages.emplace_back();
+            pages.back().create(PageSize, PageSize, sf::Color::Transparent);
+            for (unsigned int y = 0; y < WhiteTexelSize; y++) {
+                for (unsigned int x = 0; x < WhiteTexelSize; x++) {
+                    pages.back().setPixel(position.x + x, position.y + y, sf::Color::White);
+                }
+            }
+            if (!packers.back().insert(paddedWidth, paddedHeight, position)) {
+                std::cerr << "Sprite of " << size.x << "x" << size.y
+                          << " doesn't fit an empty atlas page" << std::endl;
+                succeeded = false;
+                continue;
+            }
+        }
+        
+        pages[page].copy(sprite->image, position.x, position.y);
+        
+        AtlasRegion& region = regionFor(sprite->entity ? entityRegions : tileRegions, sprite->index);
+        region.page = static_cast<sf::Uint16>(page);
+        region.left = static_cast<sf::Uint16>(position.x);
+        region.top = static_cast<sf::Uint16>(position.y);
+        region.width = static_cast<sf::Uint16>(size.x);
+        region.height = static_cast<sf::Uint16>(size.y);
+    }
+    
+    // The images now live in the pages
+    sprites.clear();
+    sprites.shrink_to_fit();
+    
+    buildSucceeded = succeeded;
+    built.store(true, std::memory_order_release);
+    return succeeded;
+}
+
+void TextureAtlas::buildAsync() {
+    worker = std::thread([this]() { build(); });
+}
+
+bool TextureAtlas::upload() {
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (!buildSucceeded) {
+        return false;
+    }
+    
+    textures.clear();
+    for (const sf::Image& page : pages) {
+        std::unique_ptr<sf::Texture> texture = std::make_unique<sf::Texture>();
+        if (!texture->loadFromImage(page)) {
+            std::cerr << "Failed to upload a texture atlas page" << std::endl;
+            textures.clear();
+            return false;
+        }
+        textures.push_back(std::move(texture));
+    }
+    return true;
+}
+
+const AtlasRegion& TextureAtlas::getTileRegion(int tileType) const {
+    if (tileType < 0 || static_cast<size_t>(tileType) >= tileRegions.size()) {
+        return NoRegion;
+    }
+    return tileRegions[tileType];
+}
+
+const AtlasRegion& TextureAtlas::getEntityRegion(int entityKind) const {
+    if (entityKind < 0 || static_cast<size_t>(entityKind) >= entityRegions.size()) {
+        return NoRegion;
+    }
+    return entityRegions[entityKind];
+}
+
+const sf::Texture* TextureAtlas::getTexture(size_t page) const {
+    return page < textures.size() ? textures[page].get() : nullptr;
+}
+
+sf::Image TextureAtlas::makeTileSprite(const sf::Color& color) {
+    // Same diamond and outline as a TileBatch tile, centred in the image
+    sf::FloatRect outer = TileBatch::getTileBounds(sf::Vector2f(0, 0));
+    const float halfWidth = 32.0f;
+    const float halfHeight = 16.0f;
+    float outerHalfWidth = outer.width / 2;
+    float outerHalfHeight = outer.height / 2;
+    
+    unsigned int width = 2 * static_cast<unsigned int>(std::ceil(outerHalfWidth));
+    unsigned int height = 2 * static_cast<unsigned int>(std::ceil(outerHalfHeight));
+    sf::Image image;
+    image.create(width, height, sf::Color::Transparent);
+    
+    for (unsigned int y = 0; y < height; y++) {
+        for (unsigned int x = 0; x < width; x++) {
+            float dx = std::fabs(x + 0.5f - width / 2.0f);
+            float dy = std::fabs(y + 0.5f - height / 2.0f);
+            if (dx / halfWidth + dy / halfHeight <= 1.0f) {
+                image.setPixel(x, y, color);
+            } else if (dx / outerHalfWidth + dy / outerHalfHeight <= 1.0f) {
+                image.setPixel(x, y, sf::Color::Black);
+            }
+        }
+    }
+    return image;
+}
+
+AtlasRegion& TextureAtlas::regionFor(std::vector<AtlasRegion>& table, int index) {
+    if (static_cast<size_t>(index) >= table.size()) {
+        table.resize(index + 1);
+    }
+    return table[index];
+}
+
+} // namespace IsometricMUD
@@ -0,0 +1,92 @@
+#include "TickArena.hpp"
+#include <algorithm>
+#include <new>
+
+namespace IsometricMUD {
+
+namespace {
+
+// Every block starts aligned for any fundamental type
+const size_t BlockAlignment = alignof(std::max_align_t);
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+} // namespace
+
+TickArena::TickArena(size_t initialCapacity)
+    : offset(0), capacity(std::max<size_t>(initialCapacity, 4096)), spilledBytes(0), highWater(0),
+      spillCount(0) {
+    mainBlock = allocateBlock(capacity);
+    block = mainBlock;
+    blockSize = capacity;
+}
+
+TickArena::~TickArena() {
+    for (const Block& spill : spills) {
+        freeBlock(spill.data);
+    }
+    freeBlock(mainBlock);
+}
+
+void TickArena::reset() {
+    size_t used = getUsed();
+    highWater = std::max(highWater, used);
+    
+    // The tick didn't fit: grow the main block to hold all of it next time
+    if (!spills.empty()) {
+        for (const Block& spill : spills) {
+            freeBlock(spill.data);
+        }
+        spills.clear();
+        freeBlock(mainBlock);
+        capacity = alignUp(std::max(capacity * 2, used + used / 2), BlockAlignment);
+        mainBlock = allocateBlock(capacity);
+    }
+    
+    block = mainBlock;
+    blockSize = capacity;
+    offset = 0;
+    spilledBytes = 0;
+}
+
+void* TickArena::do_allocate(size_t bytes, size_t alignment) {
+    // Blocks start max-aligned, so aligning the offset aligns the address
+    // for everything up to that; stricter requests align the address itself
+    size_t start = alignUp(offset, std::min(alignment, BlockAlignment));
+    if (alignment > BlockAlignment) {
+        std::uintptr_t address = reinterpret_cast<std::uintptr_t>(block) + start;
+        start += alignUp(address, alignment) - address;
+    }
+    
+    if (start + bytes > blockSize) {
+        size_t size = alignUp(std::max(bytes + alignment, capacity), BlockAlignment);
+        char* spill = allocateBlock(size);
+        spills.push_back({spill, size});
+        spillCount++;
+        
+        spilledBytes += offset;
+        block = spill;
+        blockSize = size;
+        offset = 0;
+        start = 0;
+        if (alignment > BlockAlignment) {
+            std::uintptr_t address = reinterpret_cast<std::uintptr_t>(block);
+            start = alignUp(address, alignment) - address;
+        }
+    }
+    
+    offset = start + bytes;
+    return block + start;
+}
+
+char* TickArena::allocateBlock(size_t size) {
+    return static_cast<char*>(::operator new(size));
+}
+
+void TickArena::freeBlock(char* data) {
+    ::operator delete(data);
+}
+
+} // namespace IsometricMUD
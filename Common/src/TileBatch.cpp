@@ -0,0 +1,113 @@
+#include "TileBatch.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace IsometricMUD {
+
+namespace {
+
+// Same diamond and outline as IsometricEngine::renderTile
+const float TileHalfWidth = 32.0f;
+const float TileHalfHeight = 16.0f;
+const float OutlineThickness = 1.0f;
+
+// Moving each edge of the diamond out by the outline thickness scales it
+// about its centre; the edges sit this far from the centre to begin with
+const float EdgeDistance = TileHalfWidth * TileHalfHeight /
+    std::sqrt(TileHalfWidth * TileHalfWidth + TileHalfHeight * TileHalfHeight);
+const float OutlineScale = (EdgeDistance + OutlineThickness) / EdgeDistance;
+
+} // namespace
+
+TileBatch::TileBatch()
+    : vertices(sf::Triangles), tileCount(0) {
+}
+
+void TileBatch::addTile(const sf::Vector2f& center, const sf::Color& color, const sf::IntRect& sprite) {
+    const float outerHalfWidth = TileHalfWidth * OutlineScale;
+    const float outerHalfHeight = TileHalfHeight * OutlineScale;
+    
+    if (sprite.width > 0) {
+        float left = center.x - sprite.width / 2.0f;
+        float top = center.y - sprite.height / 2.0f;
+        float right = left + sprite.width;
+        float bottom = top + sprite.height;
+        float u0 = static_cast<float>(sprite.left);
+        float v0 = static_cast<float>(sprite.top);
+        float u1 = u0 + sprite.width;
+        float v1 = v0 + sprite.height;
+        
+        sf::Vertex topLeft(sf::Vector2f(left, top), color, sf::Vector2f(u0, v0));
+        sf::Vertex topRight(sf::Vector2f(right, top), color, sf::Vector2f(u1, v0));
+        sf::Vertex bottomRight(sf::Vector2f(right, bottom), color, sf::Vector2f(u1, v1));
+        sf::Vertex bottomLeft(sf::Vector2f(left, bottom), color, sf::Vector2f(u0, v1));
+        vertices.append(topLeft);
+        vertices.append(topRight);
+        vertices.append(bottomRight);
+        vertices.append(topLeft);
+        vertices.append(bottomRight);
+        vertices.append(bottomLeft);
+    } else if (color.a == 255) {
+        // The fill covers all of the black diamond except the outline
+        appendDiamond(center, outerHalfWidth, outerHalfHeight, sf::Color::Black);
+        appendDiamond(center, TileHalfWidth, TileHalfHeight, color);
+    } else {
+        appendDiamond(center, TileHalfWidth, TileHalfHeight, color);
+        
+        // Top, right, bottom, left; one quad per edge between the two diamonds
+        const sf::Vector2f inner[4] = {
+            {center.x, center.y - TileHalfHeight}, {center.x + TileHalfWidth, center.y},
+            {center.x, center.y + TileHalfHeight}, {center.x - TileHalfWidth, center.y}
+        };
+        const sf::Vector2f outer[4] = {
+            {center.x, center.y - outerHalfHeight}, {center.x + outerHalfWidth, center.y},
+            {center.x, center.y + outerHalfHeight}, {center.x - outerHalfWidth, center.y}
+        };
+        for (int i = 0; i < 4; i++) {
+            int next = (i + 1) % 4;
+            vertices.append(sf::Vertex(inner[i], sf::Color::Black));
+            vertices.append(sf::Vertex(outer[i], sf::Color::Black));
+            vertices.append(sf::Vertex(outer[next], sf::Color::Black));
+            vertices.append(sf::Vertex(inner[i], sf::Color::Black));
+            vertices.append(sf::Vertex(outer[next], sf::Color::Black));
+            vertices.append(sf::Vertex(inner[next], sf::Color::Black));
+        }
+    }
+    
+    tileCount++;
+}
+
+sf::FloatRect TileBatch::getTileBounds(const sf::Vector2f& center, const sf::IntRect& sprite) {
+    const float outerHalfWidth = std::max(TileHalfWidth * OutlineScale, sprite.width / 2.0f);
+    const float outerHalfHeight = std::max(TileHalfHeight * OutlineScale, sprite.height / 2.0f);
+    return sf::FloatRect(center.x - outerHalfWidth, center.y - outerHalfHeight,
+                         outerHalfWidth * 2, outerHalfHeight * 2);
+}
+
+void TileBatch::clear() {
+    vertices.clear();
+    tileCount = 0;
+}
+
+void TileBatch::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    if (tileCount > 0) {
+        target.draw(vertices, states);
+    }
+}
+
+void TileBatch::appendDiamond(const sf::Vector2f& center, float halfWidth, float halfHeight,
+                              const sf::Color& color) {
+    sf::Vertex top(sf::Vector2f(center.x, center.y - halfHeight), color);
+    sf::Vertex right(sf::Vector2f(center.x + halfWidth, center.y), color);
+    sf::Vertex bottom(sf::Vector2f(center.x, center.y + halfHeight), color);
+    sf::Vertex left(sf::Vector2f(center.x - halfWidth, center.y), color);
+    
+    vertices.append(top);
+    vertices.append(right);
+    vertices.append(bottom);
+    vertices.append(top);
+    vertices.append(bottom);
+    vertices.append(left);
+}
+
+} // namespace IsometricMUD
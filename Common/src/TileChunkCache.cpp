@@ -0,0 +1,176 @@
+#include "TileChunkCache.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace IsometricMUD {
+
+namespace {
+
+// Vector3D::toIsometric: x + y moves a tile 16 px down, each level lifts it 24 px
+const float PixelsPerDiagonal = 16.0f;
+const float PixelsPerLevel = 24.0f;
+
+} // namespace
+
+TileChunkCache::TileChunkCache()
+    : tileCount(0), rebuildCount(0), minZ(0), maxZ(0),
+      tileHalfHeight(TileBatch::getTileBounds(sf::Vector2f(0, 0)).height / 2),
+      useBuffers(sf::VertexBuffer::isAvailable()) {
+}
+
+TileChunkCache::ChunkKey TileChunkCache::keyFor(const Vector3D& position) {
+    int chunkX = static_cast<int>(std::floor(position.x)) >> ChunkBits;
+    int chunkY = static_cast<int>(std::floor(position.y)) >> ChunkBits;
+    return ChunkKey(chunkX + chunkY, chunkX);
+}
+
+void TileChunkCache::setTile(const Vector3D& position, const sf::Color& color, const sf::IntRect& sprite) {
+    ChunkKey key = keyFor(position);
+    Chunk& chunk = chunks[key];
+    
+    tileHalfHeight = std::max(tileHalfHeight, TileBatch::getTileBounds(sf::Vector2f(0, 0), sprite).height / 2);
+    
+    auto existing = std::find_if(chunk.tiles.begin(), chunk.tiles.end(),
+                                 [&position](const ChunkTile& tile) { return tile.position == position; });
+    if (existing != chunk.tiles.end()) {
+        if (existing->color == color && existing->sprite == sprite) {
+            return;
+        }
+        existing->color = color;
+        existing->sprite = sprite;
+    } else {
+        if (tileCount == 0) {
+            minZ = maxZ = position.z;
+        } else {
+            minZ = std::min(minZ, position.z);
+            maxZ = std::max(maxZ, position.z);
+        }
+        chunk.tiles.push_back({position, color, sprite});
+        tileCount++;
+    }
+    markDirty(key, chunk);
+}
+
+void TileChunkCache::removeTile(const Vector3D& position) {
+    ChunkKey key = keyFor(position);
+    auto it = chunks.find(key);
+    if (it == chunks.end()) {
+        return;
+    }
+    
+    std::vector<ChunkTile>& tiles = it->second.tiles;
+    auto existing = std::find_if(tiles.begin(), tiles.end(),
+                                 [&position](const ChunkTile& tile) { return tile.position == position; });
+    if (existing == tiles.end()) {
+        return;
+    }
+    tiles.erase(existing);
+    tileCount--;
+    markDirty(key, it->second);
+}
+
+void TileChunkCache::clear() {
+    chunks.clear();
+    dirtyChunks.clear();
+    tileCount = 0;
+    tileHalfHeight = TileBatch::getTileBounds(sf::Vector2f(0, 0)).height / 2;
+}
+
+void TileChunkCache::update() {
+    for (const ChunkKey& key : dirtyChunks) {
+        auto it = chunks.find(key);
+        if (it == chunks.end()) {
+            continue;
+        }
+        if (it->second.tiles.empty()) {
+            chunks.erase(it);
+            continue;
+        }
+        rebuild(it->second);
+    }
+    dirtyChunks.clear();
+}
+
+bool TileChunkCache::getVisibleDiagonals(const sf::FloatRect& view, int& firstDiagonal, int& lastDiagonal) const {
+    if (chunks.empty()) {
+        return false;
+    }
+    
+    // Tiles the view can reach have x + y in this range: a tile's centre sits
+    // (x + y) * 16 - z * 24 down, and it reaches half its height further
+    float minDiagonal = (view.top - tileHalfHeight + minZ * PixelsPerLevel) / PixelsPerDiagonal;
+    float maxDiagonal = (view.top + view.height + tileHalfHeight + maxZ * PixelsPerLevel) / PixelsPerDiagonal;
+    
+    // A chunk on diagonal d holds x + y from 16d to 16d + 30 (a tile more for
+    // positions that aren't whole numbers)
+    firstDiagonal = static_cast<int>(std::floor((minDiagonal - 2 * ChunkSize) / ChunkSize));
+    lastDiagonal = static_cast<int>(std::floor(maxDiagonal / ChunkSize));
+    return true;
+}
+
+void TileChunkCache::drawChunk(sf::RenderTarget& target, const sf::RenderStates& states, const Chunk& chunk) {
+    if (chunk.buffer.getVertexCount() > 0) {
+        target.draw(chunk.buffer, states);
+    } else {
+        target.draw(chunk.geometry, states);
+    }
+}
+
+void TileChunkCache::markDirty(const ChunkKey& key, Chunk& chunk) {
+    if (!chunk.dirty) {
+        chunk.dirty = true;
+        dirtyChunks.push_back(key);
+    }
+}
+
+void TileChunkCache::rebuild(Chunk& chunk) {
+    // Back to front within the chunk
+    std::sort(chunk.tiles.begin(), chunk.tiles.end(), [](const ChunkTile& a, const ChunkTile& b) {
+        float depthA = a.position.x + a.position.y;
+        float depthB = b.position.x + b.position.y;
+        if (depthA != depthB) {
+            return depthA < depthB;
+        }
+        return a.position.z < b.position.z;
+    });
+    
+    chunk.geometry.clear();
+    float left = 0, top = 0, right = 0, bottom = 0;
+    for (const ChunkTile& tile : chunk.tiles) {
+        float screenX, screenY;
+        tile.position.toIsometric(screenX, screenY);
+        chunk.geometry.addTile(sf::Vector2f(screenX, screenY), tile.color, tile.sprite);
+        
+        sf::FloatRect area = TileBatch::getTileBounds(sf::Vector2f(screenX, screenY), tile.sprite);
+        if (chunk.geometry.getTileCount() == 1) {
+            left = area.left;
+            top = area.top;
+            right = area.left + area.width;
+            bottom = area.top + area.height;
+        } else {
+            left = std::min(left, area.left);
+            top = std::min(top, area.top);
+            right = std::max(right, area.left + area.width);
+            bottom = std::max(bottom, area.top + area.height);
+        }
+    }
+    chunk.bounds = sf::FloatRect(left, top, right - left, bottom - top);
+    
+    if (useBuffers) {
+        chunk.buffer.setPrimitiveType(sf::Triangles);
+        chunk.buffer.setUsage(sf::VertexBuffer::Static);
+        if (chunk.buffer.create(chunk.geometry.getVertexCount()) &&
+            chunk.buffer.update(chunk.geometry.getVertices())) {
+            // The GPU has a copy now
+            chunk.geometry = TileBatch();
+        } else {
+            // Out of buffer memory: this chunk stays a vertex array
+            chunk.buffer.create(0);
+        }
+    }
+    
+    chunk.dirty = false;
+    rebuildCount++;
+}
+
+} // namespace IsometricMUD
@@ -0,0 +1,106 @@
+#include "VoxelGrid.hpp"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace IsometricMUD {
+
+namespace {
+
+int toCell(float coordinate) {
+    return static_cast<int>(std::floor(coordinate + 0.5f));
+}
+
+// Round down to a chunk boundary (arithmetic shift also rounds negatives down)
+int chunkFloor(int cell) {
+    return (cell >> VoxelGrid::ChunkBits) << VoxelGrid::ChunkBits;
+}
+
+} // namespace
+
+VoxelGrid::VoxelGrid()
+    : originX(0), originY(0), originZ(0), sizeX(0), sizeY(0), sizeZ(0), chunksX(0), chunksY(0) {
+}
+
+void VoxelGrid::build(const std::vector<TileData>& tiles) {
+    clear();
+    
+    // Bounding box of the solid tiles, plus one layer on top so the headroom
+    // check above the highest floor stays inside the grid
+    int minX = INT_MAX, minY = INT_MAX, minZ = INT_MAX;
+    int maxX = INT_MIN, maxY = INT_MIN, maxZ = INT_MIN;
+    for (const auto& tile : tiles) {
+        if (!LevelFile::isSolid(tile.tileType)) {
+            continue;
+        }
+        int x = toCell(tile.position.x);
+        int y = toCell(tile.position.y);
+        int z = toCell(tile.position.z);
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        minZ = std::min(minZ, z);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+        maxZ = std::max(maxZ, z + 1);
+    }
+    if (minX > maxX) {
+        return;
+    }
+    
+    originX = chunkFloor(minX);
+    originY = chunkFloor(minY);
+    originZ = chunkFloor(minZ);
+    chunksX = static_cast<unsigned int>((maxX - originX) / ChunkSize + 1);
+    chunksY = static_cast<unsigned int>((maxY - originY) / ChunkSize + 1);
+    unsigned int chunksZ = static_cast<unsigned int>((maxZ - originZ) / ChunkSize + 1);
+    sizeX = chunksX * ChunkSize;
+    sizeY = chunksY * ChunkSize;
+    sizeZ = chunksZ * ChunkSize;
+    chunkIndex.assign(static_cast<size_t>(chunksX) * chunksY * chunksZ, -1);
+    
+    for (const auto& tile : tiles) {
+        if (LevelFile::isSolid(tile.tileType)) {
+            setSolid(toCell(tile.position.x), toCell(tile.position.y), toCell(tile.position.z), true);
+        }
+    }
+}
+
+void VoxelGrid::clear() {
+    originX = originY = originZ = 0;
+    sizeX = sizeY = sizeZ = 0;
+    chunksX = chunksY = 0;
+    chunkIndex.clear();
+    chunks.clear();
+}
+
+bool VoxelGrid::setSolid(int x, int y, int z, bool solid) {
+    unsigned int localX = static_cast<unsigned int>(x - originX);
+    unsigned int localY = static_cast<unsigned int>(y - originY);
+    unsigned int localZ = static_cast<unsigned int>(z - originZ);
+    if (localX >= sizeX || localY >= sizeY || localZ >= sizeZ) {
+        return false;
+    }
+    
+    std::int32_t& chunk = getChunkSlot(localX, localY, localZ);
+    if (chunk < 0) {
+        if (!solid) {
+            return true;
+        }
+        chunk = static_cast<std::int32_t>(chunks.size());
+        chunks.emplace_back();
+    }
+    const unsigned int mask = ChunkSize - 1;
+    chunks[chunk].set(((localZ & mask) << (2 * ChunkBits)) | ((localY & mask) << ChunkBits) | (localX & mask),
+                      solid);
+    return true;
+}
+
+bool VoxelGrid::isWalkable(const Vector3D& position) const {
+    return isWalkable(toCell(position.x), toCell(position.y), toCell(position.z));
+}
+
+size_t VoxelGrid::getMemoryUsage() const {
+    return chunks.size() * sizeof(Chunk) + chunkIndex.size() * sizeof(std::int32_t);
+}
+
+} // namespace IsometricMUD
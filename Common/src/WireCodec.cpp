@@ -0,0 +1,182 @@
+#include "WireCodec.hpp"
+#include <cstring>
+
+namespace IsometricMUD {
+
+WireWriter::WireWriter(char* buf, size_t cap)
+    : buffer(buf), capacity(cap), size(0), bitBuffer(0), bitCount(0), overflowed(false) {
+}
+
+void WireWriter::writeBits(sf::Uint32 value, int count) {
+    for (int i = 0; i < count; i++) {
+        bitBuffer |= ((value >> i) & 1u) << bitCount;
+        bitCount++;
+        if (bitCount == 8) {
+            sf::Uint8 byte = static_cast<sf::Uint8>(bitBuffer);
+            bitBuffer = 0;
+            bitCount = 0;
+            writeByte(byte);
+        }
+    }
+}
+
+void WireWriter::alignToByte() {
+    if (bitCount > 0) {
+        sf::Uint8 byte = static_cast<sf::Uint8>(bitBuffer);
+        bitBuffer = 0;
+        bitCount = 0;
+        writeByte(byte);
+    }
+}
+
+void WireWriter::writeByte(sf::Uint8 value) {
+    if (bitCount > 0) {
+        alignToByte();
+    }
+    if (size >= capacity) {
+        overflowed = true;
+        return;
+    }
+    buffer[size++] = static_cast<char>(value);
+}
+
+void WireWriter::writeVarUInt(sf::Uint64 value) {
+    while (value >= 0x80) {
+        writeByte(static_cast<sf::Uint8>(value | 0x80));
+        value >>= 7;
+    }
+    writeByte(static_cast<sf::Uint8>(value));
+}
+
+void WireWriter::writeVarSInt(sf::Int64 value) {
+    // Zigzag so small negative numbers stay short
+    sf::Uint64 zigzag = (static_cast<sf::Uint64>(value) << 1) ^ static_cast<sf::Uint64>(value >> 63);
+    writeVarUInt(zigzag);
+}
+
+void WireWriter::writeUInt16(sf::Uint16 value) {
+    writeByte(static_cast<sf::Uint8>(value));
+    writeByte(static_cast<sf::Uint8>(value >> 8));
+}
+
+void WireWriter::writeUInt32(sf::Uint32 value) {
+    for (int i = 0; i < 4; i++) {
+        writeByte(static_cast<sf::Uint8>(value >> (i * 8)));
+    }
+}
+
+void WireWriter::writeFloat(float value) {
+    sf::Uint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    writeUInt32(bits);
+}
+
+void WireWriter::writeBytes(const void* data, size_t count) {
+    alignToByte();
+    if (count > capacity - size) {
+        overflowed = true;
+        return;
+    }
+    if (count > 0) {
+        std::memcpy(buffer + size, data, count);
+    }
+    size += count;
+}
+
+bool WireWriter::finish() {
+    alignToByte();
+    return !overflowed;
+}
+
+WireReader::WireReader(const void* source, size_t length)
+    : data(static_cast<const unsigned char*>(source)), size(length), offset(0),
+      bitBuffer(0), bitCount(0), valid(true) {
+}
+
+sf::Uint32 WireReader::readBits(int count) {
+    sf::Uint32 value = 0;
+    for (int i = 0; i < count; i++) {
+        if (bitCount == 0) {
+            if (offset >= size) {
+                valid = false;
+                return 0;
+            }
+            bitBuffer = data[offset++];
+            bitCount = 8;
+        }
+        value |= (bitBuffer & 1u) << i;
+        bitBuffer >>= 1;
+        bitCount--;
+    }
+    return value;
+}
+
+void WireReader::alignToByte() {
+    // Unread bits in a partial byte are padding
+    bitBuffer = 0;
+    bitCount = 0;
+}
+
+sf::Uint8 WireReader::readByte() {
+    alignToByte();
+    if (offset >= size) {
+        valid = false;
+        return 0;
+    }
+    return data[offset++];
+}
+
+sf::Uint64 WireReader::readVarUInt() {
+    sf::Uint64 value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        sf::Uint8 byte = readByte();
+        if (!valid) {
+            return 0;
+        }
+        value |= static_cast<sf::Uint64>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+    valid = false;
+    return 0;
+}
+
+sf::Int64 WireReader::readVarSInt() {
+    sf::Uint64 zigzag = readVarUInt();
+    return static_cast<sf::Int64>(zigzag >> 1) ^ -static_cast<sf::Int64>(zigzag & 1);
+}
+
+sf::Uint16 WireReader::readUInt16() {
+    sf::Uint16 value = readByte();
+    value |= static_cast<sf::Uint16>(readByte() << 8);
+    return value;
+}
+
+sf::Uint32 WireReader::readUInt32() {
+    sf::Uint32 value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= static_cast<sf::Uint32>(readByte()) << (i * 8);
+    }
+    return value;
+}
+
+float WireReader::readFloat() {
+    sf::Uint32 bits = readUInt32();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return valid ? value : 0.0f;
+}
+
+std::string_view WireReader::readBytes(size_t count) {
+    alignToByte();
+    if (count > size - offset) {
+        valid = false;
+        return std::string_view();
+    }
+    std::string_view view(reinterpret_cast<const char*>(data + offset), count);
+    offset += count;
+    return view;
+}
+
+} // namespace IsometricMUD
@@ -31,6 +31,8 @@ private:
     void update();
     void render();
     void renderUI();
+    void rebuildLevelTiles();
+    void setLevelTile(const Vector3D& position, int tileType);
     
     std::unique_ptr<sf::RenderWindow> window;
     std::unique_ptr<IsometricEngine> engine;
@@ -42,6 +44,11 @@ private:
     int currentLayer;
     sf::Vector2i mousePos;
     Vector3D cursorPosition;
+    TileChunkCache levelTiles;  // Mirrors tileEditor; each edit rebuilds one chunk
+    
+    // Tile sprites, packed on a worker thread at startup
+    TextureAtlas atlas;
+    bool atlasPending;
 };
 
 } // namespace IsometricMUD
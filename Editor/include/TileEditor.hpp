@@ -1,21 +1,13 @@
 #pragma once
 
 #include "IsometricEngine.hpp"
+#include "LevelFile.hpp"
 #include "Vector3D.hpp"
 #include <vector>
 #include <string>
 
 namespace IsometricMUD {
 
-/**
- * @brief Tile data for the editor
- */
-struct TileData {
-    Vector3D position;
-    int tileType;
-    std::string scriptName;
-};
-
 /**
  * @brief Tile editor for creating game levels
  */
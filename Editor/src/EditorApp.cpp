@@ -1,11 +1,31 @@
 #include "EditorApp.hpp"
 #include <iostream>
+#include <fstream>
 #include <cmath>
+#include <string>
 
 namespace IsometricMUD {
 
+namespace {
+
+sf::Color getTileColor(int tileType) {
+    switch (tileType) {
+        case 0: return sf::Color(100, 150, 100); // Grass
+        case 1: return sf::Color(150, 150, 150); // Stone
+        case 2: return sf::Color(139, 69, 19);   // Wood
+        case 3: return sf::Color(100, 100, 200); // Water
+        case 4: return sf::Color(200, 200, 100); // Sand
+        default: return sf::Color::White;
+    }
+}
+
+// Artists drop Assets/tiles/<type>.png in; missing types get a flat tile
+const char* TileArtDirectory = "Assets/tiles/";
+
+} // namespace
+
 EditorApp::EditorApp() 
-    : running(false), currentTileType(0), currentLayer(0), cursorPosition(0, 0, 0) {
+    : running(false), currentTileType(0), currentLayer(0), cursorPosition(0, 0, 0), atlasPending(false) {
 }
 
 EditorApp::~EditorApp() {
@@ -24,6 +44,17 @@ bool EditorApp::initialize() {
     tileEditor = std::make_unique<TileEditor>();
     scriptEngine = std::make_unique<ScriptEngine>();
     
+    for (int type = 0; type <= static_cast<int>(TileType::SAND); type++) {
+        std::string path = TileArtDirectory + std::to_string(type) + ".png";
+        sf::Image image;
+        if (!std::ifstream(path).good() || !image.loadFromFile(path)) {
+            image = TextureAtlas::makeTileSprite(getTileColor(type));
+        }
+        atlas.addTileSprite(type, image);
+    }
+    atlas.buildAsync();
+    atlasPending = true;
+    
     std::cout << "Editor initialized successfully" << std::endl;
     return true;
 }
@@ -77,11 +108,13 @@ void EditorApp::handleEvents() {
                 case sf::Keyboard::L:
                     if (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)) {
                         tileEditor->loadLevel("level.dat");
+                        rebuildLevelTiles();
                     }
                     break;
                 case sf::Keyboard::N:
                     if (sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)) {
                         tileEditor->clear();
+                        levelTiles.clear();
                         std::cout << "New level created" << std::endl;
                     }
                     break;
@@ -94,11 +127,13 @@ void EditorApp::handleEvents() {
             if (event.mouseButton.button == sf::Mouse::Left) {
                 // Place tile
                 tileEditor->placeTile(cursorPosition, currentTileType);
+                setLevelTile(cursorPosition, currentTileType);
                 std::cout << "Placed tile at (" << cursorPosition.x << ", " 
                           << cursorPosition.y << ", " << cursorPosition.z << ")" << std::endl;
             } else if (event.mouseButton.button == sf::Mouse::Right) {
                 // Remove tile
                 tileEditor->removeTile(cursorPosition);
+                levelTiles.removeTile(cursorPosition);
                 std::cout << "Removed tile at (" << cursorPosition.x << ", " 
                           << cursorPosition.y << ", " << cursorPosition.z << ")" << std::endl;
             }
@@ -123,22 +158,22 @@ void EditorApp::update() {
 
 void EditorApp::render() {
     window->clear(sf::Color(40, 40, 50));
+    engine->resetStats();
     
-    // Render all tiles in the level
-    for (const auto& tile : tileEditor->getTiles()) {
-        sf::Color color;
-        switch (tile.tileType) {
-            case 0: color = sf::Color(100, 150, 100); break; // Grass
-            case 1: color = sf::Color(150, 150, 150); break; // Stone
-            case 2: color = sf::Color(139, 69, 19); break;   // Wood
-            case 3: color = sf::Color(100, 100, 200); break; // Water
-            case 4: color = sf::Color(200, 200, 100); break; // Sand
-            default: color = sf::Color::White; break;
+    // Switch the level to sprites once the atlas is packed
+    if (atlasPending && atlas.isBuilt()) {
+        atlasPending = false;
+        if (atlas.upload()) {
+            engine->setAtlas(&atlas);
+            rebuildLevelTiles();
+        } else {
+            std::cerr << "Texture atlas unavailable; drawing flat tiles" << std::endl;
         }
-        
-        engine->renderTile(*window, tile.position, color);
     }
     
+    // Render all tiles in the level; only edited chunks are rebuilt
+    engine->renderChunks(*window, levelTiles);
+    
     // Render cursor
     engine->renderTile(*window, cursorPosition, sf::Color(255, 255, 0, 128));
     
@@ -147,6 +182,18 @@ void EditorApp::render() {
     window->display();
 }
 
+void EditorApp::rebuildLevelTiles() {
+    levelTiles.clear();
+    for (const auto& tile : tileEditor->getTiles()) {
+        setLevelTile(tile.position, tile.tileType);
+    }
+}
+
+void EditorApp::setLevelTile(const Vector3D& position, int tileType) {
+    sf::IntRect sprite = engine->getTileSprite(tileType);
+    levelTiles.setTile(position, sprite.width > 0 ? sf::Color::White : getTileColor(tileType), sprite);
+}
+
 void EditorApp::renderUI() {
     // Draw simple UI text indicators
     // In a real implementation, would use proper UI with fonts
@@ -1,6 +1,5 @@
 #include "TileEditor.hpp"
-#include <fstream>
-#include <iostream>
+#include <algorithm>
 
 namespace IsometricMUD {
 
@@ -46,65 +45,11 @@ TileData* TileEditor::getTile(const Vector3D& position) {
 }
 
 bool TileEditor::saveLevel(const std::string& filename) {
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Failed to save level: " << filename << std::endl;
-        return false;
-    }
-    
-    // Write number of tiles
-    size_t numTiles = tiles.size();
-    file.write(reinterpret_cast<const char*>(&numTiles), sizeof(numTiles));
-    
-    // Write each tile
-    for (const auto& tile : tiles) {
-        file.write(reinterpret_cast<const char*>(&tile.position.x), sizeof(float));
-        file.write(reinterpret_cast<const char*>(&tile.position.y), sizeof(float));
-        file.write(reinterpret_cast<const char*>(&tile.position.z), sizeof(float));
-        file.write(reinterpret_cast<const char*>(&tile.tileType), sizeof(int));
-        
-        size_t nameLen = tile.scriptName.length();
-        file.write(reinterpret_cast<const char*>(&nameLen), sizeof(nameLen));
-        file.write(tile.scriptName.c_str(), nameLen);
-    }
-    
-    file.close();
-    std::cout << "Level saved: " << filename << " (" << numTiles << " tiles)" << std::endl;
-    return true;
+    return LevelFile::save(filename, tiles);
 }
 
 bool TileEditor::loadLevel(const std::string& filename) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Failed to load level: " << filename << std::endl;
-        return false;
-    }
-    
-    clear();
-    
-    // Read number of tiles
-    size_t numTiles;
-    file.read(reinterpret_cast<char*>(&numTiles), sizeof(numTiles));
-    
-    // Read each tile
-    for (size_t i = 0; i < numTiles; i++) {
-        TileData tile;
-        file.read(reinterpret_cast<char*>(&tile.position.x), sizeof(float));
-        file.read(reinterpret_cast<char*>(&tile.position.y), sizeof(float));
-        file.read(reinterpret_cast<char*>(&tile.position.z), sizeof(float));
-        file.read(reinterpret_cast<char*>(&tile.tileType), sizeof(int));
-        
-        size_t nameLen;
-        file.read(reinterpret_cast<char*>(&nameLen), sizeof(nameLen));
-        tile.scriptName.resize(nameLen);
-        file.read(&tile.scriptName[0], nameLen);
-        
-        tiles.push_back(tile);
-    }
-    
-    file.close();
-    std::cout << "Level loaded: " << filename << " (" << numTiles << " tiles)" << std::endl;
-    return true;
+    return LevelFile::load(filename, tiles);
 }
 
 void TileEditor::clear() {
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include <SFML/System.hpp>
+#include "Vector3D.hpp"
+#include "NetworkProtocol.hpp"
+#include "Snapshot.hpp"
+#include "Histogram.hpp"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Load generator settings
+ */
+struct LoadGenConfig {
+    std::string host = "127.0.0.1";
+    unsigned short port = 53000;
+    unsigned int bots = 100;            // Simulated clients
+    unsigned int threads = 4;           // Worker threads sharing the bots
+    unsigned int duration = 30;         // Seconds to run, including the ramp-up
+    float moveRate = 5.0f;              // Moves per second per bot
+    float chatRate = 0.1f;              // Chat messages per second per bot
+    ChatChannel chatChannel = ChatChannel::GLOBAL;
+    unsigned int parties = 1;           // Bots are dealt round-robin into this many parties (PARTY only)
+    unsigned int connectRate = 200;     // New connections per second (ramp-up)
+    unsigned int stalledBots = 0;       // Bots that connect but never read (slow consumers)
+};
+
+/**
+ * @brief Thousands of headless clients driving a server with random walks
+ *
+ * Bots are spread over a few worker threads, each polling its share of
+ * non-blocking sockets. Connects are non-blocking too and complete on a
+ * later poll, so a slow handshake never holds up the other bots. Every bot
+ * keeps at most one move in flight, so the time from sending a MOVE to
+ * receiving its own position back (as an UPDATE_POSITION or inside a
+ * SNAPSHOT) is a clean round-trip sample.
+ */
+class BotSwarm {
+public:
+    explicit BotSwarm(const LoadGenConfig& config);
+    ~BotSwarm();
+
+    /**
+     * @brief Run the swarm for the configured duration (blocks)
+     * @param progress Receives a one-line status every few seconds
+     */
+    void run(std::ostream& progress);
+
+    /**
+     * @brief Write the final results as a single JSON object
+     */
+    void writeSummary(std::ostream& out) const;
+
+private:
+    struct Bot {
+        unsigned int index = 0;
+        std::unique_ptr<sf::TcpSocket> socket;
+        bool attempted = false;
+        bool connecting = false;
+        bool connected = false;
+        bool stalled = false;
+        sf::Uint32 id = 0;
+        Vector3D position;
+        std::mt19937 random;
+        std::deque<sf::Packet> outgoing;
+
+        sf::Time connectAt;                // Scheduled start, then when the attempt began
+        sf::Time nextMove;
+        sf::Time nextChat;
+        bool moveInFlight = false;
+        sf::Time moveSentAt;
+
+        SnapshotHistory snapshots;
+        Snapshot latestSnapshot;
+    };
+
+    void runWorker(unsigned int workerIndex);
+    void connectBot(Bot& bot, sf::Time now);
+    void finishConnect(Bot& bot, sf::Time now);
+    void updateBot(Bot& bot, sf::Time now);
+    void handlePacket(Bot& bot, sf::Packet& packet);
+    void handleSnapshot(Bot& bot, const sf::Packet& packet);
+    void onOwnPosition(Bot& bot, const Vector3D& position);
+    void queuePacket(Bot& bot, sf::Packet packet);
+    bool flushOutgoing(Bot& bot);
+    void dropBot(Bot& bot);
+    sf::Time randomInterval(Bot& bot, float rate);
+    sf::Uint32 getParty(const Bot& bot) const;
+
+    LoadGenConfig config;
+    sf::IpAddress address;             // config.host, resolved once up front
+    std::atomic<bool> running;
+    sf::Clock clock;
+    sf::Time elapsed;
+    std::vector<std::thread> workers;
+
+    // Shared between workers; counters are relaxed atomics
+    Histogram moveLatency;             // Microseconds from MOVE to own position update
+    std::atomic<std::uint64_t> connectFailures;
+    std::atomic<std::uint64_t> connectedBots;
+    std::atomic<std::uint64_t> disconnects;
+    std::atomic<std::uint64_t> movesSent;
+    std::atomic<std::uint64_t> moveTimeouts;
+    std::atomic<std::uint64_t> chatsSent;
+    std::atomic<std::uint64_t> chatsReceived;
+    std::atomic<std::uint64_t> messagesReceived;
+    std::atomic<std::uint64_t> bytesReceived;
+};
+
+} // namespace IsometricMUD
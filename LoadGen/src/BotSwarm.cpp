@@ -0,0 +1,371 @@
+#include "BotSwarm.hpp"
+#include "NetworkProtocol.hpp"
+#include <iomanip>
+
+namespace IsometricMUD {
+
+namespace {
+
+// A move with no position back after this long is counted as lost
+const sf::Time MoveTimeout = sf::seconds(5.0f);
+
+const sf::Time ConnectTimeout = sf::seconds(5.0f);
+
+const sf::Time ProgressInterval = sf::seconds(5.0f);
+
+double toMilliseconds(std::uint64_t microseconds) {
+    return static_cast<double>(microseconds) / 1000.0;
+}
+
+} // namespace
+
+BotSwarm::BotSwarm(const LoadGenConfig& loadConfig)
+    : config(loadConfig), address(loadConfig.host), running(false), connectFailures(0), connectedBots(0),
+      disconnects(0), movesSent(0), moveTimeouts(0), chatsSent(0), chatsReceived(0),
+      messagesReceived(0), bytesReceived(0) {
+    if (config.threads == 0) {
+        config.threads = 1;
+    }
+    if (config.connectRate == 0) {
+        config.connectRate = 1;
+    }
+}
+
+BotSwarm::~BotSwarm() {
+    running = false;
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void BotSwarm::run(std::ostream& progress) {
+    running = true;
+    clock.restart();
+    
+    for (unsigned int i = 0; i < config.threads; i++) {
+        workers.emplace_back(&BotSwarm::runWorker, this, i);
+    }
+    
+    sf::Time duration = sf::seconds(static_cast<float>(config.duration));
+    sf::Time nextReport = ProgressInterval;
+    std::uint64_t lastMoves = 0;
+    
+    while (clock.getElapsedTime() < duration) {
+        sf::sleep(sf::milliseconds(100));
+        
+        sf::Time now = clock.getElapsedTime();
+        if (now >= nextReport) {
+            std::uint64_t moves = movesSent.load(std::memory_order_relaxed);
+            progress << "t=" << static_cast<int>(now.asSeconds()) << "s"
+                     << " connected=" << connectedBots.load(std::memory_order_relaxed)
+                     << "/" << config.bots
+                     << " moves/s=" << static_cast<double>(moves - lastMoves) / ProgressInterval.asSeconds()
+                     << " p50=" << toMilliseconds(moveLatency.percentile(0.50)) << "ms"
+                     << " p99=" << toMilliseconds(moveLatency.percentile(0.99)) << "ms"
+                     << " disconnects=" << disconnects.load(std::memory_order_relaxed)
+                     << std::endl;
+            lastMoves = moves;
+            nextReport += ProgressInterval;
+        }
+    }
+    
+    running = false;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    elapsed = clock.getElapsedTime();
+}
+
+void BotSwarm::runWorker(unsigned int workerIndex) {
+    // Each worker owns every threads-th bot; nothing here is shared
+    std::vector<std::unique_ptr<Bot>> bots;
+    for (unsigned int i = workerIndex; i < config.bots; i += config.threads) {
+        auto bot = std::make_unique<Bot>();
+        bot->index = i;
+        bot->stalled = i < config.stalledBots;
+        bot->random.seed(i * 7919u + 1u);
+        bot->connectAt = sf::seconds(static_cast<float>(i) / static_cast<float>(config.connectRate));
+        bots.push_back(std::move(bot));
+    }
+    
+    while (running) {
+        sf::Time now = clock.getElapsedTime();
+        for (auto& bot : bots) {
+            if (!bot->attempted) {
+                if (now >= bot->connectAt) {
+                    connectBot(*bot, now);
+                }
+            } else if (bot->connecting) {
+                finishConnect(*bot, now);
+            } else if (bot->connected && !bot->stalled) {
+                updateBot(*bot, now);
+            }
+        }
+        sf::sleep(sf::milliseconds(1));
+    }
+    
+    for (auto& bot : bots) {
+        if (bot->connected) {
+            bot->socket->disconnect();
+        }
+    }
+}
+
+void BotSwarm::connectBot(Bot& bot, sf::Time now) {
+    bot.attempted = true;
+    bot.connectAt = now;
+    bot.socket = std::make_unique<sf::TcpSocket>();
+    bot.socket->setBlocking(false);
+    
+    // Returns at once; the handshake is checked on the worker's later passes
+    // so the thread's other bots keep running meanwhile
+    sf::Socket::Status status = bot.socket->connect(address, config.port);
+    if (status != sf::Socket::Done && status != sf::Socket::NotReady) {
+        connectFailures++;
+        return;
+    }
+    bot.connecting = true;
+    finishConnect(bot, now);
+}
+
+void BotSwarm::finishConnect(Bot& bot, sf::Time now) {
+    // The socket only has a peer address once the handshake has completed
+    if (bot.socket->getRemoteAddress() == sf::IpAddress::None) {
+        if (now - bot.connectAt > ConnectTimeout) {
+            bot.connecting = false;
+            bot.socket->disconnect();
+            connectFailures++;
+        }
+        return;
+    }
+    
+    bot.connecting = false;
+    bot.connected = true;
+    connectedBots++;
+    
+    bot.nextMove = now + randomInterval(bot, config.moveRate);
+    bot.nextChat = now + randomInterval(bot, config.chatRate);
+    
+    if (config.chatChannel == ChatChannel::PARTY) {
+        queuePacket(bot, NetworkProtocol::createChatSubscribePacket(ChatChannel::PARTY, getParty(bot), true));
+    }
+}
+
+void BotSwarm::updateBot(Bot& bot, sf::Time now) {
+    sf::Packet packet;
+    while (true) {
+        sf::Socket::Status status = bot.socket->receive(packet);
+        if (status == sf::Socket::Done) {
+            bytesReceived.fetch_add(packet.getDataSize() + 4, std::memory_order_relaxed);
+            handlePacket(bot, packet);
+            continue;
+        }
+        if (status == sf::Socket::Disconnected || status == sf::Socket::Error) {
+            dropBot(bot);
+            return;
+        }
+        break;
+    }
+    
+    // Nothing is sent until CONNECT tells the bot its entity id
+    if (bot.id == 0) {
+        return;
+    }
+    
+    if (bot.moveInFlight && now - bot.moveSentAt > MoveTimeout) {
+        moveTimeouts++;
+        bot.moveInFlight = false;
+    }
+    
+    // Random walk on the ground plane, one move in flight at a time
+    if (config.moveRate > 0.0f && !bot.moveInFlight && now >= bot.nextMove) {
+        Direction dir = static_cast<Direction>(bot.random() % 4);
+        queuePacket(bot, NetworkProtocol::createMovePacket(bot.id, dir));
+        bot.moveInFlight = true;
+        bot.moveSentAt = now;
+        bot.nextMove = now + randomInterval(bot, config.moveRate);
+        movesSent++;
+    }
+    
+    if (config.chatRate > 0.0f && now >= bot.nextChat) {
+        sf::Uint32 topic = config.chatChannel == ChatChannel::PARTY ? getParty(bot) : 0;
+        queuePacket(bot, NetworkProtocol::createChatPacket(config.chatChannel, topic,
+            "bot " + std::to_string(bot.index) + " says hello"));
+        bot.nextChat = now + randomInterval(bot, config.chatRate);
+        chatsSent++;
+    }
+    
+    if (!flushOutgoing(bot)) {
+        dropBot(bot);
+    }
+}
+
+void BotSwarm::handlePacket(Bot& bot, sf::Packet& packet) {
+    PacketType type = NetworkProtocol::getPacketType(packet.getData(), packet.getDataSize());
+    
+    if (type == PacketType::BATCH) {
+        std::vector<sf::Packet> messages;
+        if (NetworkProtocol::unpackBatch(packet, messages)) {
+            for (auto& message : messages) {
+                handlePacket(bot, message);
+            }
+        }
+        return;
+    }
+    
+    messagesReceived.fetch_add(1, std::memory_order_relaxed);
+    
+    switch (type) {
+        case PacketType::CONNECT: {
+            // Bots never open the UDP channel, so the server keeps them on TCP
+            sf::Uint32 udpToken;
+            unsigned short udpPort;
+            NetworkProtocol::parseConnectPacket(packet, bot.id, udpToken, udpPort);
+            break;
+        }
+        case PacketType::UPDATE_POSITION: {
+            sf::Uint32 entityId;
+            Vector3D position;
+            if (NetworkProtocol::parsePositionPacket(packet, entityId, position) && entityId == bot.id) {
+                onOwnPosition(bot, position);
+            }
+            break;
+        }
+        case PacketType::SNAPSHOT: {
+            handleSnapshot(bot, packet);
+            break;
+        }
+        case PacketType::CHAT: {
+            chatsReceived.fetch_add(1, std::memory_order_relaxed);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void BotSwarm::handleSnapshot(Bot& bot, const sf::Packet& packet) {
+    WireReader reader(packet.getData(), packet.getDataSize());
+    sf::Uint32 sequence;
+    sf::Uint32 baselineSequence;
+    if (!SnapshotCodec::readHeader(reader, sequence, baselineSequence)) {
+        return;
+    }
+    
+    static const Snapshot emptyBaseline;
+    const Snapshot* baseline = &emptyBaseline;
+    if (baselineSequence != 0) {
+        baseline = bot.snapshots.find(baselineSequence);
+        if (!baseline) {
+            return;
+        }
+    }
+    
+    if (!SnapshotCodec::decode(reader, *baseline, bot.latestSnapshot)) {
+        return;
+    }
+    bot.latestSnapshot.sequence = sequence;
+    bot.snapshots.store(bot.latestSnapshot);
+    queuePacket(bot, NetworkProtocol::createSnapshotAckPacket(sequence));
+    
+    const SnapshotEntity* self = bot.latestSnapshot.find(bot.id);
+    if (self) {
+        Vector3D position = Snapshot::toPosition(*self);
+        if (position.x != bot.position.x || position.y != bot.position.y ||
+            position.z != bot.position.z) {
+            onOwnPosition(bot, position);
+        }
+    }
+}
+
+void BotSwarm::onOwnPosition(Bot& bot, const Vector3D& position) {
+    bot.position = position;
+    if (bot.moveInFlight) {
+        sf::Time latency = clock.getElapsedTime() - bot.moveSentAt;
+        moveLatency.record(static_cast<std::uint64_t>(latency.asMicroseconds()));
+        bot.moveInFlight = false;
+    }
+}
+
+void BotSwarm::queuePacket(Bot& bot, sf::Packet packet) {
+    bot.outgoing.push_back(std::move(packet));
+}
+
+bool BotSwarm::flushOutgoing(Bot& bot) {
+    // A non-blocking send may stop part-way; SFML resumes the same packet
+    while (!bot.outgoing.empty()) {
+        sf::Socket::Status status = bot.socket->send(bot.outgoing.front());
+        if (status == sf::Socket::Done) {
+            bot.outgoing.pop_front();
+        } else if (status == sf::Socket::Partial || status == sf::Socket::NotReady) {
+            return true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void BotSwarm::dropBot(Bot& bot) {
+    bot.socket->disconnect();
+    bot.connected = false;
+    bot.outgoing.clear();
+    connectedBots--;
+    disconnects++;
+}
+
+sf::Uint32 BotSwarm::getParty(const Bot& bot) const {
+    return bot.index % config.parties + 1;
+}
+
+sf::Time BotSwarm::randomInterval(Bot& bot, float rate) {
+    if (rate <= 0.0f) {
+        return sf::Time::Zero;
+    }
+    // Exponential gaps make each bot a Poisson source, so bots don't march in step
+    return sf::seconds(std::exponential_distribution<float>(rate)(bot.random));
+}
+
+void BotSwarm::writeSummary(std::ostream& out) const {
+    double seconds = elapsed.asSeconds() > 0.0f ? elapsed.asSeconds() : 1.0;
+    std::uint64_t moves = movesSent.load(std::memory_order_relaxed);
+    std::uint64_t messages = messagesReceived.load(std::memory_order_relaxed);
+    std::uint64_t bytes = bytesReceived.load(std::memory_order_relaxed);
+    
+    out << std::fixed << std::setprecision(1);
+    out << "{"
+        << "\"bots\":" << config.bots
+        << ",\"threads\":" << config.threads
+        << ",\"stalled_bots\":" << config.stalledBots
+        << ",\"duration_s\":" << seconds
+        << ",\"move_rate\":" << config.moveRate
+        << ",\"chat_rate\":" << config.chatRate
+        << ",\"chat_channel\":\"" << NetworkProtocol::getChatChannelName(config.chatChannel) << "\""
+        << ",\"parties\":" << config.parties
+        << ",\"connected\":" << connectedBots.load(std::memory_order_relaxed)
+        << ",\"connect_failures\":" << connectFailures.load(std::memory_order_relaxed)
+        << ",\"disconnects\":" << disconnects.load(std::memory_order_relaxed)
+        << ",\"moves_sent\":" << moves
+        << ",\"move_timeouts\":" << moveTimeouts.load(std::memory_order_relaxed)
+        << ",\"chats_sent\":" << chatsSent.load(std::memory_order_relaxed)
+        << ",\"chats_received\":" << chatsReceived.load(std::memory_order_relaxed)
+        << ",\"messages_received\":" << messages
+        << ",\"bytes_received\":" << bytes
+        << ",\"moves_per_s\":" << moves / seconds
+        << ",\"messages_per_s\":" << messages / seconds
+        << ",\"chats_received_per_s\":" << chatsReceived.load(std::memory_order_relaxed) / seconds
+        << ",\"bytes_per_s\":" << bytes / seconds
+        << ",\"move_latency_us\":{"
+        << "\"count\":" << moveLatency.getCount()
+        << ",\"p50\":" << moveLatency.percentile(0.50)
+        << ",\"p90\":" << moveLatency.percentile(0.90)
+        << ",\"p99\":" << moveLatency.percentile(0.99)
+        << ",\"p999\":" << moveLatency.percentile(0.999)
+        << ",\"max\":" << moveLatency.getMax()
+        << "}}" << std::endl;
+}
+
+} // namespace IsometricMUD
@@ -0,0 +1,146 @@
+#include "BotSwarm.hpp"
+#include <iostream>
+#include <string>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [server_address] [port] [options]" << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  --bots <n>               Simulated clients (default 100)" << std::endl;
+    std::cerr << "  --threads <n>            Worker threads (default 4)" << std::endl;
+    std::cerr << "  --duration <sec>         Total run time including ramp-up (default 30)" << std::endl;
+    std::cerr << "  --move-rate <hz>         Moves per second per bot (default 5)" << std::endl;
+    std::cerr << "  --chat-rate <hz>         Chat messages per second per bot (default 0.1)" << std::endl;
+    std::cerr << "  --chat-channel <name>    global, zone, party or proximity (default global)" << std::endl;
+    std::cerr << "  --parties <n>            With --chat-channel party, split the bots into n parties (default 1)" << std::endl;
+    std::cerr << "  --connect-rate <n>       New connections per second (default 200)" << std::endl;
+    std::cerr << "  --stalled-bots <n>       Bots that connect but never read their socket (default 0)" << std::endl;
+    std::cerr << "Progress goes to stderr; the JSON summary is printed to stdout." << std::endl;
+}
+
+bool parseNumber(const std::string& text, int minValue, int maxValue, int& result) {
+    try {
+        int value = std::stoi(text);
+        if (value < minValue || value > maxValue) {
+            return false;
+        }
+        result = value;
+        return true;
+    } catch (const std::exception& e) {
+        return false;
+    }
+}
+
+bool parseRate(const std::string& text, float& result) {
+    try {
+        float value = std::stof(text);
+        if (value < 0.0f || value > 1000.0f) {
+            return false;
+        }
+        result = value;
+        return true;
+    } catch (const std::exception& e) {
+        return false;
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    IsometricMUD::LoadGenConfig config;
+    int positional = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        int value = 0;
+        
+        if (arg == "--bots" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 100000, value)) {
+                std::cerr << "Error: Bot count must be between 1 and 100000" << std::endl;
+                return 1;
+            }
+            config.bots = static_cast<unsigned int>(value);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 256, value)) {
+                std::cerr << "Error: Thread count must be between 1 and 256" << std::endl;
+                return 1;
+            }
+            config.threads = static_cast<unsigned int>(value);
+        } else if (arg == "--duration" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 86400, value)) {
+                std::cerr << "Error: Invalid duration '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.duration = static_cast<unsigned int>(value);
+        } else if (arg == "--move-rate" && i + 1 < argc) {
+            if (!parseRate(argv[++i], config.moveRate)) {
+                std::cerr << "Error: Invalid move rate '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--chat-rate" && i + 1 < argc) {
+            if (!parseRate(argv[++i], config.chatRate)) {
+                std::cerr << "Error: Invalid chat rate '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--chat-channel" && i + 1 < argc) {
+            std::string name = argv[++i];
+            bool known = false;
+            for (int channel = 0; channel < static_cast<int>(IsometricMUD::ChatChannel::COUNT); channel++) {
+                auto candidate = static_cast<IsometricMUD::ChatChannel>(channel);
+                if (candidate != IsometricMUD::ChatChannel::WHISPER &&
+                    name == IsometricMUD::NetworkProtocol::getChatChannelName(candidate)) {
+                    config.chatChannel = candidate;
+                    known = true;
+                }
+            }
+            if (!known) {
+                std::cerr << "Error: Chat channel must be global, zone, party or proximity" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--parties" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 100000, value)) {
+                std::cerr << "Error: Invalid party count '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.parties = static_cast<unsigned int>(value);
+        } else if (arg == "--connect-rate" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 100000, value)) {
+                std::cerr << "Error: Invalid connect rate '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.connectRate = static_cast<unsigned int>(value);
+        } else if (arg == "--stalled-bots" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 0, 100000, value)) {
+                std::cerr << "Error: Invalid stalled bot count '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.stalledBots = static_cast<unsigned int>(value);
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        } else if (positional == 0) {
+            config.host = arg;
+            positional++;
+        } else {
+            if (!parseNumber(arg, 1, 65535, value)) {
+                std::cerr << "Error: Invalid port number '" << arg << "'" << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            config.port = static_cast<unsigned short>(value);
+            positional++;
+        }
+    }
+    
+    std::cerr << "Load generator: " << config.bots << " bots on " << config.threads
+              << " threads against " << config.host << ":" << config.port
+              << " for " << config.duration << "s" << std::endl;
+    
+    IsometricMUD::BotSwarm swarm(config);
+    swarm.run(std::cerr);
+    swarm.writeSummary(std::cout);
+    
+    return 0;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <SFML/Config.hpp>
+#include "NetworkProtocol.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace IsometricMUD {
+
+struct ClientInfo;
+
+/**
+ * @brief Set of chat members, one bit per member slot
+ *
+ * Slots are dense and reused, so even a channel everyone is in costs one
+ * bit per connected client, and walking it skips 64 absent members at once.
+ */
+class SubscriberSet {
+public:
+    void add(sf::Uint32 slot);
+    void remove(sf::Uint32 slot);
+    bool contains(sf::Uint32 slot) const {
+        size_t word = slot / 64;
+        return word < words.size() && (words[word] >> (slot % 64) & 1) != 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    /**
+     * @brief Call back with every slot in the set, in ascending order
+     */
+    template <typename Callback>
+    void forEach(Callback&& callback) const {
+        for (size_t word = 0; word < words.size(); word++) {
+            for (std::uint64_t bits = words[word]; bits != 0; bits &= bits - 1) {
+                callback(static_cast<sf::Uint32>(word * 64 + lowestBit(bits)));
+            }
+        }
+    }
+
+private:
+    static unsigned int lowestBit(std::uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned int>(__builtin_ctzll(bits));
+#else
+        unsigned int bit = 0;
+        while ((bits & 1) == 0) {
+            bits >>= 1;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+    std::vector<std::uint64_t> words;
+    size_t count = 0;
+};
+
+/**
+ * @brief Chat channel subscriptions and per-sender rate limits
+ *
+ * Every client is a member with a slot; channels are SubscriberSets over
+ * those slots. New members join GLOBAL and ZONE; parties are joined by
+ * number, and a party's set is dropped once its last member leaves.
+ * WHISPER and PROXIMITY have no subscriptions: their audience is worked out
+ * per message by the server.
+ *
+ * Each member has a token bucket refilled every tick, so a sender may burst
+ * a few messages and then keeps to the sustained rate.
+ */
+class ChatService {
+public:
+    // A member can be in this many parties at once
+    static const size_t MaxPartiesPerMember = 8;
+
+    /**
+     * @param messagesPerSecond Sustained rate each sender is allowed
+     * @param burst Messages a sender may send back to back after being quiet
+     * @param tickRate Ticks per second, the unit the buckets are refilled in
+     */
+    ChatService(float messagesPerSecond, float burst, unsigned int tickRate);
+
+    /**
+     * @brief Give a client a slot and subscribe it to GLOBAL and ZONE
+     */
+    void addMember(ClientInfo& client);
+
+    /**
+     * @brief Leave every channel and free the client's slot
+     */
+    void removeMember(ClientInfo& client);
+
+    /**
+     * @brief Join or leave a channel
+     * @return False if the channel takes no subscriptions or the party limit is reached
+     */
+    bool subscribe(const ClientInfo& client, ChatChannel channel, sf::Uint32 topic, bool join);
+
+    bool isSubscribed(const ClientInfo& client, ChatChannel channel, sf::Uint32 topic) const;
+
+    /**
+     * @brief Take a token from the client's bucket
+     * @return False if the client is over its rate and the message should be dropped
+     */
+    bool allowMessage(const ClientInfo& client, sf::Uint64 tick);
+
+    /**
+     * @brief Call back with every client subscribed to a channel
+     * @return Number of subscribers
+     */
+    template <typename Callback>
+    size_t forEachSubscriber(ChatChannel channel, sf::Uint32 topic, Callback&& callback) const {
+        const SubscriberSet* set = findSet(channel, topic);
+        if (!set) {
+            return 0;
+        }
+        set->forEach([this, &callback](sf::Uint32 slot) {
+            callback(*members[slot].client);
+        });
+        return set->size();
+    }
+
+    size_t getPartyCount() const { return parties.size(); }
+
+private:
+    struct Member {
+        ClientInfo* client = nullptr;
+        float tokens = 0.0f;
+        sf::Uint64 lastRefill = 0;
+        std::vector<sf::Uint32> parties;
+    };
+
+    const SubscriberSet* findSet(ChatChannel channel, sf::Uint32 topic) const;
+
+    float tokensPerTick;
+    float burst;
+
+    std::vector<Member> members;
+    std::vector<sf::Uint32> freeSlots;
+
+    SubscriberSet global;
+    SubscriberSet zone;
+    std::unordered_map<sf::Uint32, SubscriberSet> parties;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include "EntityStore.hpp"
+#include "SocketPoller.hpp"
+#include "DatagramChannel.hpp"
+#include "LockFreeQueue.hpp"
+#include "OutboundQueue.hpp"
+#include "Snapshot.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Represents a connected client
+ */
+struct ClientInfo {
+    /**
+     * @param tickResource Where the outbox keeps what it rebuilds every tick
+     */
+    explicit ClientInfo(std::pmr::memory_resource* tickResource = std::pmr::get_default_resource())
+        : outbox(tickResource) {}
+
+    sf::Uint32 id;
+    std::unique_ptr<PollableSocket> socket;
+    EntityHandle entity;        // Position and the rest live in the server's EntityStore
+    std::string name;
+    sf::Uint32 playerId = 0;    // Persistent player after LOGIN (0 = anonymous, not saved)
+    sf::Uint32 chatSlot = 0;    // Member slot in the ChatService
+    sf::Uint64 nextScriptEventTick = 0; // Earliest tick its next SCRIPT_EVENT is accepted
+    bool connected = true;
+    OutboundQueue outbox;
+    SendQueue sendQueue;
+    
+    // Backpressure: while the send queue is above the high watermark, position
+    // updates are dropped, and every visible position is resent once it drains
+    bool congested = false;
+    unsigned int congestedTicks = 0;
+    bool resyncPositions = false;
+    
+    // Snapshot mode: what was sent, so any acknowledged snapshot can be a baseline
+    SnapshotHistory sentSnapshots;
+    sf::Uint32 nextSnapshotSequence = 1;
+    sf::Uint32 ackedSnapshot = 0;
+    
+    // Unreliable movement channel, bound to an endpoint by the first datagram
+    // that quotes the token handed out in CONNECT
+    sf::Uint32 udpToken = 0;
+    bool udpBound = false;
+    sf::IpAddress udpAddress;
+    unsigned short udpPort = 0;
+    DatagramChannel datagrams;
+    sf::Uint32 lastMoveNumber = 0;
+    
+    // Entities whose latest position the client hasn't acknowledged, with the
+    // sequence of the last datagram that carried it (0 = not sent yet)
+    std::unordered_map<sf::Uint32, sf::Uint16> unackedPositions;
+    
+    // Zone sharding: a player that walks into another shard's zone is offered
+    // to that shard, then redirected once it accepts; moves are ignored meanwhile
+    sf::Uint32 handoffToken = 0;        // Nonzero while a handoff is in flight
+    unsigned int handoffTarget = 0;
+    bool redirected = false;            // Target accepted and REDIRECT was queued
+    unsigned int handoffTicks = 0;      // Ticks since the handoff started
+    unsigned int handoffCooldown = 0;   // Ticks before a failed handoff may be retried
+};
+
+/**
+ * @brief Table of live client sessions owned by the tick thread
+ *
+ * The accept thread never touches the table directly: it hands new sessions
+ * over through a lock-free queue, and the tick thread absorbs them at tick
+ * boundaries. Sessions are kept in a dense array so per-tick iteration is a
+ * linear scan, and disconnected sessions are removed by reap().
+ */
+class ClientRegistry {
+public:
+    using ClientList = std::vector<std::unique_ptr<ClientInfo>>;
+
+    /**
+     * @brief Queue a newly accepted session (safe from any thread)
+     */
+    void enqueue(std::unique_ptr<ClientInfo> client);
+
+    /**
+     * @brief Move queued sessions into the table (tick thread only)
+     * @param onAdded Called with each session after it has been inserted
+     * @return Number of sessions absorbed
+     */
+    template <typename Callback>
+    size_t absorbPending(Callback&& onAdded) {
+        return pending.drain([this, &onAdded](std::unique_ptr<ClientInfo> client) {
+            ClientInfo& added = insert(std::move(client));
+            onAdded(added);
+        });
+    }
+
+    /**
+     * @brief Remove every session whose connected flag is cleared (tick thread only)
+     * @param onRemoved Called with each session just before it is destroyed
+     * @return Number of sessions removed
+     */
+    template <typename Callback>
+    size_t reap(Callback&& onRemoved) {
+        size_t removed = 0;
+        for (size_t i = 0; i < clients.size();) {
+            if (clients[i]->connected) {
+                i++;
+                continue;
+            }
+            onRemoved(*clients[i]);
+            eraseAt(i);
+            removed++;
+        }
+        return removed;
+    }
+
+    /**
+     * @brief Look up a session by client id
+     */
+    ClientInfo* find(sf::Uint32 clientId);
+
+    /**
+     * @brief Drop every session, queued or live
+     */
+    void clear();
+
+    ClientList::iterator begin() { return clients.begin(); }
+    ClientList::iterator end() { return clients.end(); }
+    size_t size() const { return clients.size(); }
+
+private:
+    ClientInfo& insert(std::unique_ptr<ClientInfo> client);
+    void eraseAt(size_t index);
+
+    LockFreeQueue<std::unique_ptr<ClientInfo>> pending;
+    ClientList clients;
+    std::unordered_map<sf::Uint32, size_t> indexById;
+};
+
+} // namespace IsometricMUD
@@ -3,20 +3,63 @@
 #include <SFML/Network.hpp>
 #include "Vector3D.hpp"
 #include "NetworkProtocol.hpp"
-#include <map>
+#include "ScriptEngine.hpp"
+#include "SocketPoller.hpp"
+#include "ClientRegistry.hpp"
+#include "TickScheduler.hpp"
+#include "InterestManager.hpp"
+#include "MetricsRegistry.hpp"
+#include "MetricsServer.hpp"
+#include "ServerMetrics.hpp"
+#include "WorldJournal.hpp"
+#include "Movement.hpp"
+#include "VoxelGrid.hpp"
+#include "PathfindingService.hpp"
+#include "ShardMap.hpp"
+#include "ShardLink.hpp"
+#include "ChatService.hpp"
+#include "PacketCapture.hpp"
+#include "TickArena.hpp"
+#include <atomic>
+#include <random>
 #include <memory>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace IsometricMUD {
 
 /**
- * @brief Represents a connected client
+ * @brief Tunable server settings
  */
-struct ClientInfo {
-    sf::Uint32 id;
-    std::unique_ptr<sf::TcpSocket> socket;
-    Vector3D position;
-    std::string name;
+struct ServerConfig {
+    unsigned int tickRate = 60;         // Simulation ticks per second
+    unsigned int statsInterval = 30;    // Seconds between tick reports (0 disables)
+    float interestRadius = 24.0f;       // Clients only hear about entities this close
+    float interestCellSize = 8.0f;      // Edge length of a spatial hash cell
+    bool snapshotMode = false;          // Send delta snapshots instead of per-entity messages
+    bool udpEnabled = true;             // Carry movement over UDP on the same port number
+    float simulatedLoss = 0.0f;         // Fraction of outgoing datagrams to drop (testing)
+    unsigned int simulatedLatency = 0;  // Milliseconds to delay outgoing datagrams (testing)
+    unsigned int simulatedJitter = 0;   // Extra random delay in milliseconds (testing)
+    unsigned short adminPort = 0;       // Loopback port serving /metrics (0 disables)
+    size_t sendHighWatermark = 256 * 1024;  // Unsent bytes above which position updates are dropped
+    size_t sendLowWatermark = 64 * 1024;    // Unsent bytes below which position updates resume
+    size_t sendBufferLimit = 1024 * 1024;   // Unsent bytes at which a client is evicted outright
+    unsigned int slowClientTimeout = 10;    // Seconds above the high watermark before eviction (0 = never)
+    std::string dataDirectory;              // Where player state is saved (empty = not saved)
+    std::string levelFile;                  // Level whose terrain moves are checked against (empty = none)
+    unsigned int npcCount = 0;              // Wandering NPCs to spawn on the level
+    unsigned int pathThreads = 2;           // Pathfinding worker threads (only with a level)
+    std::string shardMapFile;               // Zones of the servers sharing the world (empty = one server)
+    unsigned int shardIndex = 0;            // This server's line in the shard map
+    float chatRate = 1.0f;                  // Sustained chat messages per second per client
+    float chatBurst = 5.0f;                 // Chat messages a quiet client may send back to back
+    float chatRadius = 12.0f;               // Reach of PROXIMITY chat (at most interestRadius)
+    sf::Uint32 randomSeed = 0;              // Seed for tokens and NPC wandering (0 = pick one at startup)
+    std::string captureFile;                // Record every inbound packet here (empty = no capture)
 };
 
 /**
@@ -24,7 +67,7 @@ struct ClientInfo {
  */
 class GameServer {
 public:
-    GameServer();
+    explicit GameServer(const ServerConfig& config = ServerConfig());
     ~GameServer();
 
     /**
@@ -42,16 +85,199 @@ public:
      */
     void run();
 
+    /**
+     * @brief Run a capture through the simulation without sockets, then report tick times
+     *
+     * Each recorded tick's connects, packets and disconnects are fed in before
+     * that tick runs; ticks with nothing recorded run empty. Replies are encoded
+     * as usual and then discarded.
+     *
+     * @param realTime Keep to the tick rate instead of running ticks back to back
+     */
+    bool replay(const std::string& captureFile, bool realTime);
+
+    /**
+     * @brief Run ticks back to back for socketless clients that walk like LoadGen bots
+     *
+     * Every client connects before the first tick and spawns on the level;
+     * each tick, each one moves with probability movesPerSecond / tick rate.
+     * Replies are encoded as usual and then discarded, as in a replay. Only
+     * ticks after warmupTicks are recorded, in microseconds.
+     */
+    void runSyntheticLoad(const std::vector<TileData>& level, unsigned int clientCount, float movesPerSecond,
+                          unsigned int warmupTicks, unsigned int measuredTicks, Histogram& tickTimes);
+
+    /**
+     * @brief Load a script whose events clients may trigger with SCRIPT_EVENT
+     *
+     * Only names the script declares with Event are dispatched, a few per
+     * second per client; anything else is dropped and counted.
+     */
+    bool loadScript(const std::string& filename);
+
 private:
+    /**
+     * @brief A received packet waiting for the simulation phase
+     */
+    struct InboundPacket {
+        sf::Uint32 clientId;
+        std::string_view bytes;     // Copied into the tick arena
+    };
+
+    /**
+     * @brief A decoded move waiting for this tick's validation pass
+     */
+    struct PendingMove {
+        sf::Uint32 clientId;
+        Direction direction;
+    };
+
+    /**
+     * @brief A non-player entity that walks between random spots on the level
+     */
+    struct Npc {
+        sf::Uint32 id;
+        EntityHandle entity;
+        std::vector<Direction> path;
+        size_t nextStep = 0;
+        bool waitingForPath = false;
+        unsigned int restTicks = 0;     // Ticks to stand still before the next walk
+    };
+
+    /**
+     * @brief A player another shard is sending here, waiting for its client's RESUME
+     */
+    struct IncomingHandoff {
+        Vector3D position;
+        std::string name;
+        unsigned int ticks = 0;
+    };
+
     void acceptClients();
     void handleClient(sf::Uint32 clientId);
+    void handleDatagrams();
+    void handlePacket(ClientInfo& client, std::string_view bytes);
+    void queueInbound(sf::Uint32 clientId, const void* data, size_t size);
+    void handleLogin(ClientInfo& client, const std::string& playerName);
+    void handleChat(ClientInfo& client, ChatChannel channel, sf::Uint32 peer, std::string_view text);
+    size_t deliverChat(ChatChannel channel, sf::Uint32 topic, const WireBufferPtr& message);
+    size_t deliverProximityChat(ClientInfo& sender, const WireBufferPtr& message);
+    void disconnectClient(ClientInfo& client);
+    void updateClientTable();
+    void runTick();
+    bool loadWorld();
+    void seedRandom(sf::Uint32 seed);
+    void feedCapturedTick(const CapturedTick& tick);
+    void writeReplaySummary(std::ostream& out, const std::string& captureFile, bool realTime,
+                            sf::Time elapsed) const;
+    void processInbound();
+    void applyMoves();
+    void spawnNpcs();
+    void updateNpcs();
+    bool pickWalkableCell(Vector3D& cell);
+    bool isSharded() const { return shardMap.size() > 0; }
+    bool ownsPosition(const Vector3D& position) const;
+    void receiveShardMessages();
+    void handleShardMessage(unsigned int peer, sf::Packet& packet);
+    void dropGhosts(unsigned int peer);
+    void updateShards();
+    void updateHandoffs();
+    void beginHandoff(ClientInfo& client, unsigned int target);
+    void cancelHandoff(ClientInfo& client, const char* reason);
+    void handleResume(ClientInfo& client, sf::Uint32 token);
+    void sendGhosts(unsigned int peer);
+    void noteGhost(unsigned int peer, sf::Uint32 entityId, const Vector3D& position);
+    void updateInterest();
+    void sendSnapshot(ClientInfo& client);
+    void handleScriptEvent(ClientInfo& client, std::string_view eventName);
+    void dispatchScriptEvents();
+    void flushOutbound();
+    void sendPositionDatagrams(ClientInfo& client);
+    void recordOutbox(const OutboundQueue& outbox);
+    void updateBackpressure(ClientInfo& client);
+    void queueVisiblePositions(ClientInfo& client);
+    WireBufferPtr encodeSpawn(sf::Uint32 entityId);
+    WireBufferPtr encodeRemove(sf::Uint32 entityId);
+    WireBufferPtr encodePosition(sf::Uint32 entityId);
+    void sendPacket(sf::Uint32 clientId, const sf::Packet& packet);
     void broadcastPacket(const sf::Packet& packet, sf::Uint32 excludeClient = 0);
-    
-    bool running;
+
+    ServerConfig config;
+    std::atomic<bool> running;
     sf::TcpListener listener;
-    std::map<sf::Uint32, std::unique_ptr<ClientInfo>> clients;
+
+    // Scratch memory for everything that lives no longer than one tick:
+    // received packets, per-tick encode caches, outbox indexes and script
+    // temporaries. Reset when the tick ends; declared before anything that
+    // allocates from it so it is destroyed last.
+    TickArena tickArena;
+    std::uint64_t lastAllocationCount;
+    ClientRegistry clients;
     sf::Uint32 nextClientId;
     std::thread acceptThread;
+    SocketPoller poller;
+    std::vector<sf::Uint32> readyClients;
+    sf::Packet receivedPacket;              // Reused so receiving doesn't allocate a packet each time
+
+    // Client ids start at 1, so the UDP socket is reported by the poller as 0
+    static const sf::Uint32 DatagramSocketId = 0;
+    DatagramSocket udpSocket;
+    unsigned short udpPort;
+    sf::Uint32 randomSeed;
+    std::mt19937 tokenGenerator;
+    std::vector<sf::Uint16> newlyAcked;
+    std::vector<sf::Uint32> datagramPositions;
+
+    TickScheduler scheduler;
+    sf::Clock statsClock;
+    
+    // Recorded on the tick thread, scraped from the admin thread
+    MetricsRegistry metricsRegistry;
+    ServerMetrics metrics;
+    MetricsServer metricsServer;
+    ScriptEngine scriptEngine;
+    InterestManager interest;
+    InterestManager::ViewChanges viewChanges;
+    ChatService chat;
+    WorldJournal journal;
+    CaptureWriter capture;
+    EntityStore entities;
+    VoxelGrid terrain;
+    PathfindingService pathfinder;
+    
+    // NPC ids start far above anything nextClientId will reach; each shard
+    // numbers its clients and NPCs from its own 2^24-wide block of both ranges
+    static const sf::Uint32 FirstNpcId = 0x80000000;
+    static const unsigned int ShardIdBits = 24;
+    std::vector<Npc> npcs;
+    std::mt19937 npcRandom;
+    unsigned int npcStepCountdown;
+
+    // Zone sharding: ghosts are entities near a border, mirrored by the
+    // neighbouring shard so its players see across the border
+    ShardMap shardMap;
+    ShardLink shardLink;
+    std::vector<bool> peerUp;
+    std::vector<std::unordered_set<sf::Uint32>> ghostedTo;     // Our entities each peer shows
+    std::vector<std::unordered_set<sf::Uint32>> ghostsFrom;    // Each peer's entities we show
+    std::vector<std::vector<sf::Uint32>> ghostRemovals;        // Ghosted entities destroyed since the last send
+    std::vector<std::pair<sf::Uint32, Vector3D>> ghostUpdates;
+    std::vector<char> shardBuffer;
+    std::unordered_map<sf::Uint32, IncomingHandoff> incomingHandoffs;
+
+    std::vector<InboundPacket> inbound;
+    std::vector<PendingMove> pendingMoves;
+    std::vector<std::string_view> pendingScriptEvents;    // Into packets in the tick arena
+    
+    // Messages about an entity are identical for every observer, so each is
+    // encoded at most once per tick and shared between send queues
+    std::pmr::unordered_map<sf::Uint32, WireBufferPtr> spawnCache;
+    std::pmr::unordered_map<sf::Uint32, WireBufferPtr> removeCache;
+    std::pmr::unordered_map<sf::Uint32, WireBufferPtr> positionCache;
+    
+    // Reused while building each client's snapshot
+    Snapshot currentSnapshot;
+    std::vector<char> snapshotBuffer;
 };
 
 } // namespace IsometricMUD
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <SFML/Config.hpp>
+#include "Vector3D.hpp"
+#include <unordered_map>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Spatial hash of entity positions in cubic 3D cells
+ */
+class SpatialGrid {
+public:
+    explicit SpatialGrid(float cellSize);
+
+    void insert(sf::Uint32 entityId, const Vector3D& position);
+    void move(sf::Uint32 entityId, const Vector3D& position);
+    void remove(sf::Uint32 entityId);
+
+    /**
+     * @brief Collect every entity within radius of center
+     * @param out Receives entity ids (unsorted); not cleared first
+     */
+    void queryRadius(const Vector3D& center, float radius, std::vector<sf::Uint32>& out) const;
+
+    float getCellSize() const { return cellSize; }
+
+private:
+    struct Entry {
+        sf::Uint64 cell;
+        Vector3D position;
+    };
+
+    sf::Uint64 cellKey(int cx, int cy, int cz) const;
+    sf::Uint64 cellOf(const Vector3D& position) const;
+    int toCell(float coordinate) const;
+    void unlink(sf::Uint64 cell, sf::Uint32 entityId);
+
+    float cellSize;
+    std::unordered_map<sf::Uint64, std::vector<sf::Uint32>> cells;
+    std::unordered_map<sf::Uint32, Entry> entries;
+};
+
+/**
+ * @brief Area-of-interest tracking for position broadcasts
+ *
+ * Every entity lives in a SpatialGrid; every observer (a connected client)
+ * remembers which entities it can currently see. Once per tick update()
+ * recomputes an observer's view and reports which entities entered it, which
+ * left it, and which visible entities moved since the last tick. Entities
+ * leave the view only past radius * LeaveHysteresis so players standing on
+ * the boundary don't flicker in and out.
+ */
+class InterestManager {
+public:
+    static constexpr float LeaveHysteresis = 1.1f;
+
+    /**
+     * @brief Result of recomputing one observer's view
+     */
+    struct ViewChanges {
+        std::vector<sf::Uint32> entered;
+        std::vector<sf::Uint32> left;
+        std::vector<sf::Uint32> moved;
+
+        void clear() {
+            entered.clear();
+            left.clear();
+            moved.clear();
+        }
+    };
+
+    InterestManager(float radius, float cellSize);
+
+    void addEntity(sf::Uint32 entityId, const Vector3D& position);
+    void moveEntity(sf::Uint32 entityId, const Vector3D& position);
+    void removeEntity(sf::Uint32 entityId);
+
+    /**
+     * @brief Stop tracking an observer's view
+     */
+    void removeObserver(sf::Uint32 observerId);
+
+    /**
+     * @brief Start a new tick; moves recorded after this count as fresh
+     */
+    void beginTick();
+
+    /**
+     * @brief Recompute what an observer sees from its position
+     *
+     * The observer never appears in its own view; whether it moved this tick
+     * can be checked with hasMoved().
+     */
+    void update(sf::Uint32 observerId, const Vector3D& observerPosition, ViewChanges& changes);
+
+    /**
+     * @brief Check whether an entity moved during the current tick
+     */
+    bool hasMoved(sf::Uint32 entityId) const;
+
+    /**
+     * @brief Last known position of an entity
+     */
+    const Vector3D* getPosition(sf::Uint32 entityId) const;
+
+    /**
+     * @brief Entities an observer currently sees, sorted by id
+     */
+    const std::vector<sf::Uint32>& getVisible(sf::Uint32 observerId) const;
+
+    float getRadius() const { return radius; }
+
+private:
+    struct EntityState {
+        Vector3D position;
+        sf::Uint64 movedTick;
+    };
+
+    float radius;
+    SpatialGrid grid;
+    sf::Uint64 currentTick;
+    std::unordered_map<sf::Uint32, EntityState> entities;
+    std::unordered_map<sf::Uint32, std::vector<sf::Uint32>> visibleSets;
+    std::vector<sf::Uint32> scratch;
+    std::vector<sf::Uint32> visibleScratch; // Swapped with an observer's set, so neither buffer is freed
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Unbounded multi-producer, single-consumer lock-free queue
+ *
+ * Producers push onto an atomic intrusive stack. The single consumer takes
+ * the whole stack with one exchange and replays it in FIFO order, so a
+ * drain costs one atomic operation no matter how many items are waiting.
+ */
+template <typename T>
+class LockFreeQueue {
+public:
+    LockFreeQueue() : head(nullptr) {}
+
+    ~LockFreeQueue() {
+        Node* node = head.exchange(nullptr, std::memory_order_acquire);
+        while (node) {
+            Node* next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    /**
+     * @brief Push an item (safe from any thread)
+     */
+    void push(T value) {
+        Node* node = new Node{std::move(value), head.load(std::memory_order_relaxed)};
+        while (!head.compare_exchange_weak(node->next, node,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Take every queued item in push order (consumer thread only)
+     * @return Number of items handed to the callback
+     */
+    template <typename Callback>
+    size_t drain(Callback&& callback) {
+        Node* node = head.exchange(nullptr, std::memory_order_acquire);
+        if (!node) {
+            return 0;
+        }
+
+        // The stack is newest-first; reverse it to preserve arrival order
+        Node* ordered = nullptr;
+        while (node) {
+            Node* next = node->next;
+            node->next = ordered;
+            ordered = node;
+            node = next;
+        }
+
+        size_t count = 0;
+        while (ordered) {
+            Node* next = ordered->next;
+            callback(std::move(ordered->value));
+            delete ordered;
+            ordered = next;
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Check whether anything is waiting (a hint; may race with producers)
+     */
+    bool empty() const {
+        return head.load(std::memory_order_relaxed) == nullptr;
+    }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> head;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Histogram.hpp"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Monotonically increasing count (relaxed atomic)
+ */
+class Counter {
+public:
+    void add(std::uint64_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+    std::uint64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::uint64_t> value{0};
+};
+
+/**
+ * @brief Value that can go up and down (relaxed atomic)
+ */
+class Gauge {
+public:
+    void set(std::int64_t amount) { value.store(amount, std::memory_order_relaxed); }
+    void add(std::int64_t amount) { value.fetch_add(amount, std::memory_order_relaxed); }
+    std::int64_t get() const { return value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<std::int64_t> value{0};
+};
+
+/**
+ * @brief Named metrics rendered in the Prometheus text exposition format
+ *
+ * Metrics are registered once at startup and then updated through the
+ * returned references, which only touch relaxed atomics. The mutex guards
+ * the registry's structure against a concurrent render; recording a value
+ * never takes it, so the tick thread is never blocked by a scrape.
+ */
+class MetricsRegistry {
+public:
+    /**
+     * @brief Register a counter
+     * @param labels Prometheus label pairs without braces, e.g. type="move"
+     */
+    Counter& addCounter(const std::string& name, const std::string& help,
+                        const std::string& labels = "");
+
+    Gauge& addGauge(const std::string& name, const std::string& help,
+                    const std::string& labels = "");
+
+    /**
+     * @brief Expose a histogram owned elsewhere
+     * @param unitScale Multiplier from recorded units to exported units
+     *                  (1e-6 exports microsecond samples as seconds)
+     */
+    void addHistogram(const std::string& name, const std::string& help, const std::string& labels,
+                      const Histogram& histogram, double unitScale);
+
+    /**
+     * @brief Render every metric (safe from any thread)
+     */
+    void writePrometheus(std::ostream& out) const;
+
+private:
+    enum class MetricType {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM
+    };
+
+    struct Series {
+        std::string labels;
+        const Counter* counter = nullptr;
+        const Gauge* gauge = nullptr;
+        const Histogram* histogram = nullptr;
+        double unitScale = 1.0;
+    };
+
+    struct Family {
+        std::string name;
+        std::string help;
+        MetricType type;
+        std::vector<Series> series;
+    };
+
+    static const char* getTypeName(MetricType type);
+    Family& getFamily(const std::string& name, const std::string& help, MetricType type);
+    static void writeHistogram(std::ostream& out, const std::string& name, const Series& series);
+
+    mutable std::mutex mutex;
+    std::vector<Family> families;
+    std::deque<Counter> counters;   // Deques keep handed-out references stable
+    std::deque<Gauge> gauges;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include "MetricsRegistry.hpp"
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Serves a metrics registry over HTTP on a loopback admin port
+ *
+ * A background thread answers GET /metrics with the Prometheus text format,
+ * one connection at a time. It only reads the registry, so a slow or stuck
+ * scraper can delay other scrapes but never the tick thread.
+ */
+class MetricsServer {
+public:
+    explicit MetricsServer(const MetricsRegistry& registry);
+    ~MetricsServer();
+
+    /**
+     * @brief Listen on 127.0.0.1 and start the serving thread
+     */
+    bool start(unsigned short port);
+
+    void stop();
+
+private:
+    void serve();
+    void handleConnection(sf::TcpSocket& socket);
+    bool readRequest(sf::TcpSocket& socket, std::string& request);
+
+    const MetricsRegistry& registry;
+    sf::TcpListener listener;
+    std::atomic<bool> running;
+    std::thread thread;
+};
+
+} // namespace IsometricMUD
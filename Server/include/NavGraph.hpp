@@ -0,0 +1,175 @@
+#pragma once
+
+#include <SFML/System.hpp>
+#include "VoxelGrid.hpp"
+#include "Movement.hpp"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Hierarchical (HPA*) navigation graph over a VoxelGrid
+ *
+ * The grid's 16x16x16 chunks are the clusters. Wherever walkable cells face
+ * each other across a chunk boundary, each connected patch of that face
+ * becomes an entrance: a pair of portal nodes, one on either side, one step
+ * apart. Portals in the same chunk are linked by their in-chunk walking
+ * distance, and each link keeps the moves that walk it. A query connects its
+ * start and goal to the portals of their own chunks with a breadth-first
+ * search confined to the chunk, runs A* over this small graph, and expands
+ * the result from the stored moves.
+ *
+ * Searches only read the graph, so any number may run at once as long as
+ * nothing rebuilds it meanwhile; the caller provides that exclusion and a
+ * SearchScratch per thread.
+ */
+class NavGraph {
+public:
+    /**
+     * @brief Per-thread buffers reused between searches
+     */
+    class SearchScratch {
+    public:
+        SearchScratch();
+
+    private:
+        friend class NavGraph;
+
+        // Cheapest estimate first; among equals the one furthest along, which
+        // keeps A* from widening across the many ties of a grid
+        struct OpenEntry {
+            int estimate;
+            int cost;
+            sf::Uint32 node;
+            bool operator<(const OpenEntry& other) const {
+                return estimate != other.estimate ? estimate > other.estimate : cost < other.cost;
+            }
+        };
+
+        struct Link {
+            sf::Uint32 node;
+            int cost;
+        };
+
+        // Abstract search, indexed by node id (one past the end is the goal)
+        std::vector<sf::Uint32> visitStamp;
+        std::vector<int> cost;
+        std::vector<sf::Uint32> cameFrom;
+        sf::Uint32 searchStamp;
+        std::vector<OpenEntry> open;
+        std::vector<Link> startLinks;
+        std::vector<Link> goalLinks;
+
+        // In-chunk breadth-first search, indexed by cell within the chunk
+        std::array<sf::Uint32, VoxelGrid::ChunkVolume> cellStamp;
+        std::array<sf::Uint8, VoxelGrid::ChunkVolume> cellFrom;
+        std::array<sf::Uint16, VoxelGrid::ChunkVolume> cellDistance;
+        std::array<sf::Uint16, VoxelGrid::ChunkVolume> queue;
+        sf::Uint32 floodStamp;
+        std::vector<sf::Uint8> segment;     // Indices of moves, in travel order
+    };
+
+    explicit NavGraph(const VoxelGrid& grid);
+
+    /**
+     * @brief Rebuild every entrance and link from the grid
+     */
+    void build();
+
+    /**
+     * @brief Rebuild the parts of the graph a change to the cell can affect
+     *
+     * The cell's chunk (and the one below, whose headroom it may be) gets new
+     * portals, its six neighbours get new links, and all of their versions
+     * change.
+     */
+    void updateCell(int x, int y, int z);
+
+    /**
+     * @brief Portal sequence between two cells, start and goal excluded
+     * @return False if the goal can't be reached
+     */
+    bool findAbstractPath(int startX, int startY, int startZ, int goalX, int goalY, int goalZ,
+                          SearchScratch& scratch, std::vector<sf::Uint32>& path) const;
+
+    /**
+     * @brief Turn a portal sequence into single steps
+     * @return False if some hop no longer connects (a path cached for another start)
+     */
+    bool refinePath(int startX, int startY, int startZ, const std::vector<sf::Uint32>& path,
+                    int goalX, int goalY, int goalZ, SearchScratch& scratch,
+                    std::vector<Direction>& steps) const;
+
+    /**
+     * @brief Index of the chunk holding a cell, or NoChunk outside the grid
+     */
+    sf::Uint32 getChunkOf(int x, int y, int z) const;
+
+    sf::Uint32 getNodeChunk(sf::Uint32 node) const { return nodes[node].chunk; }
+
+    /**
+     * @brief Counter bumped whenever a chunk's portals or links are rebuilt
+     */
+    sf::Uint32 getChunkVersion(sf::Uint32 chunk) const { return chunkVersions[chunk]; }
+
+    size_t getNodeCount() const { return nodes.size() - freeNodes.size(); }
+
+    static const sf::Uint32 NoChunk = 0xFFFFFFFF;
+
+private:
+    struct Edge {
+        sf::Uint32 target;
+        int cost;
+        sf::Uint32 stepOffset;      // Where an in-chunk link's moves start in stepPool
+    };
+
+    struct Node {
+        int x;
+        int y;
+        int z;
+        sf::Uint32 chunk;
+        sf::Uint32 partner;         // The portal across the chunk boundary
+        bool alive;
+        std::vector<Edge> edges;
+        std::vector<sf::Uint8> stepPool;    // Moves of every in-chunk link, cost entries each
+    };
+
+    struct ChunkCoord {
+        int x;
+        int y;
+        int z;
+    };
+
+    ChunkCoord getChunkCoord(sf::Uint32 chunk) const;
+    sf::Uint32 getChunkIndex(int chunkX, int chunkY, int chunkZ) const;
+    sf::Uint32 createNode(int x, int y, int z, sf::Uint32 chunk);
+    void removeChunkPortals(sf::Uint32 chunk);
+    void rebuildChunk(sf::Uint32 chunk);
+    void buildEntrances(sf::Uint32 chunk, int axis);
+    void buildLinks(sf::Uint32 chunk);
+
+    /**
+     * @brief Breadth-first search from a cell, confined to its chunk
+     *
+     * Stops early once the target cell is reached when one is given.
+     */
+    void flood(sf::Uint32 chunk, int x, int y, int z, SearchScratch& scratch, int targetCell = -1) const;
+    int getLocalCell(sf::Uint32 chunk, int x, int y, int z) const;
+    void traceSteps(int startCell, int targetCell, SearchScratch& scratch) const;
+    bool appendSegment(sf::Uint32 chunk, int fromX, int fromY, int fromZ, int toX, int toY, int toZ,
+                       SearchScratch& scratch, std::vector<Direction>& steps) const;
+
+    const VoxelGrid& grid;
+    int chunksX;
+    int chunksY;
+    int chunksZ;
+    std::vector<Node> nodes;
+    std::vector<sf::Uint32> freeNodes;
+    std::vector<std::vector<sf::Uint32>> chunkNodes;
+    std::vector<sf::Uint32> chunkVersions;
+    SearchScratch buildScratch;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include "WireBuffer.hpp"
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Messages waiting to be sent to one client at the end of the tick
+ *
+ * Position updates are coalesced per entity so only the latest one is sent,
+ * and everything queued during a tick goes out as a single BATCH frame.
+ * Ordered messages (spawns, removes, chat) are written before coalesced
+ * positions; queuing a spawn or remove drops any pending position for that
+ * entity so a stale update can never resurrect a removed entity.
+ *
+ * Messages are held as shared WireBuffers, so queuing the same broadcast to
+ * every client costs a reference count, not a copy. The per-entity index is
+ * rebuilt every tick, so it lives on the resource given at construction
+ * (the server's tick arena) and clear() hands its storage back.
+ */
+class OutboundQueue {
+public:
+    explicit OutboundQueue(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    /**
+     * @brief Bytes writeTo() adds in front of a batch: length and BATCH type
+     */
+    static constexpr size_t BatchHeaderSize = 5;
+
+    void queueMessage(WireBufferPtr message);
+    void queueSpawn(sf::Uint32 entityId, WireBufferPtr message);
+    void queueRemove(sf::Uint32 entityId, WireBufferPtr message);
+    void queuePosition(sf::Uint32 entityId, WireBufferPtr message);
+
+    bool empty() const { return messages.empty() && positions.empty(); }
+
+    /**
+     * @brief Number of messages that would be written by writeTo()
+     */
+    size_t getMessageCount() const { return messages.size() + positions.size(); }
+
+    /**
+     * @brief Number of queued positions replaced or dropped since the last clear()
+     */
+    size_t getCoalescedCount() const { return coalescedCount; }
+
+    /**
+     * @brief Visit every message writeTo() would write, in order
+     */
+    template <typename Visitor>
+    void forEachMessage(Visitor&& visit) const {
+        for (const auto& message : messages) {
+            visit(*message);
+        }
+        for (const auto& update : positions) {
+            visit(*update.message);
+        }
+    }
+
+    /**
+     * @brief Append everything queued to a send queue as one frame
+     *
+     * A lone message is written as its own frame; anything more is prefixed
+     * with a BATCH header and the shared buffers follow it by reference.
+     */
+    void writeTo(SendQueue& sendQueue) const;
+
+    void clear();
+
+private:
+    struct PositionUpdate {
+        sf::Uint32 entityId;
+        WireBufferPtr message;
+    };
+
+    void dropPosition(sf::Uint32 entityId);
+
+    std::vector<WireBufferPtr> messages;
+    std::vector<PositionUpdate> positions;
+    std::pmr::unordered_map<sf::Uint32, size_t> positionIndex;
+    size_t coalescedCount = 0;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include "LockFreeQueue.hpp"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Kinds of event a capture holds for each tick
+ */
+enum class CaptureEvent : sf::Uint8 {
+    CONNECT = 1,        // A session was added to the client table
+    DISCONNECT = 2,     // A session was reaped from the client table
+    PACKET = 3          // A packet reached the simulation, in processing order
+};
+
+/**
+ * @brief Records everything clients sent to the simulation, tick by tick
+ *
+ * A capture starts with a header ("IMPC", version, tick rate, random seed)
+ * followed by one record per tick that had any events:
+ * [u32 payload length][varuint tick][varuint event count] and then each
+ * event as [kind][varuint client id], with [varuint size][bytes] after a
+ * PACKET. Ticks with nothing in them are left out.
+ *
+ * Like the WorldJournal, the tick thread only appends to memory; a writer
+ * thread puts finished ticks on disk.
+ */
+class CaptureWriter {
+public:
+    CaptureWriter();
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /**
+     * @brief Create the capture file and start the writer thread
+     * @param seed Random seed the server runs with, so a replay can use it too
+     */
+    bool open(const std::string& path, unsigned int tickRate, sf::Uint32 seed);
+
+    /**
+     * @brief Write out every committed tick and stop the writer
+     */
+    void close();
+
+    bool isOpen() const { return writer.joinable(); }
+
+    // Tick thread only
+    void recordConnect(sf::Uint32 clientId);
+    void recordDisconnect(sf::Uint32 clientId);
+    void recordPacket(sf::Uint32 clientId, std::string_view bytes);
+
+    /**
+     * @brief Hand the events recorded since the last commit to the writer (tick thread only)
+     */
+    void commitTick(sf::Uint64 tick);
+
+private:
+    void appendEvent(CaptureEvent kind, sf::Uint32 clientId, const void* data, size_t size);
+    void runWriter();
+
+    // Tick thread
+    std::vector<char> events;
+    sf::Uint32 eventCount;
+
+    LockFreeQueue<std::vector<char>> records;
+
+    // Writer thread
+    std::thread writer;
+    std::atomic<bool> running;
+    std::FILE* file;
+    std::string path;
+};
+
+/**
+ * @brief One tick read back from a capture
+ */
+struct CapturedTick {
+    struct Event {
+        CaptureEvent kind;
+        sf::Uint32 clientId;
+        std::string_view bytes;     // PACKET only; valid until the next readTick()
+    };
+
+    sf::Uint64 tick = 0;
+    std::vector<Event> events;
+};
+
+/**
+ * @brief Reads a capture made by CaptureWriter one tick at a time
+ */
+class CaptureReader {
+public:
+    bool open(const std::string& path);
+
+    unsigned int getTickRate() const { return tickRate; }
+    sf::Uint32 getSeed() const { return seed; }
+
+    /**
+     * @brief Read the next recorded tick
+     * @return False at the end of the capture or at a damaged record
+     */
+    bool readTick(CapturedTick& tick);
+
+    /**
+     * @brief Check whether reading stopped at a damaged or truncated record
+     */
+    bool isDamaged() const { return damaged; }
+
+private:
+    std::ifstream file;
+    std::vector<char> record;
+    unsigned int tickRate = 0;
+    sf::Uint32 seed = 0;
+    bool damaged = false;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <SFML/System.hpp>
+#include "NavGraph.hpp"
+#include "LockFreeQueue.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief A path query handed to the worker pool
+ */
+struct PathRequest {
+    sf::Uint32 requestId;
+    sf::Uint32 ownerId;         // Whatever the caller needs to route the result
+    Vector3D from;
+    Vector3D to;
+};
+
+/**
+ * @brief Answer to a PathRequest: the moves that walk from its start to its goal
+ */
+struct PathResult {
+    sf::Uint32 requestId;
+    sf::Uint32 ownerId;
+    bool found = false;
+    bool cached = false;        // Reused a portal sequence from an earlier query
+    std::vector<Direction> steps;
+};
+
+/**
+ * @brief Asynchronous pathfinding over the level's navigation graph
+ *
+ * The tick thread submits requests during a tick and dispatches them in one
+ * batch; worker threads solve them and push results onto a lock-free queue
+ * that the tick thread collects at the start of the next tick.
+ *
+ * Portal sequences are cached per (start chunk, goal chunk) together with
+ * the versions of the chunks they pass through. A hit is refined from the
+ * new query's exact start and goal, which confirms it still connects; a
+ * version mismatch or a failed refinement falls back to a full search.
+ * Changing a tile rebuilds the graph around it under an exclusive lock and
+ * bumps those chunks' versions, which retires every cached path through them.
+ */
+class PathfindingService {
+public:
+    explicit PathfindingService(VoxelGrid& grid);
+    ~PathfindingService();
+
+    PathfindingService(const PathfindingService&) = delete;
+    PathfindingService& operator=(const PathfindingService&) = delete;
+
+    /**
+     * @brief Build the navigation graph and start the workers
+     */
+    void start(unsigned int threadCount);
+
+    /**
+     * @brief Stop the workers; undispatched and unsolved requests are dropped
+     */
+    void stop();
+
+    bool isRunning() const { return !workers.empty(); }
+
+    /**
+     * @brief Queue a request for the next dispatch (tick thread only)
+     * @return The id its result will carry
+     */
+    sf::Uint32 submit(sf::Uint32 ownerId, const Vector3D& from, const Vector3D& to);
+
+    /**
+     * @brief Hand this tick's requests to the workers (tick thread only)
+     */
+    void dispatch();
+
+    /**
+     * @brief Take every finished result (tick thread only)
+     * @return Number of results handed to the callback
+     */
+    template <typename Callback>
+    size_t collect(Callback&& callback) {
+        return results.drain(std::forward<Callback>(callback));
+    }
+
+    /**
+     * @brief Change a tile and repair the graph around it (tick thread only)
+     *
+     * Waits for searches in progress to finish.
+     * @return False if the cell lies outside the level
+     */
+    bool setSolid(int x, int y, int z, bool solid);
+
+    size_t getNodeCount() const { return graph.getNodeCount(); }
+
+private:
+    struct CachedPath {
+        std::vector<sf::Uint32> nodes;
+        std::vector<std::pair<sf::Uint32, sf::Uint32>> chunkVersions;   // (chunk, version) it relies on
+    };
+
+    void runWorker();
+    void solve(const PathRequest& request, NavGraph::SearchScratch& scratch, PathResult& result);
+    bool isCurrent(const CachedPath& path) const;
+
+    VoxelGrid& grid;
+    NavGraph graph;
+    std::shared_mutex graphMutex;       // Shared while searching, exclusive while editing
+
+    std::vector<std::thread> workers;
+    std::mutex requestMutex;
+    std::condition_variable requestReady;
+    std::deque<PathRequest> requests;
+    bool stopping;
+
+    std::vector<PathRequest> submitted;
+    sf::Uint32 nextRequestId;
+    LockFreeQueue<PathResult> results;
+
+    std::mutex cacheMutex;
+    std::unordered_map<sf::Uint64, CachedPath> cache;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Offline micro-benchmarks of the server's hot data structures
+ *
+ * Each benchmark builds its own synthetic data, opens no sockets and writes
+ * a single JSON line, like --replay, so runs can be diffed or fed to jq.
+ *
+ * - voxel: walkability queries per second on a 1024x1024x16 VoxelGrid
+ * - entities: one pass over 50k positions in the EntityStore, and through a
+ *   std::map of unique_ptr'd ClientInfo-sized objects as players were kept
+ *   before it
+ * - snapshots: bytes per tick to one observer of 1k entities with 10%
+ *   moving, as delta snapshots and as per-move position messages
+ * - broadcast: one message fanned out to N clients' queues, copied per
+ *   client as before WireBuffer and shared as now; bytes copied and heap
+ *   allocations per broadcast (allocations need ISOMUD_COUNT_ALLOCATIONS)
+ * - connections: tick time of a whole GameServer with 10 to 5000 socketless
+ *   clients walking like LoadGen bots, after a warm-up
+ */
+class ServerBenchmarks {
+public:
+    /**
+     * @brief Whether name is a benchmark run() knows
+     */
+    static bool exists(const std::string& name);
+
+    /**
+     * @brief Run one benchmark by name
+     * @return False if the name is unknown or the benchmark could not run
+     */
+    static bool run(const std::string& name, std::ostream& out);
+
+    /**
+     * @brief Names of every benchmark, separated by '|' (for usage text)
+     */
+    static const char* getNames();
+
+private:
+    static bool runVoxel(std::ostream& out);
+    static bool runEntities(std::ostream& out);
+    static bool runSnapshots(std::ostream& out);
+    static bool runBroadcast(std::ostream& out);
+    static bool runConnections(std::ostream& out);
+};
+
+} // namespace IsometricMUD
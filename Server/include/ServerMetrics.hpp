@@ -0,0 +1,225 @@
+#pragma once
+
+#include "MetricsRegistry.hpp"
+#include "TickScheduler.hpp"
+#include "NetworkProtocol.hpp"
+#include <array>
+#include <cstdint>
+
+namespace IsometricMUD {
+
+/**
+ * @brief The game server's metrics, recorded on the tick thread
+ *
+ * Recording only bumps plain per-tick accumulators, which publish() folds
+ * into the registry's relaxed atomics once per tick. Tick-phase timings are
+ * exported straight from the scheduler's histograms, which are already
+ * safe to read from another thread.
+ */
+class ServerMetrics {
+public:
+    ServerMetrics(MetricsRegistry& registry, const TickScheduler& scheduler);
+
+    void recordReceived(PacketType type, size_t bytes) {
+        Traffic& slot = received[getTypeSlot(type)];
+        slot.packets++;
+        slot.bytes += bytes;
+    }
+
+    void recordSent(PacketType type, size_t bytes) {
+        Traffic& slot = sent[getTypeSlot(type)];
+        slot.packets++;
+        slot.bytes += bytes;
+    }
+
+    void recordDatagramReceived(size_t bytes) {
+        datagramsReceived.packets++;
+        datagramsReceived.bytes += bytes;
+    }
+
+    void recordDatagramSent(size_t bytes) {
+        datagramsSent.packets++;
+        datagramsSent.bytes += bytes;
+    }
+
+    /**
+     * @brief Count position updates superseded before they were sent
+     */
+    void recordCoalesced(size_t count) { coalesced += count; }
+
+    /**
+     * @brief Count position updates discarded because a client fell behind
+     */
+    void recordBackpressureDropped(size_t count) { backpressureDropped += count; }
+
+    void recordEviction() { evictions++; }
+    void recordCongested() { congestedClients++; }
+
+    void recordPathRequest() { pathRequests++; }
+
+    void recordPathResult(bool found, bool cached) {
+        if (found) {
+            pathsFound++;
+        } else {
+            pathsUnreachable++;
+        }
+        if (cached) {
+            pathCacheHits++;
+        }
+    }
+
+    void recordHandoff(bool outgoing) {
+        if (outgoing) {
+            handoffsOut++;
+        } else {
+            handoffsIn++;
+        }
+    }
+
+    void recordHandoffFailure() { handoffFailures++; }
+    void setGhostCount(size_t count) { ghostCount = count; }
+
+    /**
+     * @brief Count a chat message and the outboxes it was queued on
+     */
+    void recordChat(size_t deliveries) {
+        chatMessages++;
+        chatDeliveries += deliveries;
+    }
+
+    void recordChatRateLimited() { chatRateLimited++; }
+
+    void recordScriptEvent() { scriptEvents++; }
+    void recordScriptEventRejected() { scriptEventsRejected++; }
+    void recordScriptEventRateLimited() { scriptEventsRateLimited++; }
+
+    void recordConnect() { connects++; }
+    void recordDisconnect() { disconnects++; }
+    void setClientCount(size_t count) { clientCount = count; }
+
+    /**
+     * @brief Sample one client's unsent bytes after this tick's flush
+     */
+    void recordSendQueue(size_t pendingBytes) {
+        sendQueueTotal += pendingBytes;
+        if (pendingBytes > sendQueueMax) {
+            sendQueueMax = pendingBytes;
+        }
+    }
+
+    /**
+     * @brief Record the tick thread's heap allocations since the previous tick
+     */
+    void recordTickAllocations(std::uint64_t count) { tickAllocations.record(count); }
+    const Histogram& getTickAllocations() const { return tickAllocations; }
+
+    void setTickArena(size_t capacity, size_t highWater, std::uint64_t spills) {
+        arenaCapacity = capacity;
+        arenaHighWater = highWater;
+        arenaSpills = spills;
+    }
+
+    void recordTick(bool overran) {
+        ticks++;
+        if (overran) {
+            overruns++;
+        }
+    }
+
+    /**
+     * @brief Fold this tick's accumulators into the registry
+     */
+    void publish();
+
+private:
+    // One slot per packet type up to the newest, plus one for anything unknown
+    static constexpr size_t KnownTypeCount = static_cast<size_t>(PacketType::CHAT_SUBSCRIBE) + 1;
+    static constexpr size_t TypeSlotCount = KnownTypeCount + 1;
+
+    struct Traffic {
+        std::uint64_t packets = 0;
+        std::uint64_t bytes = 0;
+    };
+
+    struct TrafficCounters {
+        Counter* packets = nullptr;
+        Counter* bytes = nullptr;
+    };
+
+    static size_t getTypeSlot(PacketType type) {
+        size_t slot = static_cast<size_t>(type);
+        return slot < KnownTypeCount ? slot : KnownTypeCount;
+    }
+
+    static void publishTraffic(Traffic& traffic, TrafficCounters& counters);
+
+    std::array<Traffic, TypeSlotCount> received;
+    std::array<Traffic, TypeSlotCount> sent;
+    Traffic datagramsReceived;
+    Traffic datagramsSent;
+    std::uint64_t coalesced = 0;
+    std::uint64_t backpressureDropped = 0;
+    std::uint64_t evictions = 0;
+    size_t congestedClients = 0;
+    std::uint64_t pathRequests = 0;
+    std::uint64_t pathsFound = 0;
+    std::uint64_t pathsUnreachable = 0;
+    std::uint64_t pathCacheHits = 0;
+    std::uint64_t handoffsOut = 0;
+    std::uint64_t handoffsIn = 0;
+    std::uint64_t handoffFailures = 0;
+    size_t ghostCount = 0;
+    std::uint64_t chatMessages = 0;
+    std::uint64_t chatRateLimited = 0;
+    std::uint64_t chatDeliveries = 0;
+    std::uint64_t scriptEvents = 0;
+    std::uint64_t scriptEventsRejected = 0;
+    std::uint64_t scriptEventsRateLimited = 0;
+    std::uint64_t connects = 0;
+    std::uint64_t disconnects = 0;
+    size_t clientCount = 0;
+    size_t sendQueueTotal = 0;
+    size_t sendQueueMax = 0;
+    std::uint64_t ticks = 0;
+    std::uint64_t overruns = 0;
+    Histogram tickAllocations;
+    size_t arenaCapacity = 0;
+    size_t arenaHighWater = 0;
+    std::uint64_t arenaSpills = 0;
+    std::uint64_t publishedArenaSpills = 0;
+
+    std::array<TrafficCounters, TypeSlotCount> receivedCounters;
+    std::array<TrafficCounters, TypeSlotCount> sentCounters;
+    TrafficCounters datagramsReceivedCounters;
+    TrafficCounters datagramsSentCounters;
+    Counter* coalescedCounter;
+    Counter* backpressureDroppedCounter;
+    Counter* evictionsCounter;
+    Gauge* congestedGauge;
+    Counter* pathRequestsCounter;
+    Counter* pathsFoundCounter;
+    Counter* pathsUnreachableCounter;
+    Counter* pathCacheHitsCounter;
+    Counter* handoffsOutCounter;
+    Counter* handoffsInCounter;
+    Counter* handoffFailuresCounter;
+    Gauge* ghostsGauge;
+    Counter* chatMessagesCounter;
+    Counter* chatRateLimitedCounter;
+    Counter* chatDeliveriesCounter;
+    Counter* scriptEventsCounter;
+    Counter* scriptEventsRejectedCounter;
+    Counter* scriptEventsRateLimitedCounter;
+    Counter* connectsCounter;
+    Counter* disconnectsCounter;
+    Gauge* clientsGauge;
+    Gauge* sendQueueTotalGauge;
+    Gauge* sendQueueMaxGauge;
+    Counter* ticksCounter;
+    Counter* overrunsCounter;
+    Gauge* arenaCapacityGauge;
+    Gauge* arenaHighWaterGauge;
+    Counter* arenaSpillsCounter;
+};
+
+} // namespace IsometricMUD
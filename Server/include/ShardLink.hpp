@@ -0,0 +1,112 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include "ShardMap.hpp"
+#include "LockFreeQueue.hpp"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Messages zone servers exchange; the type is the first byte
+ */
+enum class ShardPacket : sf::Uint8 {
+    HELLO,              // First message on a link: the sender's shard index
+    GHOSTS,             // Border entities that moved or came near, then ones that left
+    HANDOFF,            // A player crossing into the receiver's zone (token, position, name)
+    HANDOFF_ACCEPT,     // The receiver is holding the player for the token
+    CHAT                // A GLOBAL chat line for the receiver's subscribers (sender, message)
+};
+
+/**
+ * @brief Something that happened on a link, in the order it happened
+ */
+struct ShardEvent {
+    enum class Type {
+        PEER_UP,
+        PEER_DOWN,
+        MESSAGE
+    };
+
+    Type type;
+    unsigned int peer;
+    sf::Packet packet;      // MESSAGE only
+};
+
+/**
+ * @brief Loopback TCP links between the zone servers of one host
+ *
+ * Every pair of shards shares one connection, opened by the lower index and
+ * retried every RetryInterval while the other side is down. A background
+ * thread owns the sockets: the tick thread queues messages with send() and
+ * collects arrivals and link changes with poll(), so a stalled peer never
+ * blocks a tick. Messages queued for a peer whose link is down are dropped;
+ * callers learn about it from the PEER_DOWN event.
+ */
+class ShardLink {
+public:
+    ShardLink();
+    ~ShardLink();
+
+    ShardLink(const ShardLink&) = delete;
+    ShardLink& operator=(const ShardLink&) = delete;
+
+    /**
+     * @brief Listen on this shard's IPC port and start linking to the others
+     */
+    bool start(const ShardMap& map, unsigned int self);
+
+    void stop();
+
+    /**
+     * @brief Queue a message for a peer (tick thread only)
+     */
+    void send(unsigned int peer, sf::Packet packet);
+
+    /**
+     * @brief Take every event since the last poll (tick thread only)
+     * @return Number of events handed to the callback
+     */
+    template <typename Callback>
+    size_t poll(Callback&& callback) {
+        return events.drain(std::forward<Callback>(callback));
+    }
+
+private:
+    struct Outgoing {
+        unsigned int peer;
+        sf::Packet packet;
+    };
+
+    struct Peer {
+        unsigned short ipcPort = 0;
+        std::unique_ptr<sf::TcpSocket> socket;  // Null while the link is down
+        sf::Clock sinceAttempt;
+        bool attempted = false;
+    };
+
+    void run();
+    void connectPeers();
+    void acceptPeer();
+    void identifyPeer(size_t pendingIndex);
+    void receiveFrom(unsigned int peer);
+    void sendQueued();
+    void attachPeer(unsigned int peer, std::unique_ptr<sf::TcpSocket> socket);
+    void dropPeer(unsigned int peer);
+
+    unsigned int self;
+    std::vector<Peer> peers;
+    std::vector<std::unique_ptr<sf::TcpSocket>> unidentified;  // Accepted, HELLO not read yet
+    sf::TcpListener listener;
+    sf::SocketSelector selector;
+    std::atomic<bool> running;
+    std::thread thread;
+
+    LockFreeQueue<Outgoing> outbox;
+    LockFreeQueue<ShardEvent> events;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief The slice of the world one zone server owns, and how to reach it
+ */
+struct ShardInfo {
+    float minX;                 // Owns every x in [minX, maxX)
+    float maxX;
+    unsigned short clientPort;  // Where clients connect (TCP and UDP)
+    unsigned short ipcPort;     // Where the other zone servers connect (loopback TCP)
+};
+
+/**
+ * @brief Split of the world into zones along the x axis, one per server process
+ *
+ * Read from a text file with one line per shard, in shard index order:
+ *
+ *     # minX  maxX  clientPort  ipcPort
+ *     -1e9    64    53000       53100
+ *     64      1e9   53001       53101
+ *
+ * Blank lines and lines starting with '#' are skipped. Zones must not
+ * overlap; a gap between them is allowed but nobody owns it.
+ */
+class ShardMap {
+public:
+    static const unsigned int MaxShards = 128;
+    static const int NoShard = -1;
+
+    bool load(const std::string& filename);
+
+    size_t size() const { return shards.size(); }
+    const ShardInfo& get(unsigned int index) const { return shards[index]; }
+
+    /**
+     * @brief Index of the shard whose zone contains x, or NoShard
+     */
+    int findOwner(float x) const;
+
+    /**
+     * @brief How far x lies outside a shard's zone (0 inside it and on maxX)
+     */
+    float distanceOutside(unsigned int index, float x) const;
+
+private:
+    std::vector<ShardInfo> shards;
+};
+
+} // namespace IsometricMUD
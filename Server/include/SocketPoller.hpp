@@ -0,0 +1,77 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include "DatagramChannel.hpp"
+#include <map>
+#include <vector>
+
+#ifdef ISOMUD_USE_EPOLL
+#include <sys/epoll.h>
+#endif
+
+namespace IsometricMUD {
+
+/**
+ * @brief TCP socket that exposes its native handle for readiness polling
+ */
+class PollableSocket : public sf::TcpSocket {
+public:
+    using sf::TcpSocket::getHandle;
+};
+
+/**
+ * @brief Waits for readiness on many client sockets at once
+ *
+ * Backed by epoll when the server is built with ISOMUD_USE_EPOLL, and by
+ * sf::SocketSelector otherwise. Sockets are identified by their client id so
+ * the caller never has to map native handles back to clients.
+ */
+class SocketPoller {
+public:
+    SocketPoller();
+    ~SocketPoller();
+
+    SocketPoller(const SocketPoller&) = delete;
+    SocketPoller& operator=(const SocketPoller&) = delete;
+
+    /**
+     * @brief Start watching a socket for incoming data
+     */
+    bool add(sf::Uint32 clientId, PollableSocket& socket);
+
+    /**
+     * @brief Watch a UDP socket; it is reported under the given id
+     */
+    bool add(sf::Uint32 id, DatagramSocket& socket);
+
+    /**
+     * @brief Stop watching a socket (must be called before it is closed)
+     */
+    void remove(sf::Uint32 clientId, PollableSocket& socket);
+
+    /**
+     * @brief Block until at least one socket is readable or the timeout expires
+     * @param timeout Maximum time to wait
+     * @param readyClients Receives the ids of every readable socket
+     * @return True if any socket became ready
+     */
+    bool wait(sf::Time timeout, std::vector<sf::Uint32>& readyClients);
+
+    /**
+     * @brief Name of the active backend, for logging
+     */
+    const char* getBackendName() const;
+
+private:
+#ifdef ISOMUD_USE_EPOLL
+    bool addHandle(sf::Uint32 id, sf::SocketHandle handle);
+
+    int epollFd;
+    std::vector<epoll_event> events;
+#else
+    sf::SocketSelector selector;
+    std::map<sf::Uint32, sf::Socket*> sockets;
+#endif
+};
+
+} // namespace IsometricMUD
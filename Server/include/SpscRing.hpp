@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Bounded single-producer, single-consumer lock-free ring
+ *
+ * Slots are allocated once, so pushing never allocates and never blocks:
+ * a full ring simply refuses the item and the producer decides what to do
+ * with it. Head and tail live on separate cache lines so the two threads
+ * don't false-share.
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @param capacity Number of slots; rounded up to a power of two
+     */
+    explicit SpscRing(size_t capacity) : mask(roundUp(capacity) - 1), slots(new T[mask + 1]),
+                                         head(0), tail(0) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Append an item (producer thread only)
+     * @return False if the ring is full; the item is left untouched
+     */
+    bool tryPush(T& value) {
+        size_t currentTail = tail.load(std::memory_order_relaxed);
+        if (currentTail - head.load(std::memory_order_acquire) > mask) {
+            return false;
+        }
+        slots[currentTail & mask] = std::move(value);
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Take every item currently in the ring, oldest first (consumer thread only)
+     * @return Number of items handed to the callback
+     */
+    template <typename Callback>
+    size_t drain(Callback&& callback) {
+        size_t currentHead = head.load(std::memory_order_relaxed);
+        size_t currentTail = tail.load(std::memory_order_acquire);
+        for (size_t i = currentHead; i != currentTail; i++) {
+            callback(std::move(slots[i & mask]));
+        }
+        head.store(currentTail, std::memory_order_release);
+        return currentTail - currentHead;
+    }
+
+    /**
+     * @brief Check whether anything is waiting (a hint; may race with the producer)
+     */
+    bool empty() const {
+        return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_relaxed);
+    }
+
+private:
+    static size_t roundUp(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    const size_t mask;
+    std::unique_ptr<T[]> slots;
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+} // namespace IsometricMUD
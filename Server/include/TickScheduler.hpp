@@ -0,0 +1,109 @@
+#pragma once
+
+#include <SFML/System.hpp>
+#include "Histogram.hpp"
+#include <array>
+#include <ostream>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Phases of a server tick, in execution order
+ */
+enum class TickPhase {
+    NETWORK_INGEST,
+    SIMULATION,
+    SCRIPT_DISPATCH,
+    OUTBOUND_FLUSH,
+    COUNT
+};
+
+/**
+ * @brief Fixed-timestep tick scheduler with per-phase timing
+ *
+ * Tick deadlines are computed from the start time rather than from the end of
+ * the previous tick, so sleeping and processing jitter do not accumulate into
+ * rate drift. Each phase's time is recorded into a histogram in microseconds;
+ * ticks that exceed their budget are counted and reported.
+ */
+class TickScheduler {
+public:
+    explicit TickScheduler(unsigned int tickRate = 60);
+
+    /**
+     * @brief Change the tick rate (ticks per second)
+     */
+    void setTickRate(unsigned int tickRate);
+    unsigned int getTickRate() const { return tickRate; }
+    sf::Time getTickInterval() const { return tickInterval; }
+
+    /**
+     * @brief Time left before the next tick is due (zero if overdue)
+     */
+    sf::Time getTimeUntilNextTick() const;
+
+    /**
+     * @brief Check whether the next tick deadline has passed
+     */
+    bool isTickDue() const;
+
+    /**
+     * @brief Start a tick and advance the deadline by one interval
+     */
+    void beginTick();
+
+    /**
+     * @brief Finish a tick, committing phase times to the histograms
+     * @return True if the tick overran its budget
+     */
+    bool endTick();
+
+    /**
+     * @brief Start timing a phase; time accumulates until endPhase()
+     *
+     * Phases may be entered several times per tick (network ingest also runs
+     * between ticks); all of it is attributed to the next committed tick.
+     */
+    void beginPhase(TickPhase phase);
+    void endPhase();
+
+    const Histogram& getPhaseHistogram(TickPhase phase) const {
+        return phaseHistograms[static_cast<size_t>(phase)];
+    }
+    const Histogram& getTickHistogram() const { return tickHistogram; }
+
+    sf::Uint64 getTickCount() const { return tickCount; }
+    sf::Uint64 getOverrunCount() const { return overrunCount; }
+    sf::Uint64 getSkippedTickCount() const { return skippedTickCount; }
+
+    /**
+     * @brief Write p50/p99/max per phase in milliseconds
+     */
+    void writeReport(std::ostream& out) const;
+
+    static const char* getPhaseName(TickPhase phase);
+
+private:
+    static constexpr size_t PhaseCount = static_cast<size_t>(TickPhase::COUNT);
+
+    unsigned int tickRate;
+    sf::Time tickInterval;
+    sf::Clock clock;
+    sf::Time nextTickTime;
+    sf::Time tickStartTime;
+
+    TickPhase currentPhase;
+    bool phaseActive;
+    sf::Time phaseStartTime;
+    std::array<sf::Int64, PhaseCount> phaseAccumulated;
+
+    std::array<Histogram, PhaseCount> phaseHistograms;
+    Histogram tickHistogram;
+
+    sf::Uint64 tickCount;
+    sf::Uint64 overrunCount;
+    sf::Uint64 skippedTickCount;
+    sf::Time lastOverrunWarning;
+};
+
+} // namespace IsometricMUD
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <SFML/Network.hpp>
+#include <array>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace IsometricMUD {
+
+class PollableSocket;
+class WireBuffer;
+
+using WireBufferPtr = std::shared_ptr<const WireBuffer>;
+
+/**
+ * @brief Immutable, reference-counted encoding of one message
+ *
+ * Holds the message exactly as it appears on the wire: a 32-bit big-endian
+ * length followed by the payload. That is both a complete sf::Packet frame
+ * and a valid BATCH record, so the same bytes can be queued to any number of
+ * clients, alone or inside a batch, without being copied again.
+ */
+class WireBuffer {
+public:
+    /**
+     * @brief Encode a message once for sending to many clients
+     */
+    static WireBufferPtr encode(const sf::Packet& message);
+
+    /**
+     * @brief Frame an already encoded payload
+     */
+    static WireBufferPtr frame(const void* payload, size_t size);
+
+    explicit WireBuffer(std::vector<char> bytes);
+
+    const char* getData() const { return bytes.data(); }
+    size_t getSize() const { return bytes.size(); }
+
+private:
+    std::vector<char> bytes;
+};
+
+/**
+ * @brief Bytes waiting to be written to one client's socket
+ *
+ * Segments reference shared WireBuffers rather than copying them; a partial
+ * send just advances the offset into the front segment. Where the platform
+ * supports it, flush() hands every segment to the kernel in one gather write.
+ */
+class SendQueue {
+public:
+    SendQueue();
+
+    /**
+     * @brief Queue a few bytes owned by this queue (e.g. a frame header)
+     */
+    void pushInline(const char* data, size_t size);
+
+    /**
+     * @brief Queue a shared buffer by reference
+     */
+    void push(WireBufferPtr buffer);
+
+    bool empty() const { return segments.empty(); }
+    size_t getPendingBytes() const { return pendingBytes; }
+
+    /**
+     * @brief Write as much as the socket accepts without blocking
+     * @return Done when drained, Partial or NotReady when bytes remain,
+     *         Disconnected or Error if the connection failed
+     */
+    sf::Socket::Status flush(PollableSocket& socket);
+
+    void clear();
+
+private:
+    static const size_t InlineCapacity = 8;
+
+    struct Segment {
+        WireBufferPtr buffer;
+        std::array<char, InlineCapacity> inlineBytes;
+        size_t size;
+        size_t offset;
+
+        const char* data() const { return buffer ? buffer->getData() : inlineBytes.data(); }
+    };
+
+    void consume(size_t bytes);
+
+    std::deque<Segment> segments;
+    size_t pendingBytes;
+};
+
+} // namespace IsometricMUD
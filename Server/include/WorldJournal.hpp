@@ -0,0 +1,138 @@
+#pragma once
+
+#include <SFML/System.hpp>
+#include "Vector3D.hpp"
+#include "SpscRing.hpp"
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace IsometricMUD {
+
+/**
+ * @brief Saved state of one named player
+ */
+struct PlayerRecord {
+    std::string name;
+    Vector3D position;
+};
+
+/**
+ * @brief Durable player state: a compacted snapshot plus a write-ahead journal
+ *
+ * The tick thread reads and updates an in-memory copy of the state and, once
+ * per tick, hands the changes to a background writer through a lock-free
+ * ring; it never touches the disk. Positions are last-write-wins, so a player
+ * that moves many times between commits costs one journal entry, and entries
+ * that don't fit in a full ring simply wait for the next commit.
+ *
+ * The writer appends CRC-checked frames to world.journal, syncs at most every
+ * SyncInterval, and once the journal passes CompactThreshold writes the whole
+ * state to world.snapshot (via a temporary file and rename) and starts a new
+ * journal. Recovery reads the snapshot and replays journal entries newer than
+ * it, so startup time is bounded by the state's size, not the server's uptime.
+ * A torn frame at the end of the journal (a crash mid-write) is cut off.
+ */
+class WorldJournal {
+public:
+    WorldJournal();
+    ~WorldJournal();
+
+    WorldJournal(const WorldJournal&) = delete;
+    WorldJournal& operator=(const WorldJournal&) = delete;
+
+    /**
+     * @brief Recover the state stored in a directory and start the writer
+     * @return False if the directory is unusable or the snapshot is corrupt
+     */
+    bool open(const std::string& directory);
+
+    /**
+     * @brief Write out everything committed so far and stop the writer
+     */
+    void close();
+
+    bool isOpen() const { return writer.joinable(); }
+
+    /**
+     * @brief Look up a player by name (tick thread only)
+     * @return The persistent player id, or 0 if the name is unknown
+     */
+    sf::Uint32 findPlayer(const std::string& name) const;
+
+    const PlayerRecord* getPlayer(sf::Uint32 playerId) const;
+    size_t getPlayerCount() const { return players.size(); }
+
+    /**
+     * @brief Register a new player (tick thread only)
+     * @return The new player's persistent id
+     */
+    sf::Uint32 createPlayer(const std::string& name, const Vector3D& position);
+
+    /**
+     * @brief Record a player's latest position (tick thread only)
+     */
+    void setPosition(sf::Uint32 playerId, const Vector3D& position);
+
+    /**
+     * @brief Hand this tick's changes to the writer without blocking (tick thread only)
+     * @return True if nothing is left waiting for ring space
+     */
+    bool commit();
+
+private:
+    enum class EntryType : sf::Uint8 {
+        PLAYER_CREATED = 1,
+        PLAYER_MOVED = 2
+    };
+
+    struct Entry {
+        EntryType type = EntryType::PLAYER_MOVED;
+        sf::Uint32 playerId = 0;
+        Vector3D position;
+        std::string name;
+    };
+
+    using PlayerTable = std::unordered_map<sf::Uint32, PlayerRecord>;
+
+    static void applyEntry(PlayerTable& table, const Entry& entry);
+
+    bool loadSnapshot();
+    bool replayJournal();
+    void runWriter();
+    void appendEntry(const Entry& entry);
+    bool writeJournal();
+    bool compact();
+
+    std::string directory;
+    std::string snapshotPath;
+    std::string journalPath;
+
+    // Tick thread
+    PlayerTable players;
+    std::unordered_map<std::string, sf::Uint32> playerIds;
+    sf::Uint32 nextPlayerId;
+    std::deque<Entry> unsentCreations;          // Waiting for ring space, in order
+    std::vector<sf::Uint32> movedPlayers;       // Positions not yet handed over
+    std::vector<bool> movedFlags;               // By player id; whether it's in movedPlayers
+
+    SpscRing<Entry> ring;
+
+    // Writer thread (and open() before it starts)
+    std::thread writer;
+    std::atomic<bool> running;
+    PlayerTable savedPlayers;                   // State as of the last written entry
+    sf::Uint64 nextSequence;
+    std::FILE* journalFile;
+    size_t journalBytes;
+    size_t compactAt;                           // Journal size that triggers the next snapshot
+    std::vector<char> pendingBytes;             // Frames not yet handed to the file
+    bool unsynced;
+    sf::Clock syncClock;
+};
+
+} // namespace IsometricMUD
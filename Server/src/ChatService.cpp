@@ -0,0 +1,149 @@
+#include "ChatService.hpp"
+#include "ClientRegistry.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace IsometricMUD {
+
+void SubscriberSet::add(sf::Uint32 slot) {
+    size_t word = slot / 64;
+    if (word >= words.size()) {
+        words.resize(word + 1, 0);
+    }
+    std::uint64_t bit = std::uint64_t(1) << (slot % 64);
+    if ((words[word] & bit) == 0) {
+        words[word] |= bit;
+        count++;
+    }
+}
+
+void SubscriberSet::remove(sf::Uint32 slot) {
+    size_t word = slot / 64;
+    std::uint64_t bit = std::uint64_t(1) << (slot % 64);
+    if (word < words.size() && (words[word] & bit) != 0) {
+        words[word] &= ~bit;
+        count--;
+    }
+}
+
+ChatService::ChatService(float messagesPerSecond, float burstSize, unsigned int tickRate)
+    : tokensPerTick(messagesPerSecond / static_cast<float>(tickRate)), burst(std::max(1.0f, burstSize)) {
+}
+
+void ChatService::addMember(ClientInfo& client) {
+    // Reusing the lowest free slots keeps the bitmaps as short as the member count
+    sf::Uint32 slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<sf::Uint32>(members.size());
+        members.emplace_back();
+    }
+    
+    Member& member = members[slot];
+    member.client = &client;
+    member.tokens = burst;
+    member.lastRefill = 0;
+    member.parties.clear();
+    client.chatSlot = slot;
+    
+    global.add(slot);
+    zone.add(slot);
+}
+
+void ChatService::removeMember(ClientInfo& client) {
+    sf::Uint32 slot = client.chatSlot;
+    Member& member = members[slot];
+    global.remove(slot);
+    zone.remove(slot);
+    for (sf::Uint32 party : member.parties) {
+        auto found = parties.find(party);
+        found->second.remove(slot);
+        if (found->second.empty()) {
+            parties.erase(found);
+        }
+    }
+    member = Member();
+    
+    // Popped from the back, so keep the lowest slot there
+    freeSlots.insert(std::upper_bound(freeSlots.begin(), freeSlots.end(), slot, std::greater<sf::Uint32>()),
+                     slot);
+}
+
+bool ChatService::subscribe(const ClientInfo& client, ChatChannel channel, sf::Uint32 topic, bool join) {
+    sf::Uint32 slot = client.chatSlot;
+    switch (channel) {
+        case ChatChannel::GLOBAL:
+            if (join) {
+                global.add(slot);
+            } else {
+                global.remove(slot);
+            }
+            return true;
+        case ChatChannel::ZONE:
+            if (join) {
+                zone.add(slot);
+            } else {
+                zone.remove(slot);
+            }
+            return true;
+        case ChatChannel::PARTY: {
+            std::vector<sf::Uint32>& memberParties = members[slot].parties;
+            auto existing = std::find(memberParties.begin(), memberParties.end(), topic);
+            if (join) {
+                if (existing != memberParties.end()) {
+                    return true;
+                }
+                if (memberParties.size() >= MaxPartiesPerMember) {
+                    return false;
+                }
+                memberParties.push_back(topic);
+                parties[topic].add(slot);
+            } else if (existing != memberParties.end()) {
+                memberParties.erase(existing);
+                SubscriberSet& set = parties[topic];
+                set.remove(slot);
+                if (set.empty()) {
+                    parties.erase(topic);
+                }
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool ChatService::isSubscribed(const ClientInfo& client, ChatChannel channel, sf::Uint32 topic) const {
+    const SubscriberSet* set = findSet(channel, topic);
+    return set && set->contains(client.chatSlot);
+}
+
+bool ChatService::allowMessage(const ClientInfo& client, sf::Uint64 tick) {
+    Member& member = members[client.chatSlot];
+    member.tokens = std::min(burst, member.tokens + static_cast<float>(tick - member.lastRefill) * tokensPerTick);
+    member.lastRefill = tick;
+    if (member.tokens < 1.0f) {
+        return false;
+    }
+    member.tokens -= 1.0f;
+    return true;
+}
+
+const SubscriberSet* ChatService::findSet(ChatChannel channel, sf::Uint32 topic) const {
+    switch (channel) {
+        case ChatChannel::GLOBAL:
+            return &global;
+        case ChatChannel::ZONE:
+            return &zone;
+        case ChatChannel::PARTY: {
+            auto found = parties.find(topic);
+            return found != parties.end() ? &found->second : nullptr;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+} // namespace IsometricMUD
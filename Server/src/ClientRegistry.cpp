@@ -0,0 +1,40 @@
+#include "ClientRegistry.hpp"
+
+namespace IsometricMUD {
+
+void ClientRegistry::enqueue(std::unique_ptr<ClientInfo> client) {
+    pending.push(std::move(client));
+}
+
+ClientInfo* ClientRegistry::find(sf::Uint32 clientId) {
+    auto it = indexById.find(clientId);
+    if (it == indexById.end()) {
+        return nullptr;
+    }
+    return clients[it->second].get();
+}
+
+void ClientRegistry::clear() {
+    pending.drain([](std::unique_ptr<ClientInfo>) {});
+    clients.clear();
+    indexById.clear();
+}
+
+ClientInfo& ClientRegistry::insert(std::unique_ptr<ClientInfo> client) {
+    indexById[client->id] = clients.size();
+    clients.push_back(std::move(client));
+    return *clients.back();
+}
+
+void ClientRegistry::eraseAt(size_t index) {
+    indexById.erase(clients[index]->id);
+    
+    // Swap-remove keeps the array dense; fix up the index of the moved entry
+    if (index != clients.size() - 1) {
+        clients[index] = std::move(clients.back());
+        indexById[clients[index]->id] = index;
+    }
+    clients.pop_back();
+}
+
+} // namespace IsometricMUD
@@ -1,10 +1,47 @@
 #include "GameServer.hpp"
-#include "Movement.hpp"
+#include "MessageSchema.hpp"
+#include "AllocationCounter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
 
 namespace IsometricMUD {
 
-GameServer::GameServer() : running(false), nextClientId(1) {
+namespace {
+
+// NPC steps per second, whatever the tick rate
+const unsigned int NpcStepRate = 4;
+
+// A player must be this far into another zone before it is handed over, so
+// one walking along a border isn't passed back and forth
+const float HandoffMargin = 2.0f;
+
+// A crowd crossing a border together is spread over several ticks rather
+// than all reconnecting at once
+const unsigned int MaxHandoffsPerTick = 16;
+
+// Seconds a handoff may take before it is abandoned, and before a player
+// whose handoff failed is offered again
+const unsigned int HandoffTimeout = 5;
+const unsigned int HandoffRetryDelay = 5;
+
+// SCRIPT_EVENTs each client may trigger per second; the rest are dropped
+const unsigned int ScriptEventsPerSecond = 4;
+
+} // namespace
+
+GameServer::GameServer(const ServerConfig& serverConfig)
+    : config(serverConfig), running(false), lastAllocationCount(0), nextClientId(1), udpPort(0),
+      randomSeed(0), scheduler(serverConfig.tickRate),
+      metrics(metricsRegistry, scheduler), metricsServer(metricsRegistry),
+      interest(serverConfig.interestRadius, serverConfig.interestCellSize),
+      chat(serverConfig.chatRate, serverConfig.chatBurst, serverConfig.tickRate),
+      pathfinder(terrain), npcStepCountdown(0),
+      spawnCache(&tickArena), removeCache(&tickArena), positionCache(&tickArena) {
+    seedRandom(config.randomSeed != 0 ? config.randomSeed : std::random_device{}());
+    scriptEngine.setTemporaryResource(&tickArena);
 }
 
 GameServer::~GameServer() {
@@ -12,12 +49,70 @@ GameServer::~GameServer() {
 }
 
 bool GameServer::start(unsigned short port) {
+    // A shard listens where the shard map says and numbers its entities
+    // from its own block so ids never clash across the border
+    if (!config.shardMapFile.empty()) {
+        if (!shardMap.load(config.shardMapFile)) {
+            return false;
+        }
+        if (config.shardIndex >= shardMap.size()) {
+            std::cerr << "Error: Shard " << config.shardIndex << " is not in " << config.shardMapFile << std::endl;
+            return false;
+        }
+        port = shardMap.get(config.shardIndex).clientPort;
+        nextClientId = (config.shardIndex << ShardIdBits) + 1;
+        peerUp.assign(shardMap.size(), false);
+        ghostedTo.resize(shardMap.size());
+        ghostsFrom.resize(shardMap.size());
+        ghostRemovals.resize(shardMap.size());
+    }
+    
+    if (!loadWorld()) {
+        return false;
+    }
+    
+    // Sessions are recorded from the first tick so a replay starts from the same empty world
+    if (!config.captureFile.empty() &&
+        !capture.open(config.captureFile, scheduler.getTickRate(), randomSeed)) {
+        return false;
+    }
+    
     if (listener.listen(port) != sf::Socket::Done) {
         std::cerr << "Error: Could not bind to port " << port << std::endl;
         return false;
     }
     
     std::cout << "Server started on port " << port << std::endl;
+    
+    // Movement goes over UDP when the port is free; otherwise everything stays on TCP
+    if (config.udpEnabled) {
+        if (udpSocket.bind(port) == sf::Socket::Done) {
+            udpSocket.setBlocking(false);
+            udpSocket.setSimulation(config.simulatedLoss,
+                                    sf::milliseconds(static_cast<sf::Int32>(config.simulatedLatency)),
+                                    sf::milliseconds(static_cast<sf::Int32>(config.simulatedJitter)));
+            poller.add(DatagramSocketId, udpSocket);
+            udpPort = port;
+            std::cout << "UDP movement channel on port " << port << std::endl;
+        } else {
+            std::cerr << "Warning: Could not bind UDP port " << port
+                      << "; movement will use TCP" << std::endl;
+        }
+    }
+    
+    if (config.adminPort != 0 && !metricsServer.start(config.adminPort)) {
+        listener.close();
+        udpSocket.unbind();
+        return false;
+    }
+    
+    if (isSharded() && !shardLink.start(shardMap, config.shardIndex)) {
+        listener.close();
+        udpSocket.unbind();
+        metricsServer.stop();
+        return false;
+    }
+    
     running = true;
     return true;
 }
@@ -25,100 +120,1469 @@ bool GameServer::start(unsigned short port) {
 void GameServer::stop() {
     running = false;
     listener.close();
+    udpSocket.unbind();
+    metricsServer.stop();
     
-    // Close all client connections
+    if (acceptThread.joinable()) {
+        acceptThread.join();
+    }
+    pathfinder.stop();
+    shardLink.stop();
+    
+    // Close all client connections; sessions still queued are closed by clear()
     for (auto& client : clients) {
-        if (client.second->socket) {
-            client.second->socket->disconnect();
+        if (client->socket) {
+            client->socket->disconnect();
         }
     }
     clients.clear();
     
-    if (acceptThread.joinable()) {
-        acceptThread.join();
+    journal.close();
+    capture.close();
+}
+
+bool GameServer::loadWorld() {
+    if (!config.levelFile.empty()) {
+        std::vector<TileData> tiles;
+        if (!LevelFile::load(config.levelFile, tiles)) {
+            return false;
+        }
+        terrain.build(tiles);
+        std::cout << "Terrain: " << terrain.getChunkCount() << " chunks, "
+                  << terrain.getMemoryUsage() / 1024 << " KiB" << std::endl;
+        
+        pathfinder.start(config.pathThreads);
+        spawnNpcs();
+    }
+    
+    // Saved state is recovered before anyone can connect
+    if (!config.dataDirectory.empty() && !journal.open(config.dataDirectory)) {
+        std::cerr << "Error: Could not load saved state from " << config.dataDirectory << std::endl;
+        return false;
     }
+    return true;
+}
+
+void GameServer::seedRandom(sf::Uint32 seed) {
+    randomSeed = seed;
+    tokenGenerator.seed(seed);
+    npcRandom.seed(seed + 1);
+}
+
+bool GameServer::replay(const std::string& captureFile, bool realTime) {
+    CaptureReader reader;
+    if (!reader.open(captureFile)) {
+        return false;
+    }
+    if (reader.getTickRate() != scheduler.getTickRate()) {
+        std::cerr << "Warning: " << captureFile << " was recorded at " << reader.getTickRate()
+                  << " Hz; replaying at " << scheduler.getTickRate() << " Hz" << std::endl;
+    }
+    
+    // Same seed, same tokens and the same NPC walks as the recorded run
+    seedRandom(reader.getSeed());
+    if (!loadWorld()) {
+        return false;
+    }
+    
+    std::cout << "Replaying " << captureFile << (realTime ? " in real time" : " at full speed") << std::endl;
+    running = true;
+    sf::Clock wallClock;
+    CapturedTick next;
+    bool more = reader.readTick(next);
+    while (running && more) {
+        if (realTime) {
+            while (!scheduler.isTickDue()) {
+                sf::sleep(scheduler.getTimeUntilNextTick());
+            }
+        }
+        
+        // Ticks the capture skipped had no input and run empty
+        if (next.tick <= scheduler.getTickCount()) {
+            feedCapturedTick(next);
+            more = reader.readTick(next);
+        }
+        runTick();
+    }
+    sf::Time elapsed = wallClock.getElapsedTime();
+    
+    if (reader.isDamaged()) {
+        std::cerr << "Warning: " << captureFile << " ends in a damaged record; replayed up to tick "
+                  << scheduler.getTickCount() << std::endl;
+    }
+    
+    scheduler.writeReport(std::cout);
+    writeReplaySummary(std::cout, captureFile, realTime, elapsed);
+    return true;
+}
+
+void GameServer::runSyntheticLoad(const std::vector<TileData>& level, unsigned int clientCount,
+                                  float movesPerSecond, unsigned int warmupTicks,
+                                  unsigned int measuredTicks, Histogram& tickTimes) {
+    terrain.build(level);
+    
+    sf::Uint32 firstClientId = nextClientId;
+    for (unsigned int i = 0; i < clientCount; i++) {
+        auto client = std::make_unique<ClientInfo>(&tickArena);
+        client->id = nextClientId++;
+        clients.enqueue(std::move(client));
+    }
+    
+    // LoadGen's four directions, encoded once; the server moves whoever sent them
+    std::vector<sf::Packet> moves;
+    for (int dir = 0; dir < 4; dir++) {
+        moves.push_back(NetworkProtocol::createMovePacket(0, static_cast<Direction>(dir)));
+    }
+    std::mt19937 loadRandom(randomSeed + 2);
+    std::bernoulli_distribution moveChance(std::min(1.0, static_cast<double>(movesPerSecond) /
+                                                         scheduler.getTickRate()));
+    std::uniform_int_distribution<size_t> moveDistribution(0, moves.size() - 1);
+    
+    for (unsigned int tick = 0; tick < warmupTicks + measuredTicks; tick++) {
+        // Timed from ingest, as a tick of the real loop starts once the poller wakes
+        sf::Clock tickClock;
+        for (sf::Uint32 clientId = firstClientId; clientId < nextClientId; clientId++) {
+            if (moveChance(loadRandom)) {
+                const sf::Packet& move = moves[moveDistribution(loadRandom)];
+                queueInbound(clientId, move.getData(), move.getDataSize());
+            }
+        }
+        runTick();
+        if (tick >= warmupTicks) {
+            tickTimes.record(static_cast<std::uint64_t>(tickClock.getElapsedTime().asMicroseconds()));
+        }
+    }
+}
+
+void GameServer::feedCapturedTick(const CapturedTick& tick) {
+    // A session may connect and leave within one tick, before the table has absorbed it
+    std::unordered_map<sf::Uint32, ClientInfo*> joining;
+    
+    for (const auto& event : tick.events) {
+        switch (event.kind) {
+            case CaptureEvent::CONNECT: {
+                auto client = std::make_unique<ClientInfo>(&tickArena);
+                client->id = event.clientId;
+                joining[event.clientId] = client.get();
+                clients.enqueue(std::move(client));
+                break;
+            }
+            case CaptureEvent::DISCONNECT: {
+                ClientInfo* client = clients.find(event.clientId);
+                auto pending = joining.find(event.clientId);
+                if (!client && pending != joining.end()) {
+                    client = pending->second;
+                }
+                if (client) {
+                    client->connected = false;
+                }
+                break;
+            }
+            case CaptureEvent::PACKET:
+                queueInbound(event.clientId, event.bytes.data(), event.bytes.size());
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void GameServer::writeReplaySummary(std::ostream& out, const std::string& captureFile, bool realTime,
+                                    sf::Time elapsed) const {
+    // One JSON line per run, so builds can be compared by diffing or with jq
+    double seconds = elapsed.asSeconds() > 0.0f ? elapsed.asSeconds() : 1.0;
+    
+    auto writeHistogram = [&out](const char* name, const Histogram& histogram) {
+        out << "\"" << name << "\":{"
+            << "\"p50\":" << histogram.percentile(0.50)
+            << ",\"p90\":" << histogram.percentile(0.90)
+            << ",\"p99\":" << histogram.percentile(0.99)
+            << ",\"p999\":" << histogram.percentile(0.999)
+            << ",\"max\":" << histogram.getMax()
+            << "}";
+    };
+    
+    std::ios::fmtflags savedFlags = out.flags();
+    out << std::fixed << std::setprecision(1);
+    out << "{"
+        << "\"capture\":\"" << captureFile << "\""
+        << ",\"speed\":\"" << (realTime ? "realtime" : "full") << "\""
+        << ",\"tick_rate\":" << scheduler.getTickRate()
+        << ",\"ticks\":" << scheduler.getTickCount()
+        << ",\"overruns\":" << scheduler.getOverrunCount()
+        << ",\"wall_s\":" << seconds
+        << ",\"ticks_per_s\":" << scheduler.getTickCount() / seconds
+        << ",\"tick_us\":{";
+    writeHistogram("total", scheduler.getTickHistogram());
+    for (size_t i = 0; i < static_cast<size_t>(TickPhase::COUNT); i++) {
+        TickPhase phase = static_cast<TickPhase>(i);
+        out << ",";
+        writeHistogram(TickScheduler::getPhaseName(phase), scheduler.getPhaseHistogram(phase));
+    }
+    out << "},\"arena_high_water_bytes\":" << tickArena.getHighWater()
+        << ",\"arena_spills\":" << tickArena.getSpillCount();
+    if (AllocationCounter::isEnabled()) {
+        out << ",";
+        writeHistogram("tick_allocations", metrics.getTickAllocations());
+    }
+    out << "}" << std::endl;
+    out.flags(savedFlags);
+}
+
+bool GameServer::loadScript(const std::string& filename) {
+    return scriptEngine.loadScript(filename);
 }
 
 void GameServer::run() {
     // Start accepting clients in a separate thread
     acceptThread = std::thread(&GameServer::acceptClients, this);
     
-    // Main server loop
+    std::cout << "Socket readiness backend: " << poller.getBackendName() << std::endl;
+    std::cout << "Tick rate: " << scheduler.getTickRate() << " Hz" << std::endl;
+    
+    // Main server loop: receive whenever sockets are ready, simulate on schedule
     while (running) {
-        sf::sleep(sf::milliseconds(16)); // ~60 FPS
+        // Wake up early while the loss simulator is holding datagrams back
+        sf::Time timeout = scheduler.getTimeUntilNextTick();
+        if (udpSocket.hasDelayed() && timeout > sf::milliseconds(1)) {
+            timeout = sf::milliseconds(1);
+        }
         
-        // Process client messages
-        for (auto& clientPair : clients) {
-            sf::Packet packet;
-            sf::Socket::Status status = clientPair.second->socket->receive(packet);
-            
-            if (status == sf::Socket::Done) {
-                PacketType type = NetworkProtocol::getPacketType(packet);
-                
-                switch (type) {
-                    case PacketType::MOVE: {
-                        sf::Uint32 entityId;
-                        Direction dir;
-                        if (NetworkProtocol::parseMovePacket(packet, entityId, dir)) {
-                            // Update position
-                            clientPair.second->position = Movement::applyMovement(
-                                clientPair.second->position, dir);
-                            
-                            // Broadcast new position to all clients
-                            sf::Packet updatePacket = NetworkProtocol::createPositionPacket(
-                                clientPair.first, clientPair.second->position);
-                            broadcastPacket(updatePacket);
-                        }
-                        break;
-                    }
-                    case PacketType::CHAT: {
-                        // Broadcast chat message
-                        broadcastPacket(packet);
-                        break;
-                    }
-                    default:
-                        break;
+        if (poller.wait(timeout, readyClients)) {
+            scheduler.beginPhase(TickPhase::NETWORK_INGEST);
+            for (sf::Uint32 clientId : readyClients) {
+                if (clientId == DatagramSocketId) {
+                    handleDatagrams();
+                } else {
+                    handleClient(clientId);
                 }
-            } else if (status == sf::Socket::Disconnected) {
-                std::cout << "Client " << clientPair.first << " disconnected" << std::endl;
-                clientPair.second->socket->disconnect();
             }
+            scheduler.endPhase();
+        }
+        udpSocket.releaseDelayed();
+        
+        if (scheduler.isTickDue()) {
+            runTick();
+        }
+    }
+}
+
+void GameServer::runTick() {
+    sf::Uint64 tick = scheduler.getTickCount();
+    scheduler.beginTick();
+    
+    scheduler.beginPhase(TickPhase::NETWORK_INGEST);
+    updateClientTable();
+    
+    scheduler.beginPhase(TickPhase::SIMULATION);
+    interest.beginTick();
+    receiveShardMessages();
+    processInbound();
+    updateNpcs();
+    updateShards();
+    updateInterest();
+    if (journal.isOpen()) {
+        journal.commit();
+    }
+    if (capture.isOpen()) {
+        capture.commitTick(tick);
+    }
+    
+    scheduler.beginPhase(TickPhase::SCRIPT_DISPATCH);
+    dispatchScriptEvents();
+    
+    scheduler.beginPhase(TickPhase::OUTBOUND_FLUSH);
+    flushOutbound();
+    
+    // Nothing from this tick is left holding arena memory
+    tickArena.reset();
+    metrics.setTickArena(tickArena.getCapacity(), tickArena.getHighWater(), tickArena.getSpillCount());
+    std::uint64_t allocations = AllocationCounter::getThreadCount();
+    metrics.recordTickAllocations(allocations - lastAllocationCount);
+    lastAllocationCount = allocations;
+    
+    metrics.recordTick(scheduler.endTick());
+    metrics.publish();
+    
+    if (config.statsInterval > 0 &&
+        statsClock.getElapsedTime() >= sf::seconds(static_cast<float>(config.statsInterval))) {
+        statsClock.restart();
+        scheduler.writeReport(std::cout);
+        if (AllocationCounter::isEnabled()) {
+            const Histogram& perTick = metrics.getTickAllocations();
+            std::cout << "  allocations/tick p50 " << perTick.percentile(0.50) << "  p99 "
+                      << perTick.percentile(0.99) << "  max " << perTick.getMax() << std::endl;
         }
     }
 }
 
 void GameServer::acceptClients() {
     while (running) {
-        auto socket = std::make_unique<sf::TcpSocket>();
+        auto socket = std::make_unique<PollableSocket>();
         if (listener.accept(*socket) == sf::Socket::Done) {
             sf::Uint32 clientId = nextClientId++;
             
-            auto client = std::make_unique<ClientInfo>();
+            // Non-blocking so handleClient can drain until the socket runs dry
+            socket->setBlocking(false);
+            
+            auto client = std::make_unique<ClientInfo>(&tickArena);
             client->id = clientId;
             client->socket = std::move(socket);
-            client->position = Vector3D(0, 0, 0);
             
-            clients[clientId] = std::move(client);
+            // Hand the session to the tick thread; it is absorbed at the next tick
+            clients.enqueue(std::move(client));
+        }
+    }
+}
+
+void GameServer::updateClientTable() {
+    clients.absorbPending([this](ClientInfo& client) {
+        // Replayed sessions have no socket
+        if (client.socket) {
+            poller.add(client.id, *client.socket);
+        }
+        if (capture.isOpen()) {
+            capture.recordConnect(client.id);
+        }
+        
+        // Tell the client its id and how to open the UDP channel
+        client.udpToken = tokenGenerator();
+        client.outbox.queueMessage(WireBuffer::encode(
+            NetworkProtocol::createConnectPacket(client.id, client.udpToken, udpPort)));
+        
+        // A loaded level may have a wall or a hole at the origin; then the
+        // player starts on some walkable cell and is told where by updateInterest()
+        Vector3D spawn(0, 0, 0);
+        bool spawnMoved = !terrain.empty() && !terrain.isWalkable(spawn) && pickWalkableCell(spawn);
+        
+        // Nearby clients receive SPAWN_ENTITY for it from updateInterest()
+        client.entity = entities.create(spawn, client.id, EntityStore::PlayerFlag);
+        interest.addEntity(client.id, spawn);
+        if (spawnMoved) {
+            interest.moveEntity(client.id, spawn);
+        }
+        chat.addMember(client);
+        
+        metrics.recordConnect();
+        std::cout << "New client connected: " << client.id << std::endl;
+    });
+    
+    clients.reap([this](ClientInfo& client) {
+        interest.removeEntity(client.id);
+        interest.removeObserver(client.id);
+        entities.destroy(client.entity);
+        chat.removeMember(client);
+        if (capture.isOpen()) {
+            capture.recordDisconnect(client.id);
+        }
+        for (size_t peer = 0; peer < ghostedTo.size(); peer++) {
+            if (ghostedTo[peer].erase(client.id) > 0) {
+                ghostRemovals[peer].push_back(client.id);
+            }
+        }
+        metrics.recordDisconnect();
+        std::cout << "Client " << client.id << " removed" << std::endl;
+    });
+    
+    metrics.setClientCount(clients.size());
+}
+
+void GameServer::handleClient(sf::Uint32 clientId) {
+    ClientInfo* found = clients.find(clientId);
+    if (!found || !found->connected) {
+        return;
+    }
+    
+    ClientInfo& client = *found;
+    
+    // Drain every complete packet that is already buffered for this client;
+    // they are applied in the simulation phase of the next tick
+    while (true) {
+        sf::Socket::Status status = client.socket->receive(receivedPacket);
+        
+        if (status == sf::Socket::Done) {
+            metrics.recordReceived(NetworkProtocol::getPacketType(receivedPacket.getData(),
+                                                                  receivedPacket.getDataSize()),
+                                   receivedPacket.getDataSize() + 4);
+            queueInbound(clientId, receivedPacket.getData(), receivedPacket.getDataSize());
+        } else {
+            if (status == sf::Socket::Disconnected || status == sf::Socket::Error) {
+                disconnectClient(client);
+            }
+            break;
+        }
+    }
+}
+
+void GameServer::handleDatagrams() {
+    char buffer[MaxDatagramSize];
+    std::size_t received = 0;
+    sf::IpAddress sender;
+    unsigned short senderPort = 0;
+    
+    while (udpSocket.receive(buffer, sizeof(buffer), received, sender, senderPort) == sf::Socket::Done) {
+        metrics.recordDatagramReceived(received);
+        
+        // [client id][token][channel header][first move number][count][MOVE...]
+        WireReader reader(buffer, received);
+        sf::Uint32 clientId = static_cast<sf::Uint32>(reader.readVarUInt());
+        sf::Uint32 token = reader.readUInt32();
+        
+        ClientInfo* client = clients.find(clientId);
+        if (!reader.ok() || !client || !client->connected || token != client->udpToken ||
+            sender != client->socket->getRemoteAddress()) {
+            continue;
+        }
+        
+        // Follow the newest source port in case a NAT rebinds it
+        if (!client->udpBound || senderPort != client->udpPort) {
+            if (!client->udpBound) {
+                std::cout << "Client " << client->id << " bound UDP port " << senderPort << std::endl;
+            }
+            client->udpBound = true;
+            client->udpAddress = sender;
+            client->udpPort = senderPort;
+        }
+        
+        newlyAcked.clear();
+        bool fresh = client->datagrams.readHeader(reader, newlyAcked);
+        
+        // A position is settled once the newest datagram carrying it arrived
+        if (!newlyAcked.empty()) {
+            for (auto it = client->unackedPositions.begin(); it != client->unackedPositions.end();) {
+                if (std::find(newlyAcked.begin(), newlyAcked.end(), it->second) != newlyAcked.end()) {
+                    it = client->unackedPositions.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        
+        if (!fresh) {
+            continue;
+        }
+        
+        // Clients repeat moves until a datagram carrying them is acknowledged,
+        // so apply each move number exactly once
+        sf::Uint32 moveNumber = static_cast<sf::Uint32>(reader.readVarUInt());
+        sf::Uint64 count = reader.readVarUInt();
+        for (sf::Uint64 i = 0; i < count; i++, moveNumber++) {
+            Direction dir;
+            sf::Uint32 entityId;
+            if (!Messages::Move::decode(reader, dir, entityId)) {
+                break;
+            }
+            if (moveNumber <= client->lastMoveNumber) {
+                continue;
+            }
+            client->lastMoveNumber = moveNumber;
             
-            std::cout << "New client connected: " << clientId << std::endl;
+            // Re-encoded as a MOVE so the simulation sees the same packet either way
+            char encoded[16];
+            WireWriter writer(encoded, sizeof(encoded));
+            if (Messages::Move::encode(writer, dir, client->id)) {
+                queueInbound(client->id, encoded, writer.getSize());
+            }
+        }
+    }
+}
+
+void GameServer::queueInbound(sf::Uint32 clientId, const void* data, size_t size) {
+    char* bytes = static_cast<char*>(tickArena.allocate(size > 0 ? size : 1, 1));
+    if (size > 0) {
+        std::memcpy(bytes, data, size);
+    }
+    inbound.push_back({clientId, std::string_view(bytes, size)});
+}
+
+void GameServer::processInbound() {
+    for (auto& received : inbound) {
+        // Recorded in the order the simulation sees them, UDP moves included
+        if (capture.isOpen()) {
+            capture.recordPacket(received.clientId, received.bytes);
+        }
+        ClientInfo* client = clients.find(received.clientId);
+        if (client && client->connected) {
+            handlePacket(*client, received.bytes);
+        }
+    }
+    inbound.clear();
+    
+    applyMoves();
+}
+
+void GameServer::applyMoves() {
+    // All of the tick's moves are checked in one pass over the terrain, in
+    // the order they arrived, so a client's second move starts where its
+    // first one ended
+    for (const auto& move : pendingMoves) {
+        ClientInfo* client = clients.find(move.clientId);
+        if (!client || !client->connected || client->handoffToken != 0) {
+            continue;
+        }
+        
+        Vector3D& position = entities.getPosition(client->entity);
+        Vector3D target = Movement::applyMovement(position, move.direction);
+        if (!Movement::isValidMovement(terrain, position, target)) {
+            // Mark the entity moved anyway so the client is sent the position
+            // it really has and drops its prediction
+            interest.moveEntity(client->id, position);
+            continue;
+        }
+        
+        // Clients that can see it are told in updateInterest()
+        position = target;
+        interest.moveEntity(client->id, position);
+        if (client->playerId != 0) {
+            journal.setPosition(client->playerId, position);
+        }
+    }
+    pendingMoves.clear();
+}
+
+void GameServer::spawnNpcs() {
+    std::uniform_int_distribution<unsigned int> restDistribution(0, scheduler.getTickRate());
+    for (unsigned int i = 0; i < config.npcCount; i++) {
+        Vector3D position;
+        if (!pickWalkableCell(position)) {
+            std::cerr << "Warning: No walkable ground found for NPCs; spawned " << i << std::endl;
+            return;
+        }
+        
+        Npc npc;
+        npc.id = FirstNpcId + (config.shardIndex << ShardIdBits) + i;
+        npc.entity = entities.create(position, 0, EntityStore::NpcFlag);
+        
+        // Spread out the first path requests instead of sending them all at once
+        npc.restTicks = restDistribution(npcRandom);
+        interest.addEntity(npc.id, position);
+        npcs.push_back(std::move(npc));
+    }
+    if (!npcs.empty()) {
+        std::cout << "Spawned " << npcs.size() << " NPCs" << std::endl;
+    }
+}
+
+void GameServer::updateNpcs() {
+    if (npcs.empty()) {
+        return;
+    }
+    
+    // Paths solved since the last tick; an unreachable goal leaves the path
+    // empty and the NPC rests before trying another
+    pathfinder.collect([this](PathResult&& result) {
+        metrics.recordPathResult(result.found, result.cached);
+        Npc& npc = npcs[result.ownerId - npcs.front().id];
+        npc.waitingForPath = false;
+        npc.path = std::move(result.steps);
+        npc.nextStep = 0;
+        if (npc.path.empty()) {
+            npc.restTicks = scheduler.getTickRate();
+        }
+    });
+    
+    bool stepDue = npcStepCountdown == 0;
+    npcStepCountdown = stepDue ? std::max(1u, scheduler.getTickRate() / NpcStepRate) - 1 : npcStepCountdown - 1;
+    
+    for (auto& npc : npcs) {
+        if (npc.waitingForPath) {
+            continue;
+        }
+        if (npc.restTicks > 0) {
+            npc.restTicks--;
+            continue;
+        }
+        
+        size_t index = entities.getIndex(npc.entity);
+        Vector3D& position = entities.getPositions()[index];
+        Vector3D& velocity = entities.getVelocities()[index];
+        
+        // Arrived (or never left): ask for a walk to somewhere new
+        if (npc.nextStep >= npc.path.size()) {
+            velocity = Vector3D(0, 0, 0);
+            Vector3D goal;
+            if (pickWalkableCell(goal)) {
+                pathfinder.submit(npc.id, position, goal);
+                metrics.recordPathRequest();
+                npc.waitingForPath = true;
+            }
+            continue;
+        }
+        
+        if (!stepDue) {
+            continue;
+        }
+        
+        // NPCs obey the same terrain rules as players and stay in their
+        // shard's zone; a tile changed under the path means planning again
+        velocity = Movement::getDirectionVector(npc.path[npc.nextStep++]);
+        Vector3D target = position + velocity;
+        if (!Movement::isValidMovement(terrain, position, target) || !ownsPosition(target)) {
+            npc.path.clear();
+            npc.nextStep = 0;
+            continue;
+        }
+        position = target;
+        interest.moveEntity(npc.id, position);
+        if (npc.nextStep == npc.path.size()) {
+            npc.restTicks = scheduler.getTickRate();
+        }
+    }
+    
+    pathfinder.dispatch();
+}
+
+bool GameServer::pickWalkableCell(Vector3D& cell) {
+    if (terrain.empty()) {
+        return false;
+    }
+    
+    // A shard only picks cells in its own zone
+    float minX = static_cast<float>(terrain.getOriginX());
+    float maxX = static_cast<float>(terrain.getOriginX() + terrain.getSizeX() - 1);
+    if (isSharded()) {
+        const ShardInfo& zone = shardMap.get(config.shardIndex);
+        minX = std::max(minX, std::ceil(zone.minX));
+        maxX = std::min(maxX, std::ceil(zone.maxX) - 1.0f);
+        if (minX > maxX) {
+            return false;
+        }
+    }
+    
+    // Random columns, taking the lowest floor in each; levels are mostly
+    // ground with the odd wall, so a few tries are plenty
+    std::uniform_int_distribution<int> xDistribution(static_cast<int>(minX), static_cast<int>(maxX));
+    std::uniform_int_distribution<int> yDistribution(0, terrain.getSizeY() - 1);
+    for (int attempt = 0; attempt < 32; attempt++) {
+        int x = xDistribution(npcRandom);
+        int y = terrain.getOriginY() + yDistribution(npcRandom);
+        for (int z = terrain.getOriginZ(); z < terrain.getOriginZ() + terrain.getSizeZ(); z++) {
+            if (terrain.isWalkable(x, y, z)) {
+                cell = Vector3D(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool GameServer::ownsPosition(const Vector3D& position) const {
+    // distanceOutside is 0 on maxX too, but that column belongs to the next shard
+    return !isSharded() || shardMap.findOwner(position.x) == static_cast<int>(config.shardIndex);
+}
+
+void GameServer::receiveShardMessages() {
+    if (!isSharded()) {
+        return;
+    }
+    
+    shardLink.poll([this](ShardEvent&& event) {
+        switch (event.type) {
+            case ShardEvent::Type::PEER_UP:
+                // Everything near its border is sent afresh by the next updateShards()
+                peerUp[event.peer] = true;
+                break;
+            case ShardEvent::Type::PEER_DOWN:
+                peerUp[event.peer] = false;
+                dropGhosts(event.peer);
+                ghostedTo[event.peer].clear();
+                ghostRemovals[event.peer].clear();
+                for (auto& client : clients) {
+                    if (client->handoffToken != 0 && client->handoffTarget == event.peer && !client->redirected) {
+                        cancelHandoff(*client, "lost its shard link");
+                    }
+                }
+                break;
+            case ShardEvent::Type::MESSAGE:
+                handleShardMessage(event.peer, event.packet);
+                break;
+        }
+    });
+}
+
+void GameServer::handleShardMessage(unsigned int peer, sf::Packet& packet) {
+    WireReader reader(packet.getData(), packet.getDataSize());
+    ShardPacket type = static_cast<ShardPacket>(reader.readByte());
+    
+    switch (type) {
+        case ShardPacket::GHOSTS: {
+            // [count][entity, position...][count][entity...]
+            std::unordered_set<sf::Uint32>& ghosts = ghostsFrom[peer];
+            sf::Uint64 count = reader.readVarUInt();
+            for (sf::Uint64 i = 0; i < count; i++) {
+                sf::Uint32 entityId = static_cast<sf::Uint32>(reader.readVarUInt());
+                Vector3D position;
+                Field::Position::read(reader, position);
+                if (!reader.ok()) {
+                    return;
+                }
+                if (ghosts.insert(entityId).second) {
+                    interest.addEntity(entityId, position);
+                } else {
+                    interest.moveEntity(entityId, position);
+                }
+            }
+            count = reader.readVarUInt();
+            for (sf::Uint64 i = 0; i < count; i++) {
+                sf::Uint32 entityId = static_cast<sf::Uint32>(reader.readVarUInt());
+                if (!reader.ok()) {
+                    return;
+                }
+                if (ghosts.erase(entityId) > 0) {
+                    interest.removeEntity(entityId);
+                }
+            }
+            break;
+        }
+        case ShardPacket::HANDOFF: {
+            // [token][position][name]; held until the client presents the token
+            sf::Uint32 token = reader.readUInt32();
+            IncomingHandoff handoff;
+            Field::Position::read(reader, handoff.position);
+            std::string_view name;
+            Field::Text::read(reader, name);
+            if (!reader.ok() || name.size() > MaxPlayerNameLength) {
+                return;
+            }
+            handoff.name.assign(name.data(), name.size());
+            incomingHandoffs[token] = std::move(handoff);
             
-            // Send spawn packet to all other clients
-            sf::Packet spawnPacket = NetworkProtocol::createPositionPacket(
-                clientId, Vector3D(0, 0, 0));
-            broadcastPacket(spawnPacket, clientId);
+            char buffer[8];
+            WireWriter writer(buffer, sizeof(buffer));
+            writer.writeByte(static_cast<sf::Uint8>(ShardPacket::HANDOFF_ACCEPT));
+            writer.writeUInt32(token);
+            sf::Packet reply;
+            reply.append(buffer, writer.getSize());
+            shardLink.send(peer, std::move(reply));
+            break;
+        }
+        case ShardPacket::CHAT: {
+            // [sender][message]; a GLOBAL line from a player on the peer shard
+            sf::Uint32 sender = static_cast<sf::Uint32>(reader.readVarUInt());
+            std::string_view text;
+            Field::Text::read(reader, text);
+            if (!reader.ok()) {
+                return;
+            }
+            WireBufferPtr message = WireBuffer::encode(
+                NetworkProtocol::createChatPacket(ChatChannel::GLOBAL, sender, std::string(text)));
+            metrics.recordChat(deliverChat(ChatChannel::GLOBAL, 0, message));
+            break;
+        }
+        case ShardPacket::HANDOFF_ACCEPT: {
+            sf::Uint32 token = reader.readUInt32();
+            if (!reader.ok()) {
+                return;
+            }
+            for (auto& client : clients) {
+                if (client->connected && client->handoffToken == token && !client->redirected) {
+                    // The client reconnects on its own; its session here ends when it does
+                    client->redirected = true;
+                    client->outbox.queueMessage(WireBuffer::encode(NetworkProtocol::createRedirectPacket(
+                        shardMap.get(peer).clientPort, token)));
+                    metrics.recordHandoff(true);
+                    std::cout << "Client " << client->id << " handed off to shard " << peer << std::endl;
+                    break;
+                }
+            }
+            break;
         }
+        default:
+            break;
     }
 }
 
-void GameServer::handleClient(sf::Uint32 clientId) {
-    // Client handling is done in the main loop
+void GameServer::dropGhosts(unsigned int peer) {
+    for (sf::Uint32 entityId : ghostsFrom[peer]) {
+        interest.removeEntity(entityId);
+    }
+    ghostsFrom[peer].clear();
+}
+
+void GameServer::updateShards() {
+    if (!isSharded()) {
+        return;
+    }
+    
+    updateHandoffs();
+    
+    size_t ghostCount = 0;
+    for (unsigned int peer = 0; peer < shardMap.size(); peer++) {
+        if (peerUp[peer]) {
+            sendGhosts(peer);
+        }
+        ghostCount += ghostsFrom[peer].size();
+    }
+    metrics.setGhostCount(ghostCount);
+}
+
+void GameServer::updateHandoffs() {
+    unsigned int timeoutTicks = HandoffTimeout * scheduler.getTickRate();
+    unsigned int started = 0;
+    
+    for (auto& client : clients) {
+        if (!client->connected) {
+            continue;
+        }
+        
+        if (client->handoffToken != 0) {
+            if (++client->handoffTicks < timeoutTicks) {
+                continue;
+            }
+            if (client->redirected) {
+                std::cout << "Client " << client->id << " ignored its redirect" << std::endl;
+                disconnectClient(*client);
+            } else {
+                cancelHandoff(*client, "timed out");
+            }
+            continue;
+        }
+        if (client->handoffCooldown > 0) {
+            client->handoffCooldown--;
+            continue;
+        }
+        
+        // Nobody owns a gap between zones, so a player in one stays here
+        const Vector3D& position = entities.getPosition(client->entity);
+        if (shardMap.distanceOutside(config.shardIndex, position.x) <= HandoffMargin) {
+            continue;
+        }
+        int target = shardMap.findOwner(position.x);
+        if (target != ShardMap::NoShard && peerUp[target] && started < MaxHandoffsPerTick) {
+            beginHandoff(*client, static_cast<unsigned int>(target));
+            started++;
+        }
+    }
+    
+    // Players this shard accepted whose clients never arrived
+    for (auto it = incomingHandoffs.begin(); it != incomingHandoffs.end();) {
+        if (++it->second.ticks >= 2 * timeoutTicks) {
+            it = incomingHandoffs.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void GameServer::beginHandoff(ClientInfo& client, unsigned int target) {
+    sf::Uint32 token = 0;
+    while (token == 0) {
+        token = tokenGenerator();
+    }
+    client.handoffToken = token;
+    client.handoffTarget = target;
+    client.redirected = false;
+    client.handoffTicks = 0;
+    
+    // [HANDOFF][token][position][name]
+    char buffer[64 + MaxPlayerNameLength];
+    WireWriter writer(buffer, sizeof(buffer));
+    writer.writeByte(static_cast<sf::Uint8>(ShardPacket::HANDOFF));
+    writer.writeUInt32(token);
+    Field::Position::write(writer, entities.getPosition(client.entity));
+    Field::Text::write(writer, client.name);
+    sf::Packet packet;
+    packet.append(buffer, writer.getSize());
+    shardLink.send(target, std::move(packet));
+}
+
+void GameServer::cancelHandoff(ClientInfo& client, const char* reason) {
+    std::cout << "Handoff of client " << client.id << " to shard " << client.handoffTarget << " "
+              << reason << "; retrying in " << HandoffRetryDelay << "s" << std::endl;
+    client.handoffToken = 0;
+    client.redirected = false;
+    client.handoffCooldown = HandoffRetryDelay * scheduler.getTickRate();
+    metrics.recordHandoffFailure();
+}
+
+void GameServer::handleResume(ClientInfo& client, sf::Uint32 token) {
+    auto found = incomingHandoffs.find(token);
+    if (found == incomingHandoffs.end()) {
+        return;
+    }
+    IncomingHandoff handoff = std::move(found->second);
+    incomingHandoffs.erase(found);
+    
+    // Saved state under the name is loaded as for a LOGIN, but the position
+    // the player had at the border wins
+    client.name = handoff.name;
+    if (!handoff.name.empty()) {
+        handleLogin(client, handoff.name);
+    }
+    Vector3D& position = entities.getPosition(client.entity);
+    position = handoff.position;
+    interest.moveEntity(client.id, position);
+    if (client.playerId != 0) {
+        journal.setPosition(client.playerId, position);
+    }
+    
+    metrics.recordHandoff(false);
+    std::cout << "Client " << client.id << " arrived from another shard" << std::endl;
+}
+
+void GameServer::sendGhosts(unsigned int peer) {
+    // Entities within sight of the peer's zone, sent when they first come
+    // near or move; redirected players have left and are removed at once
+    ghostUpdates.clear();
+    for (auto& client : clients) {
+        if (client->connected && !client->redirected) {
+            noteGhost(peer, client->id, entities.getPosition(client->entity));
+        } else if (ghostedTo[peer].erase(client->id) > 0) {
+            ghostRemovals[peer].push_back(client->id);
+        }
+    }
+    for (const auto& npc : npcs) {
+        noteGhost(peer, npc.id, entities.getPosition(npc.entity));
+    }
+    
+    std::vector<sf::Uint32>& removals = ghostRemovals[peer];
+    if (ghostUpdates.empty() && removals.empty()) {
+        return;
+    }
+    
+    // [GHOSTS][count][entity, position...][count][entity...]
+    shardBuffer.resize(32 + ghostUpdates.size() * 17 + removals.size() * 5);
+    WireWriter writer(shardBuffer.data(), shardBuffer.size());
+    writer.writeByte(static_cast<sf::Uint8>(ShardPacket::GHOSTS));
+    writer.writeVarUInt(ghostUpdates.size());
+    for (const auto& [entityId, position] : ghostUpdates) {
+        writer.writeVarUInt(entityId);
+        Field::Position::write(writer, position);
+    }
+    writer.writeVarUInt(removals.size());
+    for (sf::Uint32 entityId : removals) {
+        writer.writeVarUInt(entityId);
+    }
+    removals.clear();
+    
+    if (writer.finish()) {
+        sf::Packet packet;
+        packet.append(shardBuffer.data(), writer.getSize());
+        shardLink.send(peer, std::move(packet));
+    }
+}
+
+void GameServer::noteGhost(unsigned int peer, sf::Uint32 entityId, const Vector3D& position) {
+    std::unordered_set<sf::Uint32>& ghosted = ghostedTo[peer];
+    if (shardMap.distanceOutside(peer, position.x) <= config.interestRadius) {
+        if (ghosted.insert(entityId).second || interest.hasMoved(entityId)) {
+            ghostUpdates.emplace_back(entityId, position);
+        }
+    } else if (ghosted.erase(entityId) > 0) {
+        ghostRemovals[peer].push_back(entityId);
+    }
+}
+
+void GameServer::handlePacket(ClientInfo& client, std::string_view bytes) {
+    // Decode straight from the arena copy; text fields stay views into it
+    WireReader reader(bytes.data(), bytes.size());
+    PacketType type = NetworkProtocol::getPacketType(bytes.data(), bytes.size());
+    
+    switch (type) {
+        case PacketType::MOVE: {
+            sf::Uint32 entityId;
+            Direction dir;
+            if (Messages::Move::decode(reader, dir, entityId)) {
+                pendingMoves.push_back({client.id, dir});
+            }
+            break;
+        }
+        case PacketType::CHAT: {
+            ChatChannel channel;
+            sf::Uint32 peer;
+            std::string_view text;
+            if (Messages::Chat::decode(reader, channel, peer, text) && channel < ChatChannel::COUNT) {
+                handleChat(client, channel, peer, text);
+            }
+            break;
+        }
+        case PacketType::CHAT_SUBSCRIBE: {
+            ChatChannel channel;
+            sf::Uint32 topic;
+            sf::Uint32 join;
+            if (Messages::ChatSubscribe::decode(reader, channel, topic, join) && join <= 1) {
+                chat.subscribe(client, channel, topic, join == 1);
+            }
+            break;
+        }
+        case PacketType::SNAPSHOT_ACK: {
+            sf::Uint32 sequence;
+            if (Messages::SnapshotAck::decode(reader, sequence) &&
+                sequence > client.ackedSnapshot && sequence < client.nextSnapshotSequence) {
+                client.ackedSnapshot = sequence;
+            }
+            break;
+        }
+        case PacketType::LOGIN: {
+            std::string_view playerName;
+            if (Messages::Login::decode(reader, playerName)) {
+                handleLogin(client, std::string(playerName));
+            }
+            break;
+        }
+        case PacketType::RESUME: {
+            sf::Uint32 token;
+            if (Messages::Resume::decode(reader, token)) {
+                handleResume(client, token);
+            }
+            break;
+        }
+        case PacketType::SCRIPT_EVENT: {
+            std::string_view eventName;
+            if (Messages::ScriptEvent::decode(reader, eventName)) {
+                handleScriptEvent(client, eventName);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void GameServer::handleLogin(ClientInfo& client, const std::string& playerName) {
+    if (!journal.isOpen() || client.playerId != 0 || playerName.empty() ||
+        playerName.size() > MaxPlayerNameLength) {
+        return;
+    }
+    
+    // One session per player; a second login under the same name stays anonymous
+    sf::Uint32 playerId = journal.findPlayer(playerName);
+    for (auto& other : clients) {
+        if (other->connected && playerId != 0 && other->playerId == playerId) {
+            std::cout << "Client " << client.id << " rejected as " << playerName
+                      << ": already logged in" << std::endl;
+            return;
+        }
+    }
+    
+    if (playerId == 0) {
+        playerId = journal.createPlayer(playerName, entities.getPosition(client.entity));
+        std::cout << "Client " << client.id << " is new player " << playerName << std::endl;
+    } else {
+        // Observers and the player itself are told by updateInterest()
+        Vector3D& position = entities.getPosition(client.entity);
+        position = journal.getPlayer(playerId)->position;
+        interest.moveEntity(client.id, position);
+        std::cout << "Client " << client.id << " resumed " << playerName << std::endl;
+    }
+    
+    client.playerId = playerId;
+    client.name = playerName;
+}
+
+void GameServer::handleChat(ClientInfo& client, ChatChannel channel, sf::Uint32 peer, std::string_view text) {
+    if (!chat.allowMessage(client, scheduler.getTickCount())) {
+        metrics.recordChatRateLimited();
+        return;
+    }
+    
+    // Encoded once with the sender filled in; every recipient's outbox shares it
+    WireBufferPtr message = WireBuffer::encode(
+        NetworkProtocol::createChatPacket(channel, client.id, std::string(text)));
+    size_t delivered = 0;
+    
+    switch (channel) {
+        case ChatChannel::GLOBAL:
+            delivered = deliverChat(channel, 0, message);
+            
+            // Other shards fan it out to their own subscribers
+            if (isSharded()) {
+                char buffer[MaxMessageSize + 16];
+                WireWriter writer(buffer, sizeof(buffer));
+                writer.writeByte(static_cast<sf::Uint8>(ShardPacket::CHAT));
+                writer.writeVarUInt(client.id);
+                Field::Text::write(writer, text.substr(0, MaxMessageSize - 16));
+                for (unsigned int shard = 0; shard < shardMap.size(); shard++) {
+                    if (peerUp[shard]) {
+                        sf::Packet packet;
+                        packet.append(buffer, writer.getSize());
+                        shardLink.send(shard, std::move(packet));
+                    }
+                }
+            }
+            break;
+        case ChatChannel::ZONE:
+            delivered = deliverChat(channel, 0, message);
+            break;
+        case ChatChannel::PARTY:
+            // Only members may talk to a party
+            if (chat.isSubscribed(client, channel, peer)) {
+                delivered = deliverChat(channel, peer, message);
+            }
+            break;
+        case ChatChannel::WHISPER: {
+            ClientInfo* recipient = clients.find(peer);
+            if (recipient && recipient->connected) {
+                recipient->outbox.queueMessage(message);
+                client.outbox.queueMessage(message);
+                delivered = 2;
+            }
+            break;
+        }
+        case ChatChannel::PROXIMITY:
+            delivered = deliverProximityChat(client, message);
+            break;
+        default:
+            break;
+    }
+    
+    metrics.recordChat(delivered);
+}
+
+size_t GameServer::deliverChat(ChatChannel channel, sf::Uint32 topic, const WireBufferPtr& message) {
+    size_t delivered = 0;
+    chat.forEachSubscriber(channel, topic, [&message, &delivered](ClientInfo& subscriber) {
+        if (subscriber.connected) {
+            subscriber.outbox.queueMessage(message);
+            delivered++;
+        }
+    });
+    return delivered;
+}
+
+size_t GameServer::deliverProximityChat(ClientInfo& sender, const WireBufferPtr& message) {
+    // The sender's view already holds everyone within the interest radius
+    const Vector3D& origin = entities.getPosition(sender.entity);
+    float radius = std::min(config.chatRadius, interest.getRadius());
+    
+    sender.outbox.queueMessage(message);
+    size_t delivered = 1;
+    for (sf::Uint32 entityId : interest.getVisible(sender.id)) {
+        ClientInfo* listener = clients.find(entityId);
+        if (listener && listener->connected && entities.getPosition(listener->entity).distance(origin) <= radius) {
+            listener->outbox.queueMessage(message);
+            delivered++;
+        }
+    }
+    return delivered;
+}
+
+void GameServer::updateInterest() {
+    for (auto& client : clients) {
+        if (!client->connected) {
+            continue;
+        }
+        
+        interest.update(client->id, entities.getPosition(client->entity), viewChanges);
+        
+        if (config.snapshotMode) {
+            // Skipped snapshots are harmless: the next one is a delta against
+            // whatever the client last acknowledged
+            if (!client->congested) {
+                sendSnapshot(*client);
+            }
+            continue;
+        }
+        
+        OutboundQueue& outbox = client->outbox;
+        for (sf::Uint32 entityId : viewChanges.entered) {
+            outbox.queueSpawn(entityId, encodeSpawn(entityId));
+        }
+        for (sf::Uint32 entityId : viewChanges.left) {
+            outbox.queueRemove(entityId, encodeRemove(entityId));
+            client->unackedPositions.erase(entityId);
+        }
+        
+        // Once the client's UDP endpoint is known, positions go by datagram
+        // so a lost update never holds up the reliable stream
+        bool useDatagrams = client->udpBound;
+        
+        // A client that is behind on TCP gets no position updates it would
+        // only read late; ordered messages (spawns, removes, chat) still go
+        if (client->congested && !useDatagrams) {
+            metrics.recordBackpressureDropped(viewChanges.moved.size() +
+                                              (interest.hasMoved(client->id) ? 1 : 0));
+            continue;
+        }
+        if (client->resyncPositions) {
+            client->resyncPositions = false;
+            if (!useDatagrams) {
+                queueVisiblePositions(*client);
+            }
+        }
+        
+        for (sf::Uint32 entityId : viewChanges.moved) {
+            if (useDatagrams) {
+                client->unackedPositions[entityId] = 0;
+            } else {
+                outbox.queuePosition(entityId, encodePosition(entityId));
+            }
+        }
+        
+        // Players always get their own authoritative position back
+        if (interest.hasMoved(client->id)) {
+            if (useDatagrams) {
+                client->unackedPositions[client->id] = 0;
+            } else {
+                outbox.queuePosition(client->id, encodePosition(client->id));
+            }
+        }
+    }
+}
+
+void GameServer::queueVisiblePositions(ClientInfo& client) {
+    // Positions dropped while the client was congested are resent in full
+    for (sf::Uint32 entityId : interest.getVisible(client.id)) {
+        client.outbox.queuePosition(entityId, encodePosition(entityId));
+    }
+    client.outbox.queuePosition(client.id, encodePosition(client.id));
+}
+
+void GameServer::sendSnapshot(ClientInfo& client) {
+    // Everything the client can see, plus its own authoritative position
+    currentSnapshot.sequence = client.nextSnapshotSequence;
+    currentSnapshot.entities.clear();
+    const Vector3D& position = entities.getPosition(client.entity);
+    bool addedSelf = false;
+    for (sf::Uint32 entityId : interest.getVisible(client.id)) {
+        if (!addedSelf && client.id < entityId) {
+            currentSnapshot.add(client.id, position);
+            addedSelf = true;
+        }
+        currentSnapshot.add(entityId, *interest.getPosition(entityId));
+    }
+    if (!addedSelf) {
+        currentSnapshot.add(client.id, position);
+    }
+    
+    // TCP delivers everything, so nothing needs sending if the client's
+    // latest snapshot already matches
+    const Snapshot* lastSent = client.sentSnapshots.find(client.nextSnapshotSequence - 1);
+    if (lastSent && lastSent->entities.size() == currentSnapshot.entities.size() &&
+        std::equal(lastSent->entities.begin(), lastSent->entities.end(),
+                   currentSnapshot.entities.begin(),
+                   [](const SnapshotEntity& a, const SnapshotEntity& b) {
+                       return a.entityId == b.entityId && a.samePosition(b);
+                   })) {
+        return;
+    }
+    
+    // Delta against the newest snapshot the client confirmed; if that has
+    // fallen out of the history, the empty baseline makes this a full snapshot
+    static const Snapshot emptyBaseline;
+    const Snapshot* baseline = client.sentSnapshots.find(client.ackedSnapshot);
+    if (!baseline) {
+        baseline = &emptyBaseline;
+    }
+    
+    snapshotBuffer.resize(SnapshotCodec::maxEncodedSize(*baseline, currentSnapshot));
+    WireWriter writer(snapshotBuffer.data(), snapshotBuffer.size());
+    if (!SnapshotCodec::encode(writer, *baseline, currentSnapshot)) {
+        return;
+    }
+    
+    client.outbox.queueMessage(WireBuffer::frame(snapshotBuffer.data(), writer.getSize()));
+    client.sentSnapshots.store(currentSnapshot);
+    client.nextSnapshotSequence++;
+}
+
+void GameServer::handleScriptEvent(ClientInfo& client, std::string_view eventName) {
+    // Clients may only raise a script's events: not its Functions, and not
+    // natives such as Print
+    if (!scriptEngine.isEvent(eventName)) {
+        metrics.recordScriptEventRejected();
+        return;
+    }
+    sf::Uint64 tick = scheduler.getTickCount();
+    if (tick < client.nextScriptEventTick) {
+        metrics.recordScriptEventRateLimited();
+        return;
+    }
+    client.nextScriptEventTick = tick + std::max(1u, config.tickRate / ScriptEventsPerSecond);
+    metrics.recordScriptEvent();
+    pendingScriptEvents.push_back(eventName);
+}
+
+void GameServer::dispatchScriptEvents() {
+    for (const auto& eventName : pendingScriptEvents) {
+        scriptEngine.executeFunction(eventName);
+    }
+    pendingScriptEvents.clear();
+}
+
+void GameServer::disconnectClient(ClientInfo& client) {
+    std::cout << "Client " << client.id << " disconnected" << std::endl;
+    if (client.socket) {
+        poller.remove(client.id, *client.socket);
+        client.socket->disconnect();
+    }
+    
+    // Reaped from the table at the next tick boundary
+    client.connected = false;
+}
+
+WireBufferPtr GameServer::encodeSpawn(sf::Uint32 entityId) {
+    WireBufferPtr& cached = spawnCache[entityId];
+    if (!cached) {
+        cached = WireBuffer::encode(NetworkProtocol::createSpawnPacket(
+            entityId, *interest.getPosition(entityId)));
+    }
+    return cached;
+}
+
+WireBufferPtr GameServer::encodeRemove(sf::Uint32 entityId) {
+    WireBufferPtr& cached = removeCache[entityId];
+    if (!cached) {
+        cached = WireBuffer::encode(NetworkProtocol::createRemovePacket(entityId));
+    }
+    return cached;
+}
+
+WireBufferPtr GameServer::encodePosition(sf::Uint32 entityId) {
+    WireBufferPtr& cached = positionCache[entityId];
+    if (!cached) {
+        cached = WireBuffer::encode(NetworkProtocol::createPositionPacket(
+            entityId, *interest.getPosition(entityId)));
+    }
+    return cached;
+}
+
+void GameServer::sendPacket(sf::Uint32 clientId, const sf::Packet& packet) {
+    ClientInfo* client = clients.find(clientId);
+    if (client && client->connected) {
+        client->outbox.queueMessage(WireBuffer::encode(packet));
+    }
 }
 
 void GameServer::broadcastPacket(const sf::Packet& packet, sf::Uint32 excludeClient) {
+    // Encode once; every recipient shares the same buffer
+    WireBufferPtr message = WireBuffer::encode(packet);
+    for (auto& client : clients) {
+        if (client->id != excludeClient && client->connected) {
+            client->outbox.queueMessage(message);
+        }
+    }
+}
+
+void GameServer::flushOutbound() {
+    // One frame per client per tick, however many messages were queued for it
     for (auto& client : clients) {
-        if (client.first != excludeClient && client.second->socket) {
-            sf::Packet packetCopy = packet;
-            client.second->socket->send(packetCopy);
+        if (!client->outbox.empty()) {
+            recordOutbox(client->outbox);
+            client->outbox.writeTo(client->sendQueue);
+        }
+        
+        // Even an outbox whose positions were all dropped may hold arena memory
+        client->outbox.clear();
+        
+        if (!client->connected) {
+            continue;
+        }
+        
+        if (!client->unackedPositions.empty()) {
+            sendPositionDatagrams(*client);
+        }
+        
+        if (client->sendQueue.empty()) {
+            continue;
+        }
+        
+        // A replayed session's frames were encoded like any other; there is nowhere to send them
+        if (!client->socket) {
+            client->sendQueue.clear();
+            continue;
+        }
+        
+        // Whatever the socket doesn't take now stays queued for the next tick
+        sf::Socket::Status status = client->sendQueue.flush(*client->socket);
+        metrics.recordSendQueue(client->sendQueue.getPendingBytes());
+        if (status == sf::Socket::Disconnected || status == sf::Socket::Error) {
+            disconnectClient(*client);
+            continue;
+        }
+        
+        updateBackpressure(*client);
+    }
+    
+    TickArena::release(spawnCache);
+    TickArena::release(removeCache);
+    TickArena::release(positionCache);
+}
+
+void GameServer::updateBackpressure(ClientInfo& client) {
+    size_t pending = client.sendQueue.getPendingBytes();
+    
+    if (pending >= config.sendBufferLimit) {
+        std::cout << "Client " << client.id << " evicted: " << pending << " bytes unsent" << std::endl;
+        metrics.recordEviction();
+        disconnectClient(client);
+        return;
+    }
+    
+    if (!client.congested) {
+        if (pending > config.sendHighWatermark) {
+            client.congested = true;
+            client.congestedTicks = 0;
+            metrics.recordCongested();
+            std::cout << "Client " << client.id << " is falling behind (" << pending
+                      << " bytes unsent); dropping its position updates" << std::endl;
+        }
+        return;
+    }
+    
+    // Hysteresis: updates resume only once most of the backlog has drained
+    if (pending <= config.sendLowWatermark) {
+        client.congested = false;
+        client.resyncPositions = true;
+        return;
+    }
+    
+    metrics.recordCongested();
+    client.congestedTicks++;
+    if (config.slowClientTimeout > 0 &&
+        client.congestedTicks >= config.slowClientTimeout * scheduler.getTickRate()) {
+        std::cout << "Client " << client.id << " evicted: over the high watermark for "
+                  << config.slowClientTimeout << "s" << std::endl;
+        metrics.recordEviction();
+        disconnectClient(client);
+    }
+}
+
+void GameServer::recordOutbox(const OutboundQueue& outbox) {
+    // Each message starts with its 4-byte length, then the type byte
+    outbox.forEachMessage([this](const WireBuffer& message) {
+        metrics.recordSent(NetworkProtocol::getPacketType(message.getData() + 4, message.getSize() - 4),
+                           message.getSize());
+    });
+    if (outbox.getMessageCount() > 1) {
+        metrics.recordSent(PacketType::BATCH, OutboundQueue::BatchHeaderSize);
+    }
+    metrics.recordCoalesced(outbox.getCoalescedCount());
+}
+
+void GameServer::sendPositionDatagrams(ClientInfo& client) {
+    // An UPDATE_POSITION is at most 18 bytes, so this many fit in one datagram
+    const size_t PositionsPerDatagram = 64;
+    
+    // Every unacknowledged position is repeated, with its current value,
+    // until a datagram carrying it is acknowledged
+    datagramPositions.clear();
+    for (auto it = client.unackedPositions.begin(); it != client.unackedPositions.end();) {
+        if (interest.getPosition(it->first)) {
+            datagramPositions.push_back(it->first);
+            ++it;
+        } else {
+            it = client.unackedPositions.erase(it);
+        }
+    }
+    
+    for (size_t start = 0; start < datagramPositions.size(); start += PositionsPerDatagram) {
+        size_t count = std::min(PositionsPerDatagram, datagramPositions.size() - start);
+        
+        // [channel header][count][UPDATE_POSITION...]
+        char buffer[MaxDatagramSize];
+        WireWriter writer(buffer, sizeof(buffer));
+        sf::Uint16 sequence = client.datagrams.writeHeader(writer);
+        writer.writeVarUInt(count);
+        for (size_t i = start; i < start + count; i++) {
+            sf::Uint32 entityId = datagramPositions[i];
+            Messages::UpdatePosition::encode(writer, entityId, *interest.getPosition(entityId));
+            client.unackedPositions[entityId] = sequence;
+        }
+        
+        if (writer.finish()) {
+            udpSocket.sendDatagram(buffer, writer.getSize(), client.udpAddress, client.udpPort);
+            metrics.recordDatagramSent(writer.getSize());
         }
     }
 }
@@ -0,0 +1,212 @@
+#include "InterestManager.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace IsometricMUD {
+
+namespace {
+
+// Cell coordinates are packed into 21 bits per axis
+const int CellBits = 21;
+const int CellBias = 1 << (CellBits - 1);
+const sf::Uint64 CellMask = (1ULL << CellBits) - 1;
+
+float distanceSquared(const Vector3D& a, const Vector3D& b) {
+    float dx = a.x - b.x;
+    float dy = a.y - b.y;
+    float dz = a.z - b.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+} // namespace
+
+SpatialGrid::SpatialGrid(float size) : cellSize(size > 0.0f ? size : 1.0f) {
+}
+
+int SpatialGrid::toCell(float coordinate) const {
+    return static_cast<int>(std::floor(coordinate / cellSize));
+}
+
+sf::Uint64 SpatialGrid::cellKey(int cx, int cy, int cz) const {
+    return ((static_cast<sf::Uint64>(cx + CellBias) & CellMask) << (CellBits * 2)) |
+           ((static_cast<sf::Uint64>(cy + CellBias) & CellMask) << CellBits) |
+           (static_cast<sf::Uint64>(cz + CellBias) & CellMask);
+}
+
+sf::Uint64 SpatialGrid::cellOf(const Vector3D& position) const {
+    return cellKey(toCell(position.x), toCell(position.y), toCell(position.z));
+}
+
+void SpatialGrid::insert(sf::Uint32 entityId, const Vector3D& position) {
+    if (entries.count(entityId)) {
+        move(entityId, position);
+        return;
+    }
+    sf::Uint64 cell = cellOf(position);
+    entries[entityId] = {cell, position};
+    cells[cell].push_back(entityId);
+}
+
+void SpatialGrid::move(sf::Uint32 entityId, const Vector3D& position) {
+    auto it = entries.find(entityId);
+    if (it == entries.end()) {
+        insert(entityId, position);
+        return;
+    }
+    
+    it->second.position = position;
+    sf::Uint64 cell = cellOf(position);
+    if (cell != it->second.cell) {
+        unlink(it->second.cell, entityId);
+        it->second.cell = cell;
+        cells[cell].push_back(entityId);
+    }
+}
+
+void SpatialGrid::remove(sf::Uint32 entityId) {
+    auto it = entries.find(entityId);
+    if (it == entries.end()) {
+        return;
+    }
+    unlink(it->second.cell, entityId);
+    entries.erase(it);
+}
+
+void SpatialGrid::unlink(sf::Uint64 cell, sf::Uint32 entityId) {
+    auto cellIt = cells.find(cell);
+    if (cellIt == cells.end()) {
+        return;
+    }
+    
+    auto& members = cellIt->second;
+    auto member = std::find(members.begin(), members.end(), entityId);
+    if (member != members.end()) {
+        *member = members.back();
+        members.pop_back();
+    }
+    if (members.empty()) {
+        cells.erase(cellIt);
+    }
+}
+
+void SpatialGrid::queryRadius(const Vector3D& center, float radius, std::vector<sf::Uint32>& out) const {
+    const float radiusSquared = radius * radius;
+    
+    int minX = toCell(center.x - radius), maxX = toCell(center.x + radius);
+    int minY = toCell(center.y - radius), maxY = toCell(center.y + radius);
+    int minZ = toCell(center.z - radius), maxZ = toCell(center.z + radius);
+    
+    for (int cx = minX; cx <= maxX; cx++) {
+        for (int cy = minY; cy <= maxY; cy++) {
+            for (int cz = minZ; cz <= maxZ; cz++) {
+                auto cellIt = cells.find(cellKey(cx, cy, cz));
+                if (cellIt == cells.end()) {
+                    continue;
+                }
+                for (sf::Uint32 entityId : cellIt->second) {
+                    const Entry& entry = entries.at(entityId);
+                    if (distanceSquared(entry.position, center) <= radiusSquared) {
+                        out.push_back(entityId);
+                    }
+                }
+            }
+        }
+    }
+}
+
+InterestManager::InterestManager(float viewRadius, float cellSize)
+    : radius(viewRadius), grid(cellSize), currentTick(1) {
+}
+
+void InterestManager::addEntity(sf::Uint32 entityId, const Vector3D& position) {
+    entities[entityId] = {position, 0};
+    grid.insert(entityId, position);
+}
+
+void InterestManager::moveEntity(sf::Uint32 entityId, const Vector3D& position) {
+    auto it = entities.find(entityId);
+    if (it == entities.end()) {
+        addEntity(entityId, position);
+        return;
+    }
+    it->second.position = position;
+    it->second.movedTick = currentTick;
+    grid.move(entityId, position);
+}
+
+void InterestManager::removeEntity(sf::Uint32 entityId) {
+    entities.erase(entityId);
+    grid.remove(entityId);
+}
+
+void InterestManager::removeObserver(sf::Uint32 observerId) {
+    visibleSets.erase(observerId);
+}
+
+void InterestManager::beginTick() {
+    currentTick++;
+}
+
+bool InterestManager::hasMoved(sf::Uint32 entityId) const {
+    auto it = entities.find(entityId);
+    return it != entities.end() && it->second.movedTick == currentTick;
+}
+
+const Vector3D* InterestManager::getPosition(sf::Uint32 entityId) const {
+    auto it = entities.find(entityId);
+    return it != entities.end() ? &it->second.position : nullptr;
+}
+
+const std::vector<sf::Uint32>& InterestManager::getVisible(sf::Uint32 observerId) const {
+    static const std::vector<sf::Uint32> empty;
+    auto it = visibleSets.find(observerId);
+    return it != visibleSets.end() ? it->second : empty;
+}
+
+void InterestManager::update(sf::Uint32 observerId, const Vector3D& observerPosition, ViewChanges& changes) {
+    changes.clear();
+    
+    std::vector<sf::Uint32>& previous = visibleSets[observerId];
+    const float enterRadiusSquared = radius * radius;
+    
+    // Query out to the leave radius: entities between the two radii stay
+    // visible only if they already were
+    scratch.clear();
+    grid.queryRadius(observerPosition, radius * LeaveHysteresis, scratch);
+    
+    std::vector<sf::Uint32>& current = visibleScratch;
+    current.clear();
+    for (sf::Uint32 entityId : scratch) {
+        if (entityId == observerId) {
+            continue;
+        }
+        const EntityState& state = entities.at(entityId);
+        if (distanceSquared(state.position, observerPosition) <= enterRadiusSquared ||
+            std::binary_search(previous.begin(), previous.end(), entityId)) {
+            current.push_back(entityId);
+        }
+    }
+    std::sort(current.begin(), current.end());
+    
+    std::set_difference(current.begin(), current.end(), previous.begin(), previous.end(),
+                        std::back_inserter(changes.entered));
+    std::set_difference(previous.begin(), previous.end(), current.begin(), current.end(),
+                        std::back_inserter(changes.left));
+    
+    // Entities that just entered are sent in full, so only report moves for
+    // entities the observer already knew about
+    auto prevIt = previous.begin();
+    for (sf::Uint32 entityId : current) {
+        while (prevIt != previous.end() && *prevIt < entityId) {
+            ++prevIt;
+        }
+        if (prevIt != previous.end() && *prevIt == entityId && hasMoved(entityId)) {
+            changes.moved.push_back(entityId);
+        }
+    }
+    
+    previous.swap(current);
+}
+
+} // namespace IsometricMUD
@@ -0,0 +1,135 @@
+#include "MetricsRegistry.hpp"
+#include <array>
+#include <cstdlib>
+
+namespace IsometricMUD {
+
+namespace {
+
+// Exported bucket bounds, in exported units (seconds for durations)
+const std::array<const char*, 14> ExportBounds = {
+    "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005", "0.01",
+    "0.025", "0.05", "0.1", "0.25", "0.5", "1", "2.5"
+};
+
+std::string withLabels(const std::string& labels, const std::string& extra) {
+    if (labels.empty() && extra.empty()) {
+        return "";
+    }
+    if (labels.empty()) {
+        return "{" + extra + "}";
+    }
+    if (extra.empty()) {
+        return "{" + labels + "}";
+    }
+    return "{" + labels + "," + extra + "}";
+}
+
+} // namespace
+
+const char* MetricsRegistry::getTypeName(MetricType type) {
+    switch (type) {
+        case MetricType::COUNTER:
+            return "counter";
+        case MetricType::GAUGE:
+            return "gauge";
+        default:
+            return "histogram";
+    }
+}
+
+Counter& MetricsRegistry::addCounter(const std::string& name, const std::string& help,
+                                     const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.emplace_back();
+    Series series;
+    series.labels = labels;
+    series.counter = &counters.back();
+    getFamily(name, help, MetricType::COUNTER).series.push_back(series);
+    return counters.back();
+}
+
+Gauge& MetricsRegistry::addGauge(const std::string& name, const std::string& help,
+                                 const std::string& labels) {
+    std::lock_guard<std::mutex> lock(mutex);
+    gauges.emplace_back();
+    Series series;
+    series.labels = labels;
+    series.gauge = &gauges.back();
+    getFamily(name, help, MetricType::GAUGE).series.push_back(series);
+    return gauges.back();
+}
+
+void MetricsRegistry::addHistogram(const std::string& name, const std::string& help,
+                                   const std::string& labels, const Histogram& histogram,
+                                   double unitScale) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Series series;
+    series.labels = labels;
+    series.histogram = &histogram;
+    series.unitScale = unitScale;
+    getFamily(name, help, MetricType::HISTOGRAM).series.push_back(series);
+}
+
+MetricsRegistry::Family& MetricsRegistry::getFamily(const std::string& name, const std::string& help,
+                                                    MetricType type) {
+    for (auto& family : families) {
+        if (family.name == name) {
+            return family;
+        }
+    }
+    families.push_back({name, help, type, {}});
+    return families.back();
+}
+
+void MetricsRegistry::writePrometheus(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    for (const auto& family : families) {
+        out << "# HELP " << family.name << " " << family.help << "\n";
+        out << "# TYPE " << family.name << " " << getTypeName(family.type) << "\n";
+        
+        for (const auto& series : family.series) {
+            if (series.counter) {
+                out << family.name << withLabels(series.labels, "") << " " << series.counter->get() << "\n";
+            } else if (series.gauge) {
+                out << family.name << withLabels(series.labels, "") << " " << series.gauge->get() << "\n";
+            } else if (series.histogram) {
+                writeHistogram(out, family.name, series);
+            }
+        }
+    }
+}
+
+void MetricsRegistry::writeHistogram(std::ostream& out, const std::string& name, const Series& series) {
+    const Histogram& histogram = *series.histogram;
+    
+    // Fold the fine-grained internal buckets into the exported bounds in one
+    // pass; an internal bucket counts towards a bound only if it lies wholly
+    // below it, so each exported bucket is exact to within about 6%
+    std::uint64_t cumulative = 0;
+    int bucket = 0;
+    for (const char* bound : ExportBounds) {
+        double limit = std::atof(bound) / series.unitScale;
+        while (bucket < Histogram::BucketCount &&
+               static_cast<double>(Histogram::bucketUpperBound(bucket)) <= limit) {
+            cumulative += histogram.getBucketCount(bucket);
+            bucket++;
+        }
+        out << name << "_bucket" << withLabels(series.labels, std::string("le=\"") + bound + "\"")
+            << " " << cumulative << "\n";
+    }
+    
+    // Sample by sample the buckets and the count may disagree mid-update;
+    // +Inf must never be below a finite bucket
+    std::uint64_t count = histogram.getCount();
+    if (count < cumulative) {
+        count = cumulative;
+    }
+    out << name << "_bucket" << withLabels(series.labels, "le=\"+Inf\"") << " " << count << "\n";
+    out << name << "_sum" << withLabels(series.labels, "") << " "
+        << static_cast<double>(histogram.getSum()) * series.unitScale << "\n";
+    out << name << "_count" << withLabels(series.labels, "") << " " << count << "\n";
+}
+
+} // namespace IsometricMUD
@@ -0,0 +1,127 @@
+#include "MetricsServer.hpp"
+#include <iostream>
+#include <sstream>
+
+namespace IsometricMUD {
+
+namespace {
+
+// How often the serving thread checks whether it should stop
+const sf::Time PollInterval = sf::milliseconds(200);
+
+// A scraper gets this long to send its request line and headers
+const sf::Time RequestTimeout = sf::seconds(2.0f);
+
+const size_t MaxRequestSize = 8192;
+
+void sendResponse(sf::TcpSocket& socket, const char* status, const char* contentType,
+                  const std::string& body) {
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n"
+             << "Content-Type: " << contentType << "\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    std::string bytes = response.str();
+    socket.send(bytes.data(), bytes.size());
+}
+
+} // namespace
+
+MetricsServer::MetricsServer(const MetricsRegistry& metricsRegistry)
+    : registry(metricsRegistry), running(false) {
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(unsigned short port) {
+    // Loopback only: the admin port is for a local scraper or sidecar
+    if (listener.listen(port, sf::IpAddress::LocalHost) != sf::Socket::Done) {
+        std::cerr << "Error: Could not bind admin port " << port << std::endl;
+        return false;
+    }
+    listener.setBlocking(false);
+    
+    running = true;
+    thread = std::thread(&MetricsServer::serve, this);
+    std::cout << "Metrics on http://127.0.0.1:" << port << "/metrics" << std::endl;
+    return true;
+}
+
+void MetricsServer::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    listener.close();
+}
+
+void MetricsServer::serve() {
+    sf::SocketSelector selector;
+    selector.add(listener);
+    
+    while (running) {
+        if (!selector.wait(PollInterval)) {
+            continue;
+        }
+        
+        sf::TcpSocket socket;
+        if (listener.accept(socket) == sf::Socket::Done) {
+            handleConnection(socket);
+            socket.disconnect();
+        }
+    }
+}
+
+void MetricsServer::handleConnection(sf::TcpSocket& socket) {
+    std::string request;
+    if (!readRequest(socket, request)) {
+        return;
+    }
+    
+    // Only the request line matters: "GET /metrics HTTP/1.1"
+    std::istringstream requestLine(request.substr(0, request.find("\r\n")));
+    std::string method;
+    std::string target;
+    requestLine >> method >> target;
+    
+    if (method != "GET") {
+        sendResponse(socket, "405 Method Not Allowed", "text/plain", "GET only\n");
+        return;
+    }
+    if (target != "/metrics" && target.rfind("/metrics?", 0) != 0) {
+        sendResponse(socket, "404 Not Found", "text/plain", "Try /metrics\n");
+        return;
+    }
+    
+    std::ostringstream body;
+    registry.writePrometheus(body);
+    sendResponse(socket, "200 OK", "text/plain; version=0.0.4", body.str());
+}
+
+bool MetricsServer::readRequest(sf::TcpSocket& socket, std::string& request) {
+    sf::SocketSelector selector;
+    selector.add(socket);
+    sf::Clock clock;
+    char buffer[1024];
+    
+    // Headers end at the first blank line; requests carry no body
+    while (request.find("\r\n\r\n") == std::string::npos) {
+        sf::Time remaining = RequestTimeout - clock.getElapsedTime();
+        if (!running || remaining <= sf::Time::Zero || request.size() > MaxRequestSize ||
+            !selector.wait(remaining)) {
+            return false;
+        }
+        
+        std::size_t received = 0;
+        if (socket.receive(buffer, sizeof(buffer), received) != sf::Socket::Done) {
+            return false;
+        }
+        request.append(buffer, received);
+    }
+    return true;
+}
+
+} // namespace IsometricMUD
@@ -0,0 +1,532 @@
+#include "NavGraph.hpp"
+#include <algorithm>
+#include <cstdlib>
+
+namespace IsometricMUD {
+
+namespace {
+
+const int ChunkSize = VoxelGrid::ChunkSize;
+const int ChunkBits = VoxelGrid::ChunkBits;
+const int FaceArea = ChunkSize * ChunkSize;
+const sf::Uint32 NoNode = 0xFFFFFFFF;
+
+struct Step {
+    Direction direction;
+    int dx;
+    int dy;
+    int dz;
+};
+
+// The six moves a player can make; in-chunk searches store an index into this
+const Step Steps[6] = {
+    {Direction::EAST, 1, 0, 0},
+    {Direction::WEST, -1, 0, 0},
+    {Direction::NORTH, 0, 1, 0},
+    {Direction::SOUTH, 0, -1, 0},
+    {Direction::UP, 0, 0, 1},
+    {Direction::DOWN, 0, 0, -1}
+};
+
+int encodeLocal(int x, int y, int z) {
+    return (z << (2 * ChunkBits)) | (y << ChunkBits) | x;
+}
+
+int getDistance(int x1, int y1, int z1, int x2, int y2, int z2) {
+    return std::abs(x1 - x2) + std::abs(y1 - y2) + std::abs(z1 - z2);
+}
+
+} // namespace
+
+NavGraph::SearchScratch::SearchScratch() : searchStamp(0), floodStamp(0) {
+    cellStamp.fill(0);
+}
+
+NavGraph::NavGraph(const VoxelGrid& voxelGrid)
+    : grid(voxelGrid), chunksX(0), chunksY(0), chunksZ(0) {
+}
+
+void NavGraph::build() {
+    chunksX = grid.getSizeX() / ChunkSize;
+    chunksY = grid.getSizeY() / ChunkSize;
+    chunksZ = grid.getSizeZ() / ChunkSize;
+    size_t chunkCount = static_cast<size_t>(chunksX) * chunksY * chunksZ;
+    
+    nodes.clear();
+    freeNodes.clear();
+    chunkNodes.assign(chunkCount, std::vector<sf::Uint32>());
+    
+    // Versions only ever grow, so paths cached against an older graph never match
+    if (chunkVersions.size() != chunkCount) {
+        sf::Uint32 next = 1;
+        for (sf::Uint32 version : chunkVersions) {
+            next = std::max(next, version + 1);
+        }
+        chunkVersions.assign(chunkCount, next);
+    } else {
+        for (sf::Uint32& version : chunkVersions) {
+            version++;
+        }
+    }
+    
+    for (sf::Uint32 chunk = 0; chunk < chunkCount; chunk++) {
+        for (int axis = 0; axis < 3; axis++) {
+            buildEntrances(chunk, axis);
+        }
+    }
+    for (sf::Uint32 chunk = 0; chunk < chunkCount; chunk++) {
+        buildLinks(chunk);
+    }
+}
+
+void NavGraph::updateCell(int x, int y, int z) {
+    sf::Uint32 chunk = getChunkOf(x, y, z);
+    if (chunk != NoChunk) {
+        rebuildChunk(chunk);
+    }
+    
+    // The cell is the headroom of the one below it
+    sf::Uint32 below = getChunkOf(x, y, z - 1);
+    if (below != NoChunk && below != chunk) {
+        rebuildChunk(below);
+    }
+}
+
+void NavGraph::rebuildChunk(sf::Uint32 chunk) {
+    removeChunkPortals(chunk);
+    
+    ChunkCoord coord = getChunkCoord(chunk);
+    sf::Uint32 affected[7];
+    size_t affectedCount = 0;
+    affected[affectedCount++] = chunk;
+    
+    // Entrances on all six faces: as the lower chunk of a pair and as the upper one
+    for (int axis = 0; axis < 3; axis++) {
+        const Step& step = Steps[axis * 2];
+        sf::Uint32 upper = getChunkIndex(coord.x + step.dx, coord.y + step.dy, coord.z + step.dz);
+        sf::Uint32 lower = getChunkIndex(coord.x - step.dx, coord.y - step.dy, coord.z - step.dz);
+        if (upper != NoChunk) {
+            buildEntrances(chunk, axis);
+            affected[affectedCount++] = upper;
+        }
+        if (lower != NoChunk) {
+            buildEntrances(lower, axis);
+            affected[affectedCount++] = lower;
+        }
+    }
+    
+    for (size_t i = 0; i < affectedCount; i++) {
+        buildLinks(affected[i]);
+        chunkVersions[affected[i]]++;
+    }
+}
+
+bool NavGraph::findAbstractPath(int startX, int startY, int startZ, int goalX, int goalY, int goalZ,
+                                SearchScratch& scratch, std::vector<sf::Uint32>& path) const {
+    path.clear();
+    
+    sf::Uint32 startChunk = getChunkOf(startX, startY, startZ);
+    sf::Uint32 goalChunk = getChunkOf(goalX, goalY, goalZ);
+    if (startChunk == NoChunk || goalChunk == NoChunk || !grid.isWalkable(goalX, goalY, goalZ)) {
+        return false;
+    }
+    
+    // Walking inside one chunk needs no portals at all
+    if (startChunk == goalChunk) {
+        int goalCell = getLocalCell(goalChunk, goalX, goalY, goalZ);
+        flood(startChunk, startX, startY, startZ, scratch, goalCell);
+        if (scratch.cellStamp[goalCell] == scratch.floodStamp) {
+            return true;
+        }
+    }
+    
+    // Connect start and goal to the portals of their chunks; moves are
+    // reversible between walkable cells, so flooding out from the goal gives
+    // the distance from each portal to it
+    scratch.startLinks.clear();
+    flood(startChunk, startX, startY, startZ, scratch);
+    for (sf::Uint32 node : chunkNodes[startChunk]) {
+        int cell = getLocalCell(startChunk, nodes[node].x, nodes[node].y, nodes[node].z);
+        if (scratch.cellStamp[cell] == scratch.floodStamp) {
+            scratch.startLinks.push_back({node, scratch.cellDistance[cell]});
+        }
+    }
+    scratch.goalLinks.clear();
+    flood(goalChunk, goalX, goalY, goalZ, scratch);
+    for (sf::Uint32 node : chunkNodes[goalChunk]) {
+        int cell = getLocalCell(goalChunk, nodes[node].x, nodes[node].y, nodes[node].z);
+        if (scratch.cellStamp[cell] == scratch.floodStamp) {
+            scratch.goalLinks.push_back({node, scratch.cellDistance[cell]});
+        }
+    }
+    if (scratch.startLinks.empty() || scratch.goalLinks.empty()) {
+        return false;
+    }
+    
+    // A* over the portals; the goal is an extra node one past the last
+    const sf::Uint32 goalNode = static_cast<sf::Uint32>(nodes.size());
+    if (scratch.visitStamp.size() < nodes.size() + 1) {
+        scratch.visitStamp.resize(nodes.size() + 1, 0);
+        scratch.cost.resize(nodes.size() + 1);
+        scratch.cameFrom.resize(nodes.size() + 1);
+    }
+    const sf::Uint32 stamp = ++scratch.searchStamp;
+    scratch.open.clear();
+    
+    auto estimate = [&](sf::Uint32 node) {
+        return node == goalNode ? 0 : getDistance(nodes[node].x, nodes[node].y, nodes[node].z,
+                                                  goalX, goalY, goalZ);
+    };
+    auto relax = [&](sf::Uint32 node, int cost, sf::Uint32 from) {
+        if (scratch.visitStamp[node] == stamp && scratch.cost[node] <= cost) {
+            return;
+        }
+        scratch.visitStamp[node] = stamp;
+        scratch.cost[node] = cost;
+        scratch.cameFrom[node] = from;
+        scratch.open.push_back({cost + estimate(node), cost, node});
+        std::push_heap(scratch.open.begin(), scratch.open.end());
+    };
+    
+    for (const auto& link : scratch.startLinks) {
+        relax(link.node, link.cost, NoNode);
+    }
+    
+    while (!scratch.open.empty()) {
+        std::pop_heap(scratch.open.begin(), scratch.open.end());
+        SearchScratch::OpenEntry entry = scratch.open.back();
+        scratch.open.pop_back();
+        
+        sf::Uint32 node = entry.node;
+        int cost = entry.cost;
+        if (cost != scratch.cost[node]) {
+            continue;   // Superseded by a cheaper entry
+        }
+        
+        if (node == goalNode) {
+            for (sf::Uint32 step = scratch.cameFrom[goalNode]; step != NoNode; step = scratch.cameFrom[step]) {
+                path.push_back(step);
+            }
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+        
+        for (const auto& edge : nodes[node].edges) {
+            relax(edge.target, cost + edge.cost, node);
+        }
+        if (nodes[node].chunk == goalChunk) {
+            for (const auto& link : scratch.goalLinks) {
+                if (link.node == node) {
+                    relax(goalNode, cost + link.cost, node);
+                    break;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool NavGraph::refinePath(int startX, int startY, int startZ, const std::vector<sf::Uint32>& path,
+                          int goalX, int goalY, int goalZ, SearchScratch& scratch,
+                          std::vector<Direction>& steps) const {
+    steps.clear();
+    int x = startX;
+    int y = startY;
+    int z = startZ;
+    sf::Uint32 previous = NoNode;
+    
+    for (sf::Uint32 nodeId : path) {
+        if (nodeId >= nodes.size() || !nodes[nodeId].alive) {
+            return false;
+        }
+        const Node& node = nodes[nodeId];
+        
+        if (previous == NoNode) {
+            // From the start to the first portal of its chunk
+            if (getChunkOf(x, y, z) != node.chunk ||
+                !appendSegment(node.chunk, x, y, z, node.x, node.y, node.z, scratch, steps)) {
+                return false;
+            }
+        } else if (nodes[previous].partner == nodeId) {
+            // Crossing an entrance: one step between partner portals
+            for (const auto& step : Steps) {
+                if (x + step.dx == node.x && y + step.dy == node.y && z + step.dz == node.z) {
+                    steps.push_back(step.direction);
+                    break;
+                }
+            }
+        } else {
+            // Between portals of one chunk the link already holds its moves
+            const Node& from = nodes[previous];
+            auto edge = std::find_if(from.edges.begin(), from.edges.end(),
+                                     [nodeId](const Edge& candidate) { return candidate.target == nodeId; });
+            if (edge == from.edges.end()) {
+                return false;
+            }
+            for (int i = 0; i < edge->cost; i++) {
+                steps.push_back(Steps[from.stepPool[edge->stepOffset + i]].direction);
+            }
+        }
+        x = node.x;
+        y = node.y;
+        z = node.z;
+        previous = nodeId;
+    }
+    
+    sf::Uint32 goalChunk = getChunkOf(goalX, goalY, goalZ);
+    return goalChunk != NoChunk && getChunkOf(x, y, z) == goalChunk &&
+           appendSegment(goalChunk, x, y, z, goalX, goalY, goalZ, scratch, steps);
+}
+
+sf::Uint32 NavGraph::getChunkOf(int x, int y, int z) const {
+    unsigned int localX = static_cast<unsigned int>(x - grid.getOriginX());
+    unsigned int localY = static_cast<unsigned int>(y - grid.getOriginY());
+    unsigned int localZ = static_cast<unsigned int>(z - grid.getOriginZ());
+    if (localX >= static_cast<unsigned int>(chunksX) * ChunkSize ||
+        localY >= static_cast<unsigned int>(chunksY) * ChunkSize ||
+        localZ >= static_cast<unsigned int>(chunksZ) * ChunkSize) {
+        return NoChunk;
+    }
+    return getChunkIndex(static_cast<int>(localX >> ChunkBits), static_cast<int>(localY >> ChunkBits),
+                         static_cast<int>(localZ >> ChunkBits));
+}
+
+NavGraph::ChunkCoord NavGraph::getChunkCoord(sf::Uint32 chunk) const {
+    ChunkCoord coord;
+    coord.x = static_cast<int>(chunk % chunksX);
+    coord.y = static_cast<int>((chunk / chunksX) % chunksY);
+    coord.z = static_cast<int>(chunk / chunksX / chunksY);
+    return coord;
+}
+
+sf::Uint32 NavGraph::getChunkIndex(int chunkX, int chunkY, int chunkZ) const {
+    if (chunkX < 0 || chunkY < 0 || chunkZ < 0 || chunkX >= chunksX || chunkY >= chunksY || chunkZ >= chunksZ) {
+        return NoChunk;
+    }
+    return static_cast<sf::Uint32>((chunkZ * chunksY + chunkY) * chunksX + chunkX);
+}
+
+sf::Uint32 NavGraph::createNode(int x, int y, int z, sf::Uint32 chunk) {
+    sf::Uint32 id;
+    if (!freeNodes.empty()) {
+        id = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        id = static_cast<sf::Uint32>(nodes.size());
+        nodes.emplace_back();
+    }
+    
+    Node& node = nodes[id];
+    node.x = x;
+    node.y = y;
+    node.z = z;
+    node.chunk = chunk;
+    node.partner = NoNode;
+    node.alive = true;
+    node.edges.clear();
+    chunkNodes[chunk].push_back(id);
+    return id;
+}
+
+void NavGraph::removeChunkPortals(sf::Uint32 chunk) {
+    for (sf::Uint32 id : chunkNodes[chunk]) {
+        // Every portal comes with a partner across the boundary; it goes too
+        Node& partner = nodes[nodes[id].partner];
+        auto& partnerList = chunkNodes[partner.chunk];
+        partnerList.erase(std::remove(partnerList.begin(), partnerList.end(), nodes[id].partner),
+                          partnerList.end());
+        partner.alive = false;
+        partner.edges.clear();
+        freeNodes.push_back(nodes[id].partner);
+        
+        nodes[id].alive = false;
+        nodes[id].edges.clear();
+        freeNodes.push_back(id);
+    }
+    chunkNodes[chunk].clear();
+}
+
+void NavGraph::buildEntrances(sf::Uint32 chunk, int axis) {
+    const Step& step = Steps[axis * 2];
+    ChunkCoord coord = getChunkCoord(chunk);
+    sf::Uint32 neighbour = getChunkIndex(coord.x + step.dx, coord.y + step.dy, coord.z + step.dz);
+    if (neighbour == NoChunk) {
+        return;
+    }
+    
+    // Cell (u, v) of the face is the last layer of this chunk along the axis
+    int baseX = grid.getOriginX() + coord.x * ChunkSize;
+    int baseY = grid.getOriginY() + coord.y * ChunkSize;
+    int baseZ = grid.getOriginZ() + coord.z * ChunkSize;
+    auto faceCell = [&](int u, int v, int& x, int& y, int& z) {
+        switch (axis) {
+            case 0: x = baseX + ChunkSize - 1; y = baseY + u; z = baseZ + v; break;
+            case 1: x = baseX + u; y = baseY + ChunkSize - 1; z = baseZ + v; break;
+            default: x = baseX + u; y = baseY + v; z = baseZ + ChunkSize - 1; break;
+        }
+    };
+    
+    // Cells where both sides are walkable can be crossed in either direction
+    std::array<bool, FaceArea> open;
+    for (int v = 0; v < ChunkSize; v++) {
+        for (int u = 0; u < ChunkSize; u++) {
+            int x, y, z;
+            faceCell(u, v, x, y, z);
+            open[v * ChunkSize + u] = grid.isWalkable(x, y, z) &&
+                                      grid.isWalkable(x + step.dx, y + step.dy, z + step.dz);
+        }
+    }
+    
+    // One entrance per connected patch of the face, placed at its middle cell
+    std::array<bool, FaceArea> seen;
+    seen.fill(false);
+    std::array<sf::Uint16, FaceArea> patch;
+    for (int first = 0; first < FaceArea; first++) {
+        if (!open[first] || seen[first]) {
+            continue;
+        }
+        
+        size_t count = 0;
+        patch[count++] = static_cast<sf::Uint16>(first);
+        seen[first] = true;
+        for (size_t i = 0; i < count; i++) {
+            int u = patch[i] % ChunkSize;
+            int v = patch[i] / ChunkSize;
+            const int neighbours[4][2] = {{u - 1, v}, {u + 1, v}, {u, v - 1}, {u, v + 1}};
+            for (const auto& next : neighbours) {
+                if (next[0] < 0 || next[1] < 0 || next[0] >= ChunkSize || next[1] >= ChunkSize) {
+                    continue;
+                }
+                int cell = next[1] * ChunkSize + next[0];
+                if (open[cell] && !seen[cell]) {
+                    seen[cell] = true;
+                    patch[count++] = static_cast<sf::Uint16>(cell);
+                }
+            }
+        }
+        
+        std::sort(patch.begin(), patch.begin() + count);
+        int middle = patch[count / 2];
+        int x, y, z;
+        faceCell(middle % ChunkSize, middle / ChunkSize, x, y, z);
+        sf::Uint32 inside = createNode(x, y, z, chunk);
+        sf::Uint32 outside = createNode(x + step.dx, y + step.dy, z + step.dz, neighbour);
+        nodes[inside].partner = outside;
+        nodes[outside].partner = inside;
+    }
+}
+
+void NavGraph::buildLinks(sf::Uint32 chunk) {
+    const auto& members = chunkNodes[chunk];
+    for (sf::Uint32 id : members) {
+        Node& node = nodes[id];
+        node.edges.clear();
+        node.edges.push_back({node.partner, 1, 0});
+        node.stepPool.clear();
+    }
+    
+    for (sf::Uint32 id : members) {
+        Node& node = nodes[id];
+        flood(chunk, node.x, node.y, node.z, buildScratch);
+        for (sf::Uint32 other : members) {
+            if (other == id) {
+                continue;
+            }
+            int cell = getLocalCell(chunk, nodes[other].x, nodes[other].y, nodes[other].z);
+            if (buildScratch.cellStamp[cell] == buildScratch.floodStamp) {
+                traceSteps(getLocalCell(chunk, node.x, node.y, node.z), cell, buildScratch);
+                node.edges.push_back({other, buildScratch.cellDistance[cell],
+                                      static_cast<sf::Uint32>(node.stepPool.size())});
+                node.stepPool.insert(node.stepPool.end(), buildScratch.segment.begin(),
+                                     buildScratch.segment.end());
+            }
+        }
+    }
+}
+
+void NavGraph::flood(sf::Uint32 chunk, int x, int y, int z, SearchScratch& scratch, int targetCell) const {
+    ChunkCoord coord = getChunkCoord(chunk);
+    int baseX = grid.getOriginX() + coord.x * ChunkSize;
+    int baseY = grid.getOriginY() + coord.y * ChunkSize;
+    int baseZ = grid.getOriginZ() + coord.z * ChunkSize;
+    
+    // A wrapped stamp could match stale cells, so start over with a clean array
+    if (++scratch.floodStamp == 0) {
+        scratch.cellStamp.fill(0);
+        scratch.floodStamp = 1;
+    }
+    const sf::Uint32 stamp = scratch.floodStamp;
+    
+    int startCell = encodeLocal(x - baseX, y - baseY, z - baseZ);
+    scratch.cellStamp[startCell] = stamp;
+    scratch.cellDistance[startCell] = 0;
+    size_t head = 0;
+    size_t tail = 0;
+    scratch.queue[tail++] = static_cast<sf::Uint16>(startCell);
+    
+    while (head < tail) {
+        int cell = scratch.queue[head++];
+        if (cell == targetCell) {
+            return;
+        }
+        int localX = cell & (ChunkSize - 1);
+        int localY = (cell >> ChunkBits) & (ChunkSize - 1);
+        int localZ = cell >> (2 * ChunkBits);
+        
+        for (int i = 0; i < 6; i++) {
+            int nextX = localX + Steps[i].dx;
+            int nextY = localY + Steps[i].dy;
+            int nextZ = localZ + Steps[i].dz;
+            if (nextX < 0 || nextY < 0 || nextZ < 0 ||
+                nextX >= ChunkSize || nextY >= ChunkSize || nextZ >= ChunkSize) {
+                continue;
+            }
+            int next = encodeLocal(nextX, nextY, nextZ);
+            if (scratch.cellStamp[next] == stamp ||
+                !grid.isWalkable(baseX + nextX, baseY + nextY, baseZ + nextZ)) {
+                continue;
+            }
+            scratch.cellStamp[next] = stamp;
+            scratch.cellDistance[next] = static_cast<sf::Uint16>(scratch.cellDistance[cell] + 1);
+            scratch.cellFrom[next] = static_cast<sf::Uint8>(i);
+            scratch.queue[tail++] = static_cast<sf::Uint16>(next);
+        }
+    }
+}
+
+int NavGraph::getLocalCell(sf::Uint32 chunk, int x, int y, int z) const {
+    ChunkCoord coord = getChunkCoord(chunk);
+    return encodeLocal(x - grid.getOriginX() - coord.x * ChunkSize,
+                       y - grid.getOriginY() - coord.y * ChunkSize,
+                       z - grid.getOriginZ() - coord.z * ChunkSize);
+}
+
+bool NavGraph::appendSegment(sf::Uint32 chunk, int fromX, int fromY, int fromZ, int toX, int toY, int toZ,
+                             SearchScratch& scratch, std::vector<Direction>& steps) const {
+    int startCell = getLocalCell(chunk, fromX, fromY, fromZ);
+    int targetCell = getLocalCell(chunk, toX, toY, toZ);
+    flood(chunk, fromX, fromY, fromZ, scratch, targetCell);
+    if (scratch.cellStamp[targetCell] != scratch.floodStamp) {
+        return false;
+    }
+    
+    traceSteps(startCell, targetCell, scratch);
+    for (sf::Uint8 step : scratch.segment) {
+        steps.push_back(Steps[step].direction);
+    }
+    return true;
+}
+
+void NavGraph::traceSteps(int startCell, int targetCell, SearchScratch& scratch) const {
+    // Walk back from the target through the last flood, then reverse
+    scratch.segment.clear();
+    for (int cell = targetCell; cell != startCell;) {
+        sf::Uint8 index = scratch.cellFrom[cell];
+        scratch.segment.push_back(index);
+        const Step& step = Steps[index];
+        cell -= step.dz * ChunkSize * ChunkSize + step.dy * ChunkSize + step.dx;
+    }
+    std::reverse(scratch.segment.begin(), scratch.segment.end());
+}
+
+} // namespace IsometricMUD
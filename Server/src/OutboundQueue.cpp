@@ -0,0 +1,94 @@
+#include "OutboundQueue.hpp"
+#include "NetworkProtocol.hpp"
+#include "TickArena.hpp"
+
+namespace IsometricMUD {
+
+OutboundQueue::OutboundQueue(std::pmr::memory_resource* resource) : positionIndex(resource) {
+}
+
+void OutboundQueue::queueMessage(WireBufferPtr message) {
+    messages.push_back(std::move(message));
+}
+
+void OutboundQueue::queueSpawn(sf::Uint32 entityId, WireBufferPtr message) {
+    dropPosition(entityId);
+    messages.push_back(std::move(message));
+}
+
+void OutboundQueue::queueRemove(sf::Uint32 entityId, WireBufferPtr message) {
+    dropPosition(entityId);
+    messages.push_back(std::move(message));
+}
+
+void OutboundQueue::queuePosition(sf::Uint32 entityId, WireBufferPtr message) {
+    auto it = positionIndex.find(entityId);
+    if (it != positionIndex.end()) {
+        // Only the latest position this tick matters
+        positions[it->second].message = std::move(message);
+        coalescedCount++;
+        return;
+    }
+    positionIndex[entityId] = positions.size();
+    positions.push_back({entityId, std::move(message)});
+}
+
+void OutboundQueue::dropPosition(sf::Uint32 entityId) {
+    auto it = positionIndex.find(entityId);
+    if (it == positionIndex.end()) {
+        return;
+    }
+    
+    size_t index = it->second;
+    positionIndex.erase(it);
+    coalescedCount++;
+    if (index != positions.size() - 1) {
+        positions[index] = std::move(positions.back());
+        positionIndex[positions[index].entityId] = index;
+    }
+    positions.pop_back();
+}
+
+void OutboundQueue::writeTo(SendQueue& sendQueue) const {
+    if (getMessageCount() == 1) {
+        // Each encoded message is already a complete frame on its own
+        sendQueue.push(!messages.empty() ? messages.front() : positions.front().message);
+        return;
+    }
+    
+    // Encoded messages double as batch records, so the batch frame is just
+    // a header followed by the shared buffers
+    size_t payloadSize = 1;
+    for (const auto& message : messages) {
+        payloadSize += message->getSize();
+    }
+    for (const auto& update : positions) {
+        payloadSize += update.message->getSize();
+    }
+    
+    sf::Uint32 length = static_cast<sf::Uint32>(payloadSize);
+    const char header[BatchHeaderSize] = {
+        static_cast<char>((length >> 24) & 0xFF),
+        static_cast<char>((length >> 16) & 0xFF),
+        static_cast<char>((length >> 8) & 0xFF),
+        static_cast<char>(length & 0xFF),
+        static_cast<char>(PacketType::BATCH)
+    };
+    sendQueue.pushInline(header, sizeof(header));
+    
+    for (const auto& message : messages) {
+        sendQueue.push(message);
+    }
+    for (const auto& update : positions) {
+        sendQueue.push(update.message);
+    }
+}
+
+void OutboundQueue::clear() {
+    messages.clear();
+    positions.clear();
+    TickArena::release(positionIndex);
+    coalescedCount = 0;
+}
+
+} // namespace IsometricMUD
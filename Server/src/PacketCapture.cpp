@@ -0,0 +1,222 @@
+#include "PacketCapture.hpp"
+#include "WireCodec.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace IsometricMUD {
+
+namespace {
+
+// Pause when no finished ticks are waiting
+const sf::Time WriterIdleSleep = sf::milliseconds(5);
+
+const char CaptureMagic[4] = {'I', 'M', 'P', 'C'};
+const sf::Uint32 CaptureVersion = 1;
+
+// Magic, version, tick rate, seed
+const size_t HeaderSize = 16;
+
+// Longest tick header and event header: tick, count / kind, id, size varuints
+const size_t MaxTickHeaderSize = 16;
+const size_t MaxEventHeaderSize = 16;
+
+// A record claiming more than this is taken to be damage, not a busy tick
+const sf::Uint32 MaxRecordSize = 256 * 1024 * 1024;
+
+} // namespace
+
+CaptureWriter::CaptureWriter() : eventCount(0), running(false), file(nullptr) {
+}
+
+CaptureWriter::~CaptureWriter() {
+    close();
+}
+
+bool CaptureWriter::open(const std::string& capturePath, unsigned int tickRate, sf::Uint32 seed) {
+    path = capturePath;
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Error: Could not create capture " << path << std::endl;
+        return false;
+    }
+    
+    char header[HeaderSize];
+    WireWriter headerWriter(header, sizeof(header));
+    headerWriter.writeBytes(CaptureMagic, sizeof(CaptureMagic));
+    headerWriter.writeUInt32(CaptureVersion);
+    headerWriter.writeUInt32(tickRate);
+    headerWriter.writeUInt32(seed);
+    if (!headerWriter.finish() || std::fwrite(header, 1, headerWriter.getSize(), file) != headerWriter.getSize()) {
+        std::cerr << "Error: Could not write capture header to " << path << std::endl;
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+    
+    events.clear();
+    eventCount = 0;
+    running = true;
+    writer = std::thread(&CaptureWriter::runWriter, this);
+    std::cout << "Capturing inbound packets to " << path << std::endl;
+    return true;
+}
+
+void CaptureWriter::close() {
+    if (!writer.joinable()) {
+        return;
+    }
+    running = false;
+    writer.join();
+    std::fclose(file);
+    file = nullptr;
+}
+
+void CaptureWriter::recordConnect(sf::Uint32 clientId) {
+    appendEvent(CaptureEvent::CONNECT, clientId, nullptr, 0);
+}
+
+void CaptureWriter::recordDisconnect(sf::Uint32 clientId) {
+    appendEvent(CaptureEvent::DISCONNECT, clientId, nullptr, 0);
+}
+
+void CaptureWriter::recordPacket(sf::Uint32 clientId, std::string_view bytes) {
+    appendEvent(CaptureEvent::PACKET, clientId, bytes.data(), bytes.size());
+}
+
+void CaptureWriter::appendEvent(CaptureEvent kind, sf::Uint32 clientId, const void* data, size_t size) {
+    char header[MaxEventHeaderSize];
+    WireWriter writer(header, sizeof(header));
+    writer.writeByte(static_cast<sf::Uint8>(kind));
+    writer.writeVarUInt(clientId);
+    if (kind == CaptureEvent::PACKET) {
+        writer.writeVarUInt(size);
+    }
+    writer.finish();
+    
+    events.insert(events.end(), header, header + writer.getSize());
+    if (size > 0) {
+        const char* bytes = static_cast<const char*>(data);
+        events.insert(events.end(), bytes, bytes + size);
+    }
+    eventCount++;
+}
+
+void CaptureWriter::commitTick(sf::Uint64 tick) {
+    if (eventCount == 0) {
+        return;
+    }
+    
+    char header[MaxTickHeaderSize];
+    WireWriter writer(header, sizeof(header));
+    writer.writeVarUInt(tick);
+    writer.writeVarUInt(eventCount);
+    writer.finish();
+    
+    char length[4];
+    WireWriter lengthWriter(length, sizeof(length));
+    lengthWriter.writeUInt32(static_cast<sf::Uint32>(writer.getSize() + events.size()));
+    lengthWriter.finish();
+    
+    std::vector<char> record;
+    record.reserve(sizeof(length) + writer.getSize() + events.size());
+    record.insert(record.end(), length, length + sizeof(length));
+    record.insert(record.end(), header, header + writer.getSize());
+    record.insert(record.end(), events.begin(), events.end());
+    records.push(std::move(record));
+    
+    events.clear();
+    eventCount = 0;
+}
+
+void CaptureWriter::runWriter() {
+    bool failed = false;
+    while (true) {
+        // Read the flag first: every tick committed before close() set it is queued
+        bool stopping = !running;
+        
+        size_t drained = records.drain([this, &failed](std::vector<char> record) {
+            if (!failed && std::fwrite(record.data(), 1, record.size(), file) != record.size()) {
+                std::cerr << "Error: Capture write to " << path << " failed; the rest is not being recorded"
+                          << std::endl;
+                failed = true;
+            }
+        });
+        
+        if (stopping) {
+            break;
+        }
+        if (drained == 0) {
+            sf::sleep(WriterIdleSleep);
+        }
+    }
+    std::fflush(file);
+}
+
+bool CaptureReader::open(const std::string& path) {
+    file.open(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "Error: Could not open capture " << path << std::endl;
+        return false;
+    }
+    
+    char header[HeaderSize];
+    if (!file.read(header, sizeof(header)) || std::memcmp(header, CaptureMagic, sizeof(CaptureMagic)) != 0) {
+        std::cerr << "Error: " << path << " is not a packet capture" << std::endl;
+        return false;
+    }
+    
+    WireReader reader(header + sizeof(CaptureMagic), sizeof(header) - sizeof(CaptureMagic));
+    sf::Uint32 version = reader.readUInt32();
+    if (version != CaptureVersion) {
+        std::cerr << "Error: " << path << " is capture version " << version
+                  << "; this server reads version " << CaptureVersion << std::endl;
+        return false;
+    }
+    tickRate = reader.readUInt32();
+    seed = reader.readUInt32();
+    return true;
+}
+
+bool CaptureReader::readTick(CapturedTick& tick) {
+    char length[4];
+    if (!file.read(length, sizeof(length))) {
+        // A clean end falls exactly on a record boundary
+        damaged = file.gcount() != 0;
+        return false;
+    }
+    
+    sf::Uint32 size = WireReader(length, sizeof(length)).readUInt32();
+    if (size > MaxRecordSize) {
+        damaged = true;
+        return false;
+    }
+    record.resize(size);
+    if (!file.read(record.data(), size)) {
+        damaged = true;
+        return false;
+    }
+    
+    WireReader reader(record.data(), record.size());
+    tick.tick = reader.readVarUInt();
+    sf::Uint64 count = reader.readVarUInt();
+    tick.events.resize(reader.ok() && count <= size ? static_cast<size_t>(count) : 0);
+    
+    for (auto& event : tick.events) {
+        event.kind = static_cast<CaptureEvent>(reader.readByte());
+        event.clientId = static_cast<sf::Uint32>(reader.readVarUInt());
+        event.bytes = std::string_view();
+        if (event.kind == CaptureEvent::PACKET) {
+            sf::Uint64 packetSize = reader.readVarUInt();
+            event.bytes = reader.readBytes(static_cast<size_t>(std::min<sf::Uint64>(packetSize, size)));
+        }
+    }
+    
+    if (!reader.ok()) {
+        damaged = true;
+        return false;
+    }
+    return true;
+}
+
+} // namespace IsometricMUD
@@ -0,0 +1,179 @@
+#include "PathfindingService.hpp"
+#include <cmath>
+#include <iostream>
+
+namespace IsometricMUD {
+
+namespace {
+
+// Past this many entries the cache starts over rather than tracking age
+const size_t MaxCachedPaths = 16384;
+
+int toCell(float coordinate) {
+    return static_cast<int>(std::floor(coordinate + 0.5f));
+}
+
+} // namespace
+
+PathfindingService::PathfindingService(VoxelGrid& voxelGrid)
+    : grid(voxelGrid), graph(voxelGrid), stopping(false), nextRequestId(1) {
+}
+
+PathfindingService::~PathfindingService() {
+    stop();
+}
+
+void PathfindingService::start(unsigned int threadCount) {
+    if (isRunning()) {
+        return;
+    }
+    
+    sf::Clock buildClock;
+    graph.build();
+    std::cout << "Navigation graph: " << graph.getNodeCount() << " portals, built in "
+              << buildClock.getElapsedTime().asMilliseconds() << " ms" << std::endl;
+    
+    stopping = false;
+    for (unsigned int i = 0; i < threadCount; i++) {
+        workers.emplace_back(&PathfindingService::runWorker, this);
+    }
+}
+
+void PathfindingService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        stopping = true;
+        requests.clear();
+    }
+    requestReady.notify_all();
+    
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    submitted.clear();
+    results.drain([](PathResult&&) {});
+}
+
+sf::Uint32 PathfindingService::submit(sf::Uint32 ownerId, const Vector3D& from, const Vector3D& to) {
+    sf::Uint32 requestId = nextRequestId++;
+    submitted.push_back({requestId, ownerId, from, to});
+    return requestId;
+}
+
+void PathfindingService::dispatch() {
+    if (submitted.empty() || !isRunning()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        requests.insert(requests.end(), submitted.begin(), submitted.end());
+    }
+    submitted.clear();
+    requestReady.notify_all();
+}
+
+bool PathfindingService::setSolid(int x, int y, int z, bool solid) {
+    std::unique_lock<std::shared_mutex> lock(graphMutex);
+    if (!grid.setSolid(x, y, z, solid)) {
+        return false;
+    }
+    graph.updateCell(x, y, z);
+    return true;
+}
+
+void PathfindingService::runWorker() {
+    NavGraph::SearchScratch scratch;
+    
+    while (true) {
+        PathRequest request;
+        {
+            std::unique_lock<std::mutex> lock(requestMutex);
+            requestReady.wait(lock, [this] { return stopping || !requests.empty(); });
+            if (stopping) {
+                return;
+            }
+            request = requests.front();
+            requests.pop_front();
+        }
+        
+        PathResult result;
+        result.requestId = request.requestId;
+        result.ownerId = request.ownerId;
+        {
+            std::shared_lock<std::shared_mutex> lock(graphMutex);
+            solve(request, scratch, result);
+        }
+        results.push(std::move(result));
+    }
+}
+
+void PathfindingService::solve(const PathRequest& request, NavGraph::SearchScratch& scratch,
+                               PathResult& result) {
+    int startX = toCell(request.from.x), startY = toCell(request.from.y), startZ = toCell(request.from.z);
+    int goalX = toCell(request.to.x), goalY = toCell(request.to.y), goalZ = toCell(request.to.z);
+    
+    sf::Uint32 startChunk = graph.getChunkOf(startX, startY, startZ);
+    sf::Uint32 goalChunk = graph.getChunkOf(goalX, goalY, goalZ);
+    if (startChunk == NavGraph::NoChunk || goalChunk == NavGraph::NoChunk ||
+        !grid.isWalkable(goalX, goalY, goalZ)) {
+        return;
+    }
+    
+    // Chunk-to-chunk portal sequences are shared by every query between the two chunks
+    sf::Uint64 key = (static_cast<sf::Uint64>(startChunk) << 32) | goalChunk;
+    if (startChunk != goalChunk) {
+        std::vector<sf::Uint32> cachedNodes;
+        bool hit = false;
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            auto found = cache.find(key);
+            if (found != cache.end() && isCurrent(found->second)) {
+                cachedNodes = found->second.nodes;
+                hit = true;
+            }
+        }
+        if (hit && graph.refinePath(startX, startY, startZ, cachedNodes, goalX, goalY, goalZ,
+                                    scratch, result.steps)) {
+            result.found = true;
+            result.cached = true;
+            return;
+        }
+    }
+    
+    CachedPath path;
+    if (!graph.findAbstractPath(startX, startY, startZ, goalX, goalY, goalZ, scratch, path.nodes) ||
+        !graph.refinePath(startX, startY, startZ, path.nodes, goalX, goalY, goalZ, scratch, result.steps)) {
+        result.steps.clear();
+        return;
+    }
+    result.found = true;
+    
+    if (path.nodes.empty()) {
+        return;     // Walked inside one chunk; nothing worth caching
+    }
+    for (sf::Uint32 node : path.nodes) {
+        sf::Uint32 chunk = graph.getNodeChunk(node);
+        if (path.chunkVersions.empty() || path.chunkVersions.back().first != chunk) {
+            path.chunkVersions.emplace_back(chunk, graph.getChunkVersion(chunk));
+        }
+    }
+    path.chunkVersions.emplace_back(goalChunk, graph.getChunkVersion(goalChunk));
+    
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (cache.size() >= MaxCachedPaths) {
+        cache.clear();
+    }
+    cache[key] = std::move(path);
+}
+
+bool PathfindingService::isCurrent(const CachedPath& path) const {
+    for (const auto& entry : path.chunkVersions) {
+        if (graph.getChunkVersion(entry.first) != entry.second) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace IsometricMUD
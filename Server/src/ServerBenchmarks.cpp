@@ -0,0 +1,574 @@
+#include "ServerBenchmarks.hpp"
+#include "AllocationCounter.hpp"
+#include "ClientRegistry.hpp"
+#include "EntityStore.hpp"
+#include "GameServer.hpp"
+#include "Histogram.hpp"
+#include "LevelFile.hpp"
+#include "NetworkProtocol.hpp"
+#include "OutboundQueue.hpp"
+#include "Snapshot.hpp"
+#include "VoxelGrid.hpp"
+#include "WireBuffer.hpp"
+#include <SFML/System.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace IsometricMUD {
+
+namespace {
+
+// voxel: a 1024x1024 map whose ground steps up through 16 levels
+const int VoxelMapSize = 1024;
+const int VoxelMapLevels = 16;
+const size_t VoxelQueryCount = 1 << 20;
+const unsigned int VoxelRounds = 64;
+
+struct CellQuery {
+    int x, y, z;
+};
+
+// Terraces 64 cells wide, one level higher per terrace; the top two levels
+// are left for walls and the headroom the grid keeps above them
+int terrainHeight(int x, int y) {
+    return ((x >> 6) + (y >> 6)) % (VoxelMapLevels - 2);
+}
+
+// Walls: every 16th column, with a gap every 4 cells to walk through
+bool hasWall(int x, int y) {
+    return x % 16 == 0 && y % 4 != 0;
+}
+
+// entities: as many as a busy shard, half of them replaced once so the heap
+// and the store look like they do after players have come and gone
+const size_t EntityCount = 50000;
+const unsigned int EntityPasses = 200;
+
+// How a player's state was kept before EntityStore: the position sat inside
+// the connection object, one heap allocation per client, found through a map
+struct LegacyEntity {
+    Vector3D position;
+    Vector3D velocity;
+    char connectionState[sizeof(ClientInfo) - 2 * sizeof(Vector3D)];
+};
+
+// snapshots: one observer seeing every entity; a tenth of them take one
+// step each tick, for ten seconds at 60 Hz
+const sf::Uint32 SnapshotEntities = 1000;
+const sf::Uint32 SnapshotMovers = 100;
+const unsigned int SnapshotTicks = 600;
+const int SnapshotAreaSize = 64;
+
+// A 100 ms round trip at 60 Hz: the newest acknowledged snapshot is this old
+const sf::Uint32 SnapshotRoundTripTicks = 6;
+
+// broadcast: a chat line sent to this many clients, many times over
+const size_t BroadcastFanouts[] = {10, 100, 1000, 5000};
+const unsigned int BroadcastRounds = 200;
+
+// A client's outbox before WireBuffer: queuePacket copied the packet in, and
+// buildFrame copied a lone message again into the server's shared frame
+struct LegacyOutbox {
+    std::vector<sf::Packet> messages;
+};
+
+struct BroadcastResult {
+    double bytesCopied = 0.0;
+    double allocations = 0.0;
+    double microseconds = 0.0;
+};
+
+// connections: LoadGen's default walk, with the ground grown to keep 16x16
+// cells per client, so only the number of clients changes between runs. The
+// warm-up covers everyone's spawn; the measured ticks are ten seconds at 60 Hz
+const unsigned int ConnectionCounts[] = {10, 100, 1000, 2500, 5000};
+const unsigned int CellsPerClient = 256;
+const float ConnectionMoveRate = 5.0f;
+const unsigned int ConnectionWarmupTicks = 120;
+const unsigned int ConnectionMeasuredTicks = 600;
+
+// Component-wise, so both layouts do the same arithmetic with no calls
+void advance(Vector3D& position, const Vector3D& velocity) {
+    position.x += velocity.x;
+    position.y += velocity.y;
+    position.z += velocity.z;
+}
+
+double toNanoseconds(sf::Time time) {
+    return static_cast<double>(time.asMicroseconds()) * 1000.0;
+}
+
+// Run every query VoxelRounds times; returns the time per query in ns
+double timeQueries(const VoxelGrid& grid, const std::vector<CellQuery>& queries, size_t& walkable) {
+    sf::Clock clock;
+    walkable = 0;
+    for (unsigned int round = 0; round < VoxelRounds; round++) {
+        for (const CellQuery& query : queries) {
+            walkable += grid.isWalkable(query.x, query.y, query.z) ? 1 : 0;
+        }
+    }
+    return toNanoseconds(clock.getElapsedTime()) / (static_cast<double>(queries.size()) * VoxelRounds);
+}
+
+} // namespace
+
+bool ServerBenchmarks::exists(const std::string& name) {
+    return name == "voxel" || name == "entities" || name == "snapshots" || name == "broadcast" ||
+           name == "connections";
+}
+
+const char* ServerBenchmarks::getNames() {
+    return "voxel|entities|snapshots|broadcast|connections";
+}
+
+bool ServerBenchmarks::run(const std::string& name, std::ostream& out) {
+    if (name == "voxel") {
+        return runVoxel(out);
+    }
+    if (name == "entities") {
+        return runEntities(out);
+    }
+    if (name == "snapshots") {
+        return runSnapshots(out);
+    }
+    if (name == "broadcast") {
+        return runBroadcast(out);
+    }
+    if (name == "connections") {
+        return runConnections(out);
+    }
+    std::cerr << "Error: Unknown benchmark '" << name << "' (expected " << getNames() << ")" << std::endl;
+    return false;
+}
+
+bool ServerBenchmarks::runVoxel(std::ostream& out) {
+    std::vector<TileData> tiles;
+    tiles.reserve(static_cast<size_t>(VoxelMapSize) * VoxelMapSize * 2);
+    for (int y = 0; y < VoxelMapSize; y++) {
+        for (int x = 0; x < VoxelMapSize; x++) {
+            float height = static_cast<float>(terrainHeight(x, y));
+            tiles.push_back({Vector3D(static_cast<float>(x), static_cast<float>(y), height),
+                             static_cast<int>(TileType::GRASS), ""});
+            if (hasWall(x, y)) {
+                tiles.push_back({Vector3D(static_cast<float>(x), static_cast<float>(y), height + 1),
+                                 static_cast<int>(TileType::STONE), ""});
+            }
+        }
+    }
+    
+    sf::Clock buildClock;
+    VoxelGrid grid;
+    grid.build(tiles);
+    double buildMs = buildClock.getElapsedTime().asMicroseconds() / 1000.0;
+    tiles.clear();
+    tiles.shrink_to_fit();
+    
+    // Random cells anywhere in the grid: every query is likely a cache miss
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> coordinate(0, VoxelMapSize - 1);
+    std::uniform_int_distribution<int> level(0, VoxelMapLevels - 1);
+    std::vector<CellQuery> scattered(VoxelQueryCount);
+    for (CellQuery& query : scattered) {
+        query = {coordinate(random), coordinate(random), level(random)};
+    }
+    
+    // A random walk over the ground, as movement validation sees it
+    std::uniform_int_distribution<int> direction(0, 3);
+    std::vector<CellQuery> walk(VoxelQueryCount);
+    int x = VoxelMapSize / 2;
+    int y = VoxelMapSize / 2;
+    for (CellQuery& query : walk) {
+        switch (direction(random)) {
+            case 0: x = x + 1 < VoxelMapSize ? x + 1 : x - 1; break;
+            case 1: x = x > 0 ? x - 1 : x + 1; break;
+            case 2: y = y + 1 < VoxelMapSize ? y + 1 : y - 1; break;
+            default: y = y > 0 ? y - 1 : y + 1; break;
+        }
+        query = {x, y, terrainHeight(x, y)};
+    }
+    
+    size_t scatteredWalkable = 0;
+    size_t walkWalkable = 0;
+    double scatteredNs = timeQueries(grid, scattered, scatteredWalkable);
+    double walkNs = timeQueries(grid, walk, walkWalkable);
+    double total = static_cast<double>(VoxelQueryCount) * VoxelRounds;
+    
+    out << std::fixed << std::setprecision(2);
+    out << "{"
+        << "\"benchmark\":\"voxel\""
+        << ",\"grid\":\"" << grid.getSizeX() << "x" << grid.getSizeY() << "x" << grid.getSizeZ() << "\""
+        << ",\"chunks\":" << grid.getChunkCount()
+        << ",\"memory_bytes\":" << grid.getMemoryUsage()
+        << ",\"build_ms\":" << buildMs
+        << ",\"queries\":" << static_cast<std::uint64_t>(total)
+        << ",\"random\":{"
+        << "\"ns_per_query\":" << scatteredNs
+        << ",\"queries_per_s\":" << (scatteredNs > 0.0 ? 1e9 / scatteredNs : 0.0)
+        << ",\"walkable\":" << scatteredWalkable / total
+        << "}"
+        << ",\"walk\":{"
+        << "\"ns_per_query\":" << walkNs
+        << ",\"queries_per_s\":" << (walkNs > 0.0 ? 1e9 / walkNs : 0.0)
+        << ",\"walkable\":" << walkWalkable / total
+        << "}}" << std::endl;
+    return true;
+}
+
+bool ServerBenchmarks::runEntities(std::ostream& out) {
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> step(-1, 1);
+    auto randomVelocity = [&]() {
+        return Vector3D(static_cast<float>(step(random)), static_cast<float>(step(random)), 0);
+    };
+    
+    EntityStore store;
+    std::vector<EntityHandle> handles;
+    std::map<sf::Uint32, std::unique_ptr<LegacyEntity>> legacy;
+    sf::Uint32 nextId = 1;
+    auto addEntity = [&]() {
+        Vector3D position(static_cast<float>(nextId % 1024), static_cast<float>(nextId / 1024), 0);
+        Vector3D velocity = randomVelocity();
+        EntityHandle handle = store.create(position, nextId, EntityStore::PlayerFlag);
+        store.getVelocity(handle) = velocity;
+        handles.push_back(handle);
+        
+        std::unique_ptr<LegacyEntity> entity = std::make_unique<LegacyEntity>();
+        entity->position = position;
+        entity->velocity = velocity;
+        legacy[nextId] = std::move(entity);
+        nextId++;
+    };
+    for (size_t i = 0; i < EntityCount; i++) {
+        addEntity();
+    }
+    
+    // Replace a random half: the store swap-removes and stays dense, while the
+    // map's new entries land in whatever holes the allocator has
+    std::shuffle(handles.begin(), handles.end(), random);
+    for (size_t i = 0; i < EntityCount / 2; i++) {
+        legacy.erase(store.getOwner(handles.back()));
+        store.destroy(handles.back());
+        handles.pop_back();
+    }
+    for (size_t i = 0; i < EntityCount / 2; i++) {
+        addEntity();
+    }
+    
+    Vector3D* positions = store.getPositions();
+    const Vector3D* velocities = store.getVelocities();
+    size_t count = store.size();
+    sf::Clock storeClock;
+    for (unsigned int pass = 0; pass < EntityPasses; pass++) {
+        for (size_t i = 0; i < count; i++) {
+            advance(positions[i], velocities[i]);
+        }
+    }
+    double storeMs = storeClock.getElapsedTime().asMicroseconds() / 1000.0 / EntityPasses;
+    
+    sf::Clock legacyClock;
+    for (unsigned int pass = 0; pass < EntityPasses; pass++) {
+        for (auto& entry : legacy) {
+            advance(entry.second->position, entry.second->velocity);
+        }
+    }
+    double legacyMs = legacyClock.getElapsedTime().asMicroseconds() / 1000.0 / EntityPasses;
+    
+    // Both did the same moves, so the sums must agree; printing them also
+    // keeps the passes from being optimized away
+    double storeSum = 0.0;
+    double legacySum = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        storeSum += positions[i].x + positions[i].y;
+    }
+    for (const auto& entry : legacy) {
+        legacySum += entry.second->position.x + entry.second->position.y;
+    }
+    
+    out << std::fixed << std::setprecision(3);
+    out << "{"
+        << "\"benchmark\":\"entities\""
+        << ",\"entities\":" << count
+        << ",\"passes\":" << EntityPasses
+        << ",\"client_info_bytes\":" << sizeof(ClientInfo)
+        << ",\"store_ms_per_pass\":" << storeMs
+        << ",\"map_ms_per_pass\":" << legacyMs
+        << ",\"speedup\":" << (storeMs > 0.0 ? legacyMs / storeMs : 0.0)
+        << ",\"checksums_match\":" << (storeSum == legacySum ? "true" : "false")
+        << "}" << std::endl;
+    return true;
+}
+
+bool ServerBenchmarks::runSnapshots(std::ostream& out) {
+    // The same walk for every mode: which entities move each tick, and where
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int> cell(0, SnapshotAreaSize - 1);
+    std::vector<Vector3D> start(SnapshotEntities + 1);
+    for (sf::Uint32 id = 1; id <= SnapshotEntities; id++) {
+        start[id] = Vector3D(static_cast<float>(cell(random)), static_cast<float>(cell(random)), 0);
+    }
+    std::vector<sf::Uint32> ids(SnapshotEntities);
+    for (sf::Uint32 i = 0; i < SnapshotEntities; i++) {
+        ids[i] = i + 1;
+    }
+    std::vector<std::vector<std::pair<sf::Uint32, Vector3D>>> moves(SnapshotTicks);
+    for (auto& tickMoves : moves) {
+        std::shuffle(ids.begin(), ids.end(), random);
+        for (sf::Uint32 i = 0; i < SnapshotMovers; i++) {
+            Vector3D step(0, 0, 0);
+            switch (random() % 4) {
+                case 0: step.x = 1; break;
+                case 1: step.x = -1; break;
+                case 2: step.y = 1; break;
+                default: step.y = -1; break;
+            }
+            tickMoves.push_back({ids[i], step});
+        }
+    }
+    
+    // What the client's socket receives in a tick: the outbox written as one frame
+    auto frameBytes = [](const OutboundQueue& outbox) {
+        SendQueue sendQueue;
+        outbox.writeTo(sendQueue);
+        return sendQueue.getPendingBytes();
+    };
+    
+    // Per-move: one UPDATE_POSITION per moved entity, batched per tick
+    std::vector<Vector3D> positions = start;
+    OutboundQueue outbox;
+    size_t perMoveBytes = 0;
+    for (const auto& tickMoves : moves) {
+        for (const auto& move : tickMoves) {
+            Vector3D& position = positions[move.first];
+            position = position + move.second;
+            outbox.queuePosition(move.first, WireBuffer::encode(
+                NetworkProtocol::createPositionPacket(move.first, position)));
+        }
+        perMoveBytes += frameBytes(outbox);
+        outbox.clear();
+    }
+    
+    // Delta snapshots against the newest one the client has acknowledged
+    size_t fullSnapshotBytes = 0;
+    auto measureSnapshots = [&](sf::Uint32 ackDelay) {
+        std::vector<Vector3D> snapshotPositions = start;
+        SnapshotHistory sent;
+        Snapshot current;
+        std::vector<char> buffer;
+        static const Snapshot emptyBaseline;
+        size_t total = 0;
+        
+        for (sf::Uint32 tick = 0; tick <= SnapshotTicks; tick++) {
+            // Tick 0 is the full snapshot a client gets on arrival
+            if (tick > 0) {
+                for (const auto& move : moves[tick - 1]) {
+                    Vector3D& position = snapshotPositions[move.first];
+                    position = position + move.second;
+                }
+            }
+            current.sequence = tick + 1;
+            current.entities.clear();
+            for (sf::Uint32 id = 1; id <= SnapshotEntities; id++) {
+                current.add(id, snapshotPositions[id]);
+            }
+            
+            const Snapshot* baseline = current.sequence > ackDelay ? sent.find(current.sequence - ackDelay) : nullptr;
+            if (!baseline) {
+                baseline = &emptyBaseline;
+            }
+            buffer.resize(SnapshotCodec::maxEncodedSize(*baseline, current));
+            WireWriter writer(buffer.data(), buffer.size());
+            if (!SnapshotCodec::encode(writer, *baseline, current)) {
+                return static_cast<size_t>(0);
+            }
+            outbox.queueMessage(WireBuffer::frame(buffer.data(), writer.getSize()));
+            size_t bytes = frameBytes(outbox);
+            outbox.clear();
+            sent.store(current);
+            
+            if (tick == 0) {
+                fullSnapshotBytes = bytes;
+            } else {
+                total += bytes;
+            }
+        }
+        return total;
+    };
+    size_t nextTickAckBytes = measureSnapshots(1);
+    size_t roundTripAckBytes = measureSnapshots(SnapshotRoundTripTicks + 1);
+    if (nextTickAckBytes == 0 || roundTripAckBytes == 0) {
+        std::cerr << "Error: Snapshot encoding overflowed its buffer" << std::endl;
+        return false;
+    }
+    
+    double perMove = static_cast<double>(perMoveBytes) / SnapshotTicks;
+    double nextTickAck = static_cast<double>(nextTickAckBytes) / SnapshotTicks;
+    double roundTripAck = static_cast<double>(roundTripAckBytes) / SnapshotTicks;
+    
+    out << std::fixed << std::setprecision(1);
+    out << "{"
+        << "\"benchmark\":\"snapshots\""
+        << ",\"entities\":" << SnapshotEntities
+        << ",\"moving_per_tick\":" << SnapshotMovers
+        << ",\"ticks\":" << SnapshotTicks
+        << ",\"per_move_bytes_per_tick\":" << perMove
+        << ",\"snapshot_bytes_per_tick\":" << nextTickAck
+        << ",\"snapshot_rtt_bytes_per_tick\":" << roundTripAck
+        << ",\"rtt_ticks\":" << SnapshotRoundTripTicks
+        << ",\"full_snapshot_bytes\":" << fullSnapshotBytes
+        << ",\"per_move_vs_snapshot\":" << (nextTickAck > 0.0 ? perMove / nextTickAck : 0.0)
+        << "}" << std::endl;
+    return true;
+}
+
+bool ServerBenchmarks::runBroadcast(std::ostream& out) {
+    const sf::Packet message = NetworkProtocol::createChatPacket(ChatChannel::GLOBAL, 1,
+                                                                 "hello from the broadcast benchmark");
+    const size_t payloadSize = message.getDataSize();
+    
+    // Runs BroadcastRounds broadcasts after one untimed round, so queues
+    // and frames have grown to size and only the steady state is counted
+    auto measure = [](unsigned int rounds, auto&& broadcastOnce) {
+        broadcastOnce();
+        BroadcastResult result;
+        std::uint64_t allocationsBefore = AllocationCounter::getThreadCount();
+        sf::Clock clock;
+        for (unsigned int round = 0; round < rounds; round++) {
+            result.bytesCopied += static_cast<double>(broadcastOnce());
+        }
+        result.microseconds = static_cast<double>(clock.getElapsedTime().asMicroseconds()) / rounds;
+        result.allocations = static_cast<double>(AllocationCounter::getThreadCount() - allocationsBefore) / rounds;
+        result.bytesCopied /= rounds;
+        return result;
+    };
+    
+    out << std::fixed << std::setprecision(1);
+    out << "{"
+        << "\"benchmark\":\"broadcast\""
+        << ",\"message_bytes\":" << payloadSize
+        << ",\"rounds\":" << BroadcastRounds
+        << ",\"allocations_counted\":" << (AllocationCounter::isEnabled() ? "true" : "false")
+        << ",\"fanouts\":[";
+    
+    bool first = true;
+    for (size_t fanout : BroadcastFanouts) {
+        // Before: each outbox got its own copy, and the flush copied it again
+        // into the frame that was sent
+        std::vector<LegacyOutbox> legacyOutboxes(fanout);
+        sf::Packet frame;
+        BroadcastResult copied = measure(BroadcastRounds, [&]() {
+            size_t bytes = 0;
+            for (LegacyOutbox& outbox : legacyOutboxes) {
+                outbox.messages.push_back(message);
+                bytes += payloadSize;
+            }
+            for (LegacyOutbox& outbox : legacyOutboxes) {
+                frame = outbox.messages.front();
+                bytes += payloadSize;
+                outbox.messages.clear();
+            }
+            return bytes;
+        });
+        
+        // Now: encoded once, then every outbox and send queue holds a reference
+        std::vector<OutboundQueue> outboxes(fanout);
+        std::vector<SendQueue> sendQueues(fanout);
+        BroadcastResult shared = measure(BroadcastRounds, [&]() {
+            WireBufferPtr buffer = WireBuffer::encode(message);
+            for (OutboundQueue& outbox : outboxes) {
+                outbox.queueMessage(buffer);
+            }
+            for (size_t i = 0; i < fanout; i++) {
+                outboxes[i].writeTo(sendQueues[i]);
+                outboxes[i].clear();
+                sendQueues[i].clear();
+            }
+            return buffer->getSize();
+        });
+        
+        auto writeResult = [&out](const char* name, const BroadcastResult& result) {
+            out << "\"" << name << "\":{"
+                << "\"bytes_copied\":" << result.bytesCopied
+                << ",\"allocations\":";
+            if (AllocationCounter::isEnabled()) {
+                out << result.allocations;
+            } else {
+                out << "null";
+            }
+            out << ",\"us\":" << result.microseconds << "}";
+        };
+        out << (first ? "" : ",") << "{\"clients\":" << fanout << ",";
+        writeResult("per_client_copy", copied);
+        out << ",";
+        writeResult("shared_buffer", shared);
+        out << "}";
+        first = false;
+    }
+    out << "]}" << std::endl;
+    
+    if (!AllocationCounter::isEnabled()) {
+        std::cerr << "Note: build with -DISOMUD_COUNT_ALLOCATIONS=ON to count allocations" << std::endl;
+    }
+    return true;
+}
+
+bool ServerBenchmarks::runConnections(std::ostream& out) {
+    ServerConfig config;
+    config.statsInterval = 0;
+    config.randomSeed = 1;
+    
+    std::ostringstream runs;
+    for (unsigned int clientCount : ConnectionCounts) {
+        // Flat ground with a hole at the origin, so every client spawns at a
+        // random cell as on a real level
+        int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(clientCount) * CellsPerClient)));
+        std::vector<TileData> level;
+        level.reserve(static_cast<size_t>(side) * side);
+        for (int y = 0; y < side; y++) {
+            for (int x = 0; x < side; x++) {
+                if (x != 0 || y != 0) {
+                    level.push_back({Vector3D(static_cast<float>(x), static_cast<float>(y), 0),
+                                     static_cast<int>(TileType::GRASS), ""});
+                }
+            }
+        }
+        
+        // The server logs every connect; stdout is kept for the one JSON line
+        Histogram tickTimes;
+        std::streambuf* savedBuffer = std::cout.rdbuf(nullptr);
+        {
+            std::unique_ptr<GameServer> server = std::make_unique<GameServer>(config);
+            server->runSyntheticLoad(level, clientCount, ConnectionMoveRate, ConnectionWarmupTicks,
+                                     ConnectionMeasuredTicks, tickTimes);
+        }
+        std::cout.rdbuf(savedBuffer);
+        
+        runs << (clientCount == ConnectionCounts[0] ? "" : ",")
+             << "{\"clients\":" << clientCount
+             << ",\"ground\":" << side
+             << ",\"tick_us\":{"
+             << "\"p50\":" << tickTimes.percentile(0.50)
+             << ",\"p99\":" << tickTimes.percentile(0.99)
+             << ",\"max\":" << tickTimes.getMax()
+             << ",\"mean\":" << tickTimes.getSum() / tickTimes.getCount()
+             << "}}";
+    }
+    
+    out << "{"
+        << "\"benchmark\":\"connections\""
+        << ",\"tick_rate\":" << config.tickRate
+        << ",\"move_rate\":" << ConnectionMoveRate
+        << ",\"warmup_ticks\":" << ConnectionWarmupTicks
+        << ",\"ticks\":" << ConnectionMeasuredTicks
+        << ",\"runs\":[" << runs.str() << "]}" << std::endl;
+    return true;
+}
+
+} // namespace IsometricMUD
@@ -0,0 +1,177 @@
+#include "ServerMetrics.hpp"
+#include "AllocationCounter.hpp"
+#include <string>
+
+namespace IsometricMUD {
+
+namespace {
+
+// Histograms record microseconds; Prometheus expects seconds
+const double MicrosecondsToSeconds = 1e-6;
+
+} // namespace
+
+ServerMetrics::ServerMetrics(MetricsRegistry& registry, const TickScheduler& scheduler) {
+    for (size_t slot = 0; slot < TypeSlotCount; slot++) {
+        std::string label = std::string("type=\"") +
+            NetworkProtocol::getPacketTypeName(static_cast<PacketType>(slot)) + "\"";
+        receivedCounters[slot].packets = &registry.addCounter(
+            "isomud_packets_received_total", "Messages received over TCP by type", label);
+        receivedCounters[slot].bytes = &registry.addCounter(
+            "isomud_bytes_received_total", "TCP bytes received by message type, including framing", label);
+        sentCounters[slot].packets = &registry.addCounter(
+            "isomud_packets_sent_total", "Messages queued for sending over TCP by type", label);
+        sentCounters[slot].bytes = &registry.addCounter(
+            "isomud_bytes_sent_total", "TCP bytes queued by message type, including framing", label);
+    }
+    
+    datagramsReceivedCounters.packets = &registry.addCounter(
+        "isomud_datagrams_received_total", "UDP datagrams received");
+    datagramsReceivedCounters.bytes = &registry.addCounter(
+        "isomud_datagram_bytes_received_total", "UDP bytes received");
+    datagramsSentCounters.packets = &registry.addCounter(
+        "isomud_datagrams_sent_total", "UDP datagrams sent");
+    datagramsSentCounters.bytes = &registry.addCounter(
+        "isomud_datagram_bytes_sent_total", "UDP bytes sent");
+    
+    coalescedCounter = &registry.addCounter(
+        "isomud_messages_dropped_total", "Queued messages discarded before sending", "reason=\"coalesced\"");
+    backpressureDroppedCounter = &registry.addCounter(
+        "isomud_messages_dropped_total", "Queued messages discarded before sending", "reason=\"backpressure\"");
+    evictionsCounter = &registry.addCounter(
+        "isomud_client_evictions_total", "Clients disconnected for not reading their updates");
+    congestedGauge = &registry.addGauge(
+        "isomud_congested_clients", "Clients whose send queue is above the high watermark");
+    pathRequestsCounter = &registry.addCounter("isomud_path_requests_total", "Path queries submitted");
+    pathsFoundCounter = &registry.addCounter(
+        "isomud_path_results_total", "Path queries answered", "result=\"found\"");
+    pathsUnreachableCounter = &registry.addCounter(
+        "isomud_path_results_total", "Path queries answered", "result=\"unreachable\"");
+    pathCacheHitsCounter = &registry.addCounter(
+        "isomud_path_cache_hits_total", "Path queries answered from a cached portal sequence");
+    handoffsOutCounter = &registry.addCounter(
+        "isomud_handoffs_total", "Players handed between zone servers", "direction=\"out\"");
+    handoffsInCounter = &registry.addCounter(
+        "isomud_handoffs_total", "Players handed between zone servers", "direction=\"in\"");
+    handoffFailuresCounter = &registry.addCounter(
+        "isomud_handoff_failures_total", "Outgoing handoffs abandoned before the target accepted");
+    ghostsGauge = &registry.addGauge("isomud_ghost_entities", "Entities mirrored from neighbouring shards");
+    chatMessagesCounter = &registry.addCounter(
+        "isomud_chat_messages_total", "Chat messages from clients", "result=\"sent\"");
+    chatRateLimitedCounter = &registry.addCounter(
+        "isomud_chat_messages_total", "Chat messages from clients", "result=\"rate_limited\"");
+    chatDeliveriesCounter = &registry.addCounter(
+        "isomud_chat_deliveries_total", "Chat messages queued for recipients");
+    scriptEventsCounter = &registry.addCounter(
+        "isomud_script_events_total", "SCRIPT_EVENT requests from clients", "result=\"dispatched\"");
+    scriptEventsRejectedCounter = &registry.addCounter(
+        "isomud_script_events_total", "SCRIPT_EVENT requests from clients", "result=\"not_an_event\"");
+    scriptEventsRateLimitedCounter = &registry.addCounter(
+        "isomud_script_events_total", "SCRIPT_EVENT requests from clients", "result=\"rate_limited\"");
+    connectsCounter = &registry.addCounter("isomud_client_connects_total", "Client sessions opened");
+    disconnectsCounter = &registry.addCounter("isomud_client_disconnects_total", "Client sessions closed");
+    clientsGauge = &registry.addGauge("isomud_connected_clients", "Client sessions in the table");
+    sendQueueTotalGauge = &registry.addGauge(
+        "isomud_send_queue_bytes", "Bytes waiting in send queues after the last flush", "scope=\"total\"");
+    sendQueueMaxGauge = &registry.addGauge(
+        "isomud_send_queue_bytes", "Bytes waiting in send queues after the last flush", "scope=\"max\"");
+    ticksCounter = &registry.addCounter("isomud_ticks_total", "Simulation ticks run");
+    overrunsCounter = &registry.addCounter("isomud_tick_overruns_total", "Ticks that exceeded their budget");
+    
+    for (size_t i = 0; i < static_cast<size_t>(TickPhase::COUNT); i++) {
+        TickPhase phase = static_cast<TickPhase>(i);
+        registry.addHistogram("isomud_tick_phase_seconds", "Time spent in each tick phase",
+                              std::string("phase=\"") + TickScheduler::getPhaseName(phase) + "\"",
+                              scheduler.getPhaseHistogram(phase), MicrosecondsToSeconds);
+    }
+    registry.addHistogram("isomud_tick_seconds", "Wall time of a whole tick", "",
+                          scheduler.getTickHistogram(), MicrosecondsToSeconds);
+    
+    arenaCapacityGauge = &registry.addGauge(
+        "isomud_tick_arena_bytes", "Per-tick scratch memory", "scope=\"capacity\"");
+    arenaHighWaterGauge = &registry.addGauge(
+        "isomud_tick_arena_bytes", "Per-tick scratch memory", "scope=\"high_water\"");
+    arenaSpillsCounter = &registry.addCounter(
+        "isomud_tick_arena_spills_total", "Heap blocks taken because a tick outgrew its arena");
+    
+    // Only meaningful when the build counts allocations
+    if (AllocationCounter::isEnabled()) {
+        registry.addHistogram("isomud_tick_allocations", "Heap allocations by the tick thread per tick", "",
+                              tickAllocations, 1.0);
+    }
+}
+
+void ServerMetrics::publish() {
+    for (size_t slot = 0; slot < TypeSlotCount; slot++) {
+        publishTraffic(received[slot], receivedCounters[slot]);
+        publishTraffic(sent[slot], sentCounters[slot]);
+    }
+    publishTraffic(datagramsReceived, datagramsReceivedCounters);
+    publishTraffic(datagramsSent, datagramsSentCounters);
+    
+    coalescedCounter->add(coalesced);
+    backpressureDroppedCounter->add(backpressureDropped);
+    evictionsCounter->add(evictions);
+    pathRequestsCounter->add(pathRequests);
+    pathsFoundCounter->add(pathsFound);
+    pathsUnreachableCounter->add(pathsUnreachable);
+    pathCacheHitsCounter->add(pathCacheHits);
+    handoffsOutCounter->add(handoffsOut);
+    handoffsInCounter->add(handoffsIn);
+    handoffFailuresCounter->add(handoffFailures);
+    chatMessagesCounter->add(chatMessages);
+    chatRateLimitedCounter->add(chatRateLimited);
+    chatDeliveriesCounter->add(chatDeliveries);
+    scriptEventsCounter->add(scriptEvents);
+    scriptEventsRejectedCounter->add(scriptEventsRejected);
+    scriptEventsRateLimitedCounter->add(scriptEventsRateLimited);
+    connectsCounter->add(connects);
+    disconnectsCounter->add(disconnects);
+    ticksCounter->add(ticks);
+    overrunsCounter->add(overruns);
+    coalesced = 0;
+    backpressureDropped = 0;
+    evictions = 0;
+    pathRequests = 0;
+    pathsFound = 0;
+    pathsUnreachable = 0;
+    pathCacheHits = 0;
+    handoffsOut = 0;
+    handoffsIn = 0;
+    handoffFailures = 0;
+    chatMessages = 0;
+    chatRateLimited = 0;
+    chatDeliveries = 0;
+    scriptEvents = 0;
+    scriptEventsRejected = 0;
+    scriptEventsRateLimited = 0;
+    connects = 0;
+    disconnects = 0;
+    ticks = 0;
+    overruns = 0;
+    
+    clientsGauge->set(static_cast<std::int64_t>(clientCount));
+    ghostsGauge->set(static_cast<std::int64_t>(ghostCount));
+    congestedGauge->set(static_cast<std::int64_t>(congestedClients));
+    congestedClients = 0;
+    sendQueueTotalGauge->set(static_cast<std::int64_t>(sendQueueTotal));
+    sendQueueMaxGauge->set(static_cast<std::int64_t>(sendQueueMax));
+    sendQueueTotal = 0;
+    sendQueueMax = 0;
+    
+    arenaCapacityGauge->set(static_cast<std::int64_t>(arenaCapacity));
+    arenaHighWaterGauge->set(static_cast<std::int64_t>(arenaHighWater));
+    arenaSpillsCounter->add(arenaSpills - publishedArenaSpills);
+    publishedArenaSpills = arenaSpills;
+}
+
+void ServerMetrics::publishTraffic(Traffic& traffic, TrafficCounters& counters) {
+    if (traffic.packets == 0) {
+        return;
+    }
+    counters.packets->add(traffic.packets);
+    counters.bytes->add(traffic.bytes);
+    traffic = Traffic();
+}
+
+} // namespace IsometricMUD
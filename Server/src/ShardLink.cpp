@@ -0,0 +1,185 @@
+#include "ShardLink.hpp"
+#include <iostream>
+
+namespace IsometricMUD {
+
+namespace {
+
+// How long queued messages may wait for the link thread to wake up
+const sf::Time PollInterval = sf::milliseconds(5);
+
+// How often a down link is redialled
+const sf::Time RetryInterval = sf::seconds(1.0f);
+
+// Loopback connects either succeed or are refused at once
+const sf::Time ConnectTimeout = sf::milliseconds(250);
+
+} // namespace
+
+ShardLink::ShardLink() : self(0), running(false) {
+}
+
+ShardLink::~ShardLink() {
+    stop();
+}
+
+bool ShardLink::start(const ShardMap& map, unsigned int selfIndex) {
+    self = selfIndex;
+    if (listener.listen(map.get(self).ipcPort, sf::IpAddress::LocalHost) != sf::Socket::Done) {
+        std::cerr << "Error: Could not bind shard IPC port " << map.get(self).ipcPort << std::endl;
+        return false;
+    }
+    selector.add(listener);
+    
+    peers.clear();
+    peers.resize(map.size());
+    for (unsigned int i = 0; i < map.size(); i++) {
+        peers[i].ipcPort = map.get(i).ipcPort;
+    }
+    
+    running = true;
+    thread = std::thread(&ShardLink::run, this);
+    std::cout << "Shard " << self << " of " << map.size() << ", IPC on 127.0.0.1:"
+              << map.get(self).ipcPort << std::endl;
+    return true;
+}
+
+void ShardLink::stop() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    
+    selector.clear();
+    for (auto& peer : peers) {
+        if (peer.socket) {
+            peer.socket->disconnect();
+            peer.socket.reset();
+        }
+    }
+    unidentified.clear();
+    listener.close();
+    outbox.drain([](Outgoing&&) {});
+    events.drain([](ShardEvent&&) {});
+}
+
+void ShardLink::send(unsigned int peer, sf::Packet packet) {
+    outbox.push(Outgoing{peer, std::move(packet)});
+}
+
+void ShardLink::run() {
+    while (running) {
+        connectPeers();
+        sendQueued();
+        
+        if (!selector.wait(PollInterval)) {
+            continue;
+        }
+        if (selector.isReady(listener)) {
+            acceptPeer();
+        }
+        for (size_t i = unidentified.size(); i > 0; i--) {
+            if (selector.isReady(*unidentified[i - 1])) {
+                identifyPeer(i - 1);
+            }
+        }
+        for (unsigned int i = 0; i < peers.size(); i++) {
+            if (peers[i].socket && selector.isReady(*peers[i].socket)) {
+                receiveFrom(i);
+            }
+        }
+    }
+}
+
+void ShardLink::connectPeers() {
+    // The lower index dials, so each pair ends up with exactly one link
+    for (unsigned int i = self + 1; i < peers.size(); i++) {
+        Peer& peer = peers[i];
+        if (peer.socket || (peer.attempted && peer.sinceAttempt.getElapsedTime() < RetryInterval)) {
+            continue;
+        }
+        peer.attempted = true;
+        peer.sinceAttempt.restart();
+        
+        auto socket = std::make_unique<sf::TcpSocket>();
+        if (socket->connect(sf::IpAddress::LocalHost, peer.ipcPort, ConnectTimeout) != sf::Socket::Done) {
+            continue;
+        }
+        
+        sf::Packet hello;
+        hello << static_cast<sf::Uint8>(ShardPacket::HELLO) << static_cast<sf::Uint32>(self);
+        socket->setBlocking(true);
+        if (socket->send(hello) == sf::Socket::Done) {
+            attachPeer(i, std::move(socket));
+        }
+    }
+}
+
+void ShardLink::acceptPeer() {
+    auto socket = std::make_unique<sf::TcpSocket>();
+    if (listener.accept(*socket) == sf::Socket::Done) {
+        selector.add(*socket);
+        unidentified.push_back(std::move(socket));
+    }
+}
+
+void ShardLink::identifyPeer(size_t pendingIndex) {
+    std::unique_ptr<sf::TcpSocket> socket = std::move(unidentified[pendingIndex]);
+    unidentified.erase(unidentified.begin() + static_cast<std::ptrdiff_t>(pendingIndex));
+    selector.remove(*socket);
+    
+    sf::Packet hello;
+    sf::Uint8 type = 0;
+    sf::Uint32 index = 0;
+    if (socket->receive(hello) != sf::Socket::Done || !(hello >> type >> index) ||
+        type != static_cast<sf::Uint8>(ShardPacket::HELLO) || index >= self) {
+        std::cerr << "Warning: Dropped a shard link that did not introduce itself" << std::endl;
+        return;
+    }
+    
+    // A peer that restarted dials again; the new link replaces the dead one
+    if (peers[index].socket) {
+        dropPeer(index);
+    }
+    attachPeer(index, std::move(socket));
+}
+
+void ShardLink::receiveFrom(unsigned int peer) {
+    ShardEvent event;
+    event.type = ShardEvent::Type::MESSAGE;
+    event.peer = peer;
+    sf::Socket::Status status = peers[peer].socket->receive(event.packet);
+    if (status == sf::Socket::Done) {
+        events.push(std::move(event));
+    } else if (status == sf::Socket::Disconnected || status == sf::Socket::Error) {
+        dropPeer(peer);
+    }
+}
+
+void ShardLink::sendQueued() {
+    outbox.drain([this](Outgoing&& message) {
+        Peer& peer = peers[message.peer];
+        if (peer.socket && peer.socket->send(message.packet) != sf::Socket::Done) {
+            dropPeer(message.peer);
+        }
+    });
+}
+
+void ShardLink::attachPeer(unsigned int peer, std::unique_ptr<sf::TcpSocket> socket) {
+    selector.add(*socket);
+    peers[peer].socket = std::move(socket);
+    events.push(ShardEvent{ShardEvent::Type::PEER_UP, peer, sf::Packet()});
+    std::cout << "Shard link to " << peer << " is up" << std::endl;
+}
+
+void ShardLink::dropPeer(unsigned int peer) {
+    Peer& link = peers[peer];
+    selector.remove(*link.socket);
+    link.socket->disconnect();
+    link.socket.reset();
+    link.sinceAttempt.restart();
+    events.push(ShardEvent{ShardEvent::Type::PEER_DOWN, peer, sf::Packet()});
+    std::cout << "Shard link to " << peer << " is down" << std::endl;
+}
+
+} // namespace IsometricMUD
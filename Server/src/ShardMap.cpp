@@ -0,0 +1,76 @@
+#include "ShardMap.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace IsometricMUD {
+
+bool ShardMap::load(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open shard map " << filename << std::endl;
+        return false;
+    }
+    
+    shards.clear();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') {
+            continue;
+        }
+        
+        std::istringstream fields(line);
+        ShardInfo shard;
+        unsigned int clientPort = 0;
+        unsigned int ipcPort = 0;
+        if (!(fields >> shard.minX >> shard.maxX >> clientPort >> ipcPort) || shard.minX >= shard.maxX ||
+            clientPort == 0 || clientPort > 65535 || ipcPort == 0 || ipcPort > 65535) {
+            std::cerr << "Error: " << filename << ":" << lineNumber
+                      << ": expected '<minX> <maxX> <clientPort> <ipcPort>' with minX < maxX" << std::endl;
+            return false;
+        }
+        shard.clientPort = static_cast<unsigned short>(clientPort);
+        shard.ipcPort = static_cast<unsigned short>(ipcPort);
+        
+        for (const auto& other : shards) {
+            if (shard.minX < other.maxX && other.minX < shard.maxX) {
+                std::cerr << "Error: " << filename << ":" << lineNumber
+                          << ": zone overlaps an earlier shard" << std::endl;
+                return false;
+            }
+        }
+        shards.push_back(shard);
+    }
+    
+    if (shards.empty() || shards.size() > MaxShards) {
+        std::cerr << "Error: " << filename << " must list between 1 and " << MaxShards
+                  << " shards" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int ShardMap::findOwner(float x) const {
+    for (size_t i = 0; i < shards.size(); i++) {
+        if (x >= shards[i].minX && x < shards[i].maxX) {
+            return static_cast<int>(i);
+        }
+    }
+    return NoShard;
+}
+
+float ShardMap::distanceOutside(unsigned int index, float x) const {
+    const ShardInfo& shard = shards[index];
+    if (x < shard.minX) {
+        return shard.minX - x;
+    }
+    if (x >= shard.maxX) {
+        return x - shard.maxX;
+    }
+    return 0.0f;
+}
+
+} // namespace IsometricMUD
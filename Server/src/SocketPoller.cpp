@@ -0,0 +1,124 @@
+#include "SocketPoller.hpp"
+#include <iostream>
+
+#ifdef ISOMUD_USE_EPOLL
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+namespace IsometricMUD {
+
+#ifdef ISOMUD_USE_EPOLL
+
+SocketPoller::SocketPoller() : epollFd(epoll_create1(EPOLL_CLOEXEC)), events(256) {
+    if (epollFd < 0) {
+        std::cerr << "Error: epoll_create1 failed (errno " << errno << ")" << std::endl;
+    }
+}
+
+SocketPoller::~SocketPoller() {
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+bool SocketPoller::add(sf::Uint32 clientId, PollableSocket& socket) {
+    return addHandle(clientId, socket.getHandle());
+}
+
+bool SocketPoller::add(sf::Uint32 id, DatagramSocket& socket) {
+    return addHandle(id, socket.getHandle());
+}
+
+bool SocketPoller::addHandle(sf::Uint32 id, sf::SocketHandle handle) {
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.u64 = id;
+    return epoll_ctl(epollFd, EPOLL_CTL_ADD, handle, &event) == 0;
+}
+
+void SocketPoller::remove(sf::Uint32 clientId, PollableSocket& socket) {
+    (void)clientId;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, socket.getHandle(), nullptr);
+}
+
+bool SocketPoller::wait(sf::Time timeout, std::vector<sf::Uint32>& readyClients) {
+    readyClients.clear();
+    
+    int timeoutMs = timeout.asMilliseconds();
+    if (timeoutMs < 0) {
+        timeoutMs = 0;
+    }
+    
+    int count = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), timeoutMs);
+    if (count <= 0) {
+        return false;
+    }
+    
+    for (int i = 0; i < count; i++) {
+        readyClients.push_back(static_cast<sf::Uint32>(events[i].data.u64));
+    }
+    
+    // A full event buffer means more sockets may be waiting; grow for next time
+    if (static_cast<size_t>(count) == events.size()) {
+        events.resize(events.size() * 2);
+    }
+    return true;
+}
+
+const char* SocketPoller::getBackendName() const {
+    return "epoll";
+}
+
+#else
+
+SocketPoller::SocketPoller() {
+}
+
+SocketPoller::~SocketPoller() {
+}
+
+bool SocketPoller::add(sf::Uint32 clientId, PollableSocket& socket) {
+    selector.add(socket);
+    sockets[clientId] = &socket;
+    return true;
+}
+
+bool SocketPoller::add(sf::Uint32 id, DatagramSocket& socket) {
+    selector.add(socket);
+    sockets[id] = &socket;
+    return true;
+}
+
+void SocketPoller::remove(sf::Uint32 clientId, PollableSocket& socket) {
+    selector.remove(socket);
+    sockets.erase(clientId);
+}
+
+bool SocketPoller::wait(sf::Time timeout, std::vector<sf::Uint32>& readyClients) {
+    readyClients.clear();
+    
+    // sf::Time::Zero means "wait forever" to SocketSelector, so clamp instead
+    if (timeout <= sf::Time::Zero) {
+        timeout = sf::microseconds(1);
+    }
+    
+    if (!selector.wait(timeout)) {
+        return false;
+    }
+    
+    for (auto& entry : sockets) {
+        if (selector.isReady(*entry.second)) {
+            readyClients.push_back(entry.first);
+        }
+    }
+    return !readyClients.empty();
+}
+
+const char* SocketPoller::getBackendName() const {
+    return "sf::SocketSelector";
+}
+
+#endif
+
+} // namespace IsometricMUD
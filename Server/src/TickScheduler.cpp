@@ -0,0 +1,144 @@
+#include "TickScheduler.hpp"
+#include <iomanip>
+#include <iostream>
+
+namespace IsometricMUD {
+
+namespace {
+
+// How far behind schedule the loop may fall before it stops trying to catch up
+const int MaxCatchUpTicks = 5;
+
+double toMilliseconds(std::uint64_t micros) {
+    return static_cast<double>(micros) / 1000.0;
+}
+
+} // namespace
+
+TickScheduler::TickScheduler(unsigned int rate)
+    : tickRate(0), currentPhase(TickPhase::NETWORK_INGEST), phaseActive(false),
+      tickCount(0), overrunCount(0), skippedTickCount(0) {
+    phaseAccumulated.fill(0);
+    setTickRate(rate);
+    nextTickTime = clock.getElapsedTime() + tickInterval;
+    lastOverrunWarning = sf::Time::Zero;
+}
+
+void TickScheduler::setTickRate(unsigned int rate) {
+    tickRate = rate > 0 ? rate : 1;
+    tickInterval = sf::microseconds(1000000 / tickRate);
+}
+
+sf::Time TickScheduler::getTimeUntilNextTick() const {
+    sf::Time now = clock.getElapsedTime();
+    return now < nextTickTime ? nextTickTime - now : sf::Time::Zero;
+}
+
+bool TickScheduler::isTickDue() const {
+    return clock.getElapsedTime() >= nextTickTime;
+}
+
+void TickScheduler::beginTick() {
+    tickStartTime = clock.getElapsedTime();
+    
+    // Advance from the previous deadline, not from now, so lateness is
+    // absorbed by the following ticks instead of shifting the whole schedule
+    nextTickTime += tickInterval;
+    
+    if (tickStartTime - nextTickTime > tickInterval * static_cast<float>(MaxCatchUpTicks)) {
+        sf::Int64 behind = (tickStartTime - nextTickTime).asMicroseconds() / tickInterval.asMicroseconds();
+        skippedTickCount += static_cast<sf::Uint64>(behind);
+        nextTickTime = tickStartTime + tickInterval;
+    }
+}
+
+bool TickScheduler::endTick() {
+    if (phaseActive) {
+        endPhase();
+    }
+    
+    sf::Int64 total = 0;
+    for (size_t i = 0; i < PhaseCount; i++) {
+        phaseHistograms[i].record(static_cast<std::uint64_t>(phaseAccumulated[i]));
+        total += phaseAccumulated[i];
+        phaseAccumulated[i] = 0;
+    }
+    tickHistogram.record(static_cast<std::uint64_t>(total));
+    tickCount++;
+    
+    if (total <= tickInterval.asMicroseconds()) {
+        return false;
+    }
+    
+    overrunCount++;
+    
+    // Rate-limit the warning so a struggling server doesn't also flood its log
+    sf::Time now = clock.getElapsedTime();
+    if (now - lastOverrunWarning >= sf::seconds(1.0f)) {
+        lastOverrunWarning = now;
+        std::cerr << "Warning: tick " << tickCount << " took " << toMilliseconds(total)
+                  << " ms (budget " << toMilliseconds(tickInterval.asMicroseconds())
+                  << " ms, " << overrunCount << " overruns total)" << std::endl;
+    }
+    return true;
+}
+
+void TickScheduler::beginPhase(TickPhase phase) {
+    if (phaseActive) {
+        endPhase();
+    }
+    currentPhase = phase;
+    phaseActive = true;
+    phaseStartTime = clock.getElapsedTime();
+}
+
+void TickScheduler::endPhase() {
+    if (!phaseActive) {
+        return;
+    }
+    sf::Time elapsed = clock.getElapsedTime() - phaseStartTime;
+    phaseAccumulated[static_cast<size_t>(currentPhase)] += elapsed.asMicroseconds();
+    phaseActive = false;
+}
+
+void TickScheduler::writeReport(std::ostream& out) const {
+    std::ios::fmtflags savedFlags = out.flags();
+    std::streamsize savedPrecision = out.precision();
+    
+    out << "Tick stats (" << tickCount << " ticks @ " << tickRate << " Hz, "
+        << overrunCount << " overruns, " << skippedTickCount << " skipped)" << std::endl;
+    
+    auto writeLine = [&out](const char* name, const Histogram& histogram) {
+        out << "  " << std::left << std::setw(16) << name << std::right << std::fixed
+            << std::setprecision(3)
+            << " p50 " << std::setw(8) << toMilliseconds(histogram.percentile(0.50)) << " ms"
+            << "  p99 " << std::setw(8) << toMilliseconds(histogram.percentile(0.99)) << " ms"
+            << "  max " << std::setw(8) << toMilliseconds(histogram.getMax()) << " ms"
+            << std::endl;
+    };
+    
+    for (size_t i = 0; i < PhaseCount; i++) {
+        writeLine(getPhaseName(static_cast<TickPhase>(i)), phaseHistograms[i]);
+    }
+    writeLine("total", tickHistogram);
+    
+    out.flags(savedFlags);
+    out.precision(savedPrecision);
+}
+
+const char* TickScheduler::getPhaseName(TickPhase phase) {
+    switch (phase) {
+        case TickPhase::NETWORK_INGEST:
+            return "network_ingest";
+        case TickPhase::SIMULATION:
+            return "simulation";
+        case TickPhase::SCRIPT_DISPATCH:
+            return "script_dispatch";
+        case TickPhase::OUTBOUND_FLUSH:
+            return "outbound_flush";
+        default:
+            return "unknown";
+    }
+}
+
+} // namespace IsometricMUD
@@ -0,0 +1,155 @@
+#include "WireBuffer.hpp"
+#include "SocketPoller.hpp"
+#include <cstring>
+
+#ifdef ISOMUD_USE_WRITEV
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+namespace IsometricMUD {
+
+namespace {
+
+#ifdef ISOMUD_USE_WRITEV
+// Keep well under IOV_MAX; a longer queue is written over several calls
+const size_t MaxIovecs = 64;
+
+#ifdef MSG_NOSIGNAL
+const int SendFlags = MSG_NOSIGNAL;
+#else
+const int SendFlags = 0; // SFML sets SO_NOSIGPIPE where MSG_NOSIGNAL is missing
+#endif
+#endif
+
+} // namespace
+
+WireBufferPtr WireBuffer::encode(const sf::Packet& message) {
+    return frame(message.getData(), message.getDataSize());
+}
+
+WireBufferPtr WireBuffer::frame(const void* payload, size_t payloadSize) {
+    std::vector<char> bytes(4 + payloadSize);
+    
+    // Same framing sf::TcpSocket::send(sf::Packet&) uses
+    sf::Uint32 length = static_cast<sf::Uint32>(payloadSize);
+    bytes[0] = static_cast<char>((length >> 24) & 0xFF);
+    bytes[1] = static_cast<char>((length >> 16) & 0xFF);
+    bytes[2] = static_cast<char>((length >> 8) & 0xFF);
+    bytes[3] = static_cast<char>(length & 0xFF);
+    if (payloadSize > 0) {
+        std::memcpy(bytes.data() + 4, payload, payloadSize);
+    }
+    
+    return std::make_shared<const WireBuffer>(std::move(bytes));
+}
+
+WireBuffer::WireBuffer(std::vector<char> data) : bytes(std::move(data)) {
+}
+
+SendQueue::SendQueue() : pendingBytes(0) {
+}
+
+void SendQueue::pushInline(const char* data, size_t size) {
+    while (size > 0) {
+        Segment segment;
+        segment.size = size < InlineCapacity ? size : InlineCapacity;
+        segment.offset = 0;
+        std::memcpy(segment.inlineBytes.data(), data, segment.size);
+        pendingBytes += segment.size;
+        data += segment.size;
+        size -= segment.size;
+        segments.push_back(std::move(segment));
+    }
+}
+
+void SendQueue::push(WireBufferPtr buffer) {
+    if (!buffer || buffer->getSize() == 0) {
+        return;
+    }
+    Segment segment;
+    segment.size = buffer->getSize();
+    segment.offset = 0;
+    segment.buffer = std::move(buffer);
+    pendingBytes += segment.size;
+    segments.push_back(std::move(segment));
+}
+
+void SendQueue::consume(size_t bytes) {
+    pendingBytes -= bytes;
+    while (bytes > 0 && !segments.empty()) {
+        Segment& front = segments.front();
+        size_t remaining = front.size - front.offset;
+        if (bytes < remaining) {
+            front.offset += bytes;
+            return;
+        }
+        bytes -= remaining;
+        segments.pop_front();
+    }
+}
+
+#ifdef ISOMUD_USE_WRITEV
+
+sf::Socket::Status SendQueue::flush(PollableSocket& socket) {
+    iovec iov[MaxIovecs];
+    
+    while (!segments.empty()) {
+        size_t count = 0;
+        for (auto it = segments.begin(); it != segments.end() && count < MaxIovecs; ++it, ++count) {
+            iov[count].iov_base = const_cast<char*>(it->data() + it->offset);
+            iov[count].iov_len = it->size - it->offset;
+        }
+        
+        msghdr message{};
+        message.msg_iov = iov;
+        message.msg_iovlen = count;
+        
+        ssize_t written = sendmsg(socket.getHandle(), &message, SendFlags);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return sf::Socket::Partial;
+            }
+            if (errno == EPIPE || errno == ECONNRESET) {
+                return sf::Socket::Disconnected;
+            }
+            return sf::Socket::Error;
+        }
+        
+        consume(static_cast<size_t>(written));
+    }
+    return sf::Socket::Done;
+}
+
+#else
+
+sf::Socket::Status SendQueue::flush(PollableSocket& socket) {
+    while (!segments.empty()) {
+        Segment& front = segments.front();
+        size_t sent = 0;
+        sf::Socket::Status status = socket.send(front.data() + front.offset,
+                                                front.size - front.offset, sent);
+        consume(sent);
+        
+        if (status == sf::Socket::Partial || status == sf::Socket::NotReady) {
+            return sf::Socket::Partial;
+        }
+        if (status != sf::Socket::Done) {
+            return status;
+        }
+    }
+    return sf::Socket::Done;
+}
+
+#endif
+
+void SendQueue::clear() {
+    segments.clear();
+    pendingBytes = 0;
+}
+
+} // namespace IsometricMUD
@@ -0,0 +1,501 @@
+#include "WorldJournal.hpp"
+#include "WireCodec.hpp"
+#include "NetworkProtocol.hpp"
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace IsometricMUD {
+
+namespace {
+
+// Changes the tick thread can hand over before it has to hold them back
+const size_t RingCapacity = 16384;
+
+// Longest the writer lets appended entries sit before syncing them
+const sf::Time SyncInterval = sf::milliseconds(100);
+
+// Pause when the ring is empty
+const sf::Time WriterIdleSleep = sf::milliseconds(5);
+
+// Journal size that triggers a fresh snapshot; bounds replay work at startup
+const size_t CompactThreshold = 4 * 1024 * 1024;
+
+// Every frame is [u32 payload length][u32 CRC-32 of payload][payload]
+const size_t FrameHeaderSize = 8;
+
+// A journal entry never exceeds this: sequence, type, id, name, position
+const size_t MaxEntrySize = 64 + MaxPlayerNameLength;
+
+const char SnapshotMagic[4] = {'I', 'M', 'W', 'S'};
+const sf::Uint32 SnapshotVersion = 1;
+
+const std::array<sf::Uint32, 256>& getCrcTable() {
+    static const std::array<sf::Uint32, 256> table = [] {
+        std::array<sf::Uint32, 256> result{};
+        for (sf::Uint32 i = 0; i < 256; i++) {
+            sf::Uint32 value = i;
+            for (int bit = 0; bit < 8; bit++) {
+                value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : value >> 1;
+            }
+            result[i] = value;
+        }
+        return result;
+    }();
+    return table;
+}
+
+sf::Uint32 crc32(const char* data, size_t size) {
+    const auto& table = getCrcTable();
+    sf::Uint32 crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+void appendFrame(std::vector<char>& out, const char* payload, size_t size) {
+    char header[FrameHeaderSize];
+    WireWriter writer(header, sizeof(header));
+    writer.writeUInt32(static_cast<sf::Uint32>(size));
+    writer.writeUInt32(crc32(payload, size));
+    out.insert(out.end(), header, header + sizeof(header));
+    out.insert(out.end(), payload, payload + size);
+}
+
+/**
+ * @brief Check the frame at offset; on success point payload at its contents
+ */
+bool readFrame(const std::vector<char>& data, size_t offset, std::string_view& payload) {
+    if (data.size() - offset < FrameHeaderSize) {
+        return false;
+    }
+    WireReader header(data.data() + offset, FrameHeaderSize);
+    sf::Uint32 size = header.readUInt32();
+    sf::Uint32 crc = header.readUInt32();
+    if (size > data.size() - offset - FrameHeaderSize) {
+        return false;
+    }
+    const char* start = data.data() + offset + FrameHeaderSize;
+    if (crc32(start, size) != crc) {
+        return false;
+    }
+    payload = std::string_view(start, size);
+    return true;
+}
+
+bool readFile(const std::string& path, std::vector<char>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+void writePosition(WireWriter& writer, const Vector3D& position) {
+    writer.writeFloat(position.x);
+    writer.writeFloat(position.y);
+    writer.writeFloat(position.z);
+}
+
+Vector3D readPosition(WireReader& reader) {
+    float x = reader.readFloat();
+    float y = reader.readFloat();
+    float z = reader.readFloat();
+    return Vector3D(x, y, z);
+}
+
+/**
+ * @brief Push a file's contents to stable storage
+ */
+bool syncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+/**
+ * @brief Make a rename inside a directory durable (a no-op on Windows)
+ */
+void syncDirectory(const std::string& path) {
+#ifndef _WIN32
+    int handle = ::open(path.c_str(), O_RDONLY);
+    if (handle >= 0) {
+        fsync(handle);
+        ::close(handle);
+    }
+#else
+    (void)path;
+#endif
+}
+
+} // namespace
+
+WorldJournal::WorldJournal()
+    : nextPlayerId(1), ring(RingCapacity), running(false), nextSequence(1),
+      journalFile(nullptr), journalBytes(0), compactAt(CompactThreshold), unsynced(false) {
+}
+
+WorldJournal::~WorldJournal() {
+    close();
+}
+
+bool WorldJournal::open(const std::string& dataDirectory) {
+    directory = dataDirectory;
+    snapshotPath = (std::filesystem::path(directory) / "world.snapshot").string();
+    journalPath = (std::filesystem::path(directory) / "world.journal").string();
+    
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Error: Could not create data directory " << directory << ": "
+                  << error.message() << std::endl;
+        return false;
+    }
+    
+    sf::Clock recoveryClock;
+    if (!loadSnapshot() || !replayJournal()) {
+        return false;
+    }
+    
+    // The tick thread starts from exactly what is on disk
+    players = savedPlayers;
+    for (const auto& [playerId, record] : players) {
+        playerIds[record.name] = playerId;
+        if (playerId >= nextPlayerId) {
+            nextPlayerId = playerId + 1;
+        }
+    }
+    movedFlags.assign(nextPlayerId, false);
+    
+    journalFile = std::fopen(journalPath.c_str(), "ab");
+    if (!journalFile) {
+        std::cerr << "Error: Could not open " << journalPath << " for writing" << std::endl;
+        return false;
+    }
+    
+    std::cout << "Recovered " << players.size() << " players from " << directory << " in "
+              << recoveryClock.getElapsedTime().asMilliseconds() << " ms" << std::endl;
+    
+    running = true;
+    writer = std::thread(&WorldJournal::runWriter, this);
+    return true;
+}
+
+void WorldJournal::close() {
+    if (!writer.joinable()) {
+        return;
+    }
+    
+    // Hand over whatever the tick thread still holds; the writer keeps
+    // draining the ring meanwhile
+    while (!commit()) {
+        std::this_thread::yield();
+    }
+    
+    running = false;
+    writer.join();
+    if (journalFile) {
+        std::fclose(journalFile);
+        journalFile = nullptr;
+    }
+}
+
+sf::Uint32 WorldJournal::findPlayer(const std::string& name) const {
+    auto it = playerIds.find(name);
+    return it != playerIds.end() ? it->second : 0;
+}
+
+const PlayerRecord* WorldJournal::getPlayer(sf::Uint32 playerId) const {
+    auto it = players.find(playerId);
+    return it != players.end() ? &it->second : nullptr;
+}
+
+sf::Uint32 WorldJournal::createPlayer(const std::string& name, const Vector3D& position) {
+    sf::Uint32 playerId = nextPlayerId++;
+    players[playerId] = {name, position};
+    movedFlags.resize(nextPlayerId, false);
+    playerIds[name] = playerId;
+    
+    Entry entry;
+    entry.type = EntryType::PLAYER_CREATED;
+    entry.playerId = playerId;
+    entry.position = position;
+    entry.name = name;
+    unsentCreations.push_back(std::move(entry));
+    return playerId;
+}
+
+void WorldJournal::setPosition(sf::Uint32 playerId, const Vector3D& position) {
+    auto it = players.find(playerId);
+    if (it == players.end()) {
+        return;
+    }
+    it->second.position = position;
+    if (!movedFlags[playerId]) {
+        movedFlags[playerId] = true;
+        movedPlayers.push_back(playerId);
+    }
+}
+
+bool WorldJournal::commit() {
+    // Creations go first so a move is never journaled before its player
+    while (!unsentCreations.empty()) {
+        if (!ring.tryPush(unsentCreations.front())) {
+            return false;
+        }
+        unsentCreations.pop_front();
+    }
+    
+    size_t handedOver = 0;
+    for (sf::Uint32 playerId : movedPlayers) {
+        Entry entry;
+        entry.type = EntryType::PLAYER_MOVED;
+        entry.playerId = playerId;
+        entry.position = players[playerId].position;
+        if (!ring.tryPush(entry)) {
+            break;
+        }
+        movedFlags[playerId] = false;
+        handedOver++;
+    }
+    movedPlayers.erase(movedPlayers.begin(), movedPlayers.begin() + handedOver);
+    return movedPlayers.empty();
+}
+
+void WorldJournal::applyEntry(PlayerTable& table, const Entry& entry) {
+    if (entry.type == EntryType::PLAYER_CREATED) {
+        table[entry.playerId] = {entry.name, entry.position};
+        return;
+    }
+    auto it = table.find(entry.playerId);
+    if (it != table.end()) {
+        it->second.position = entry.position;
+    }
+}
+
+bool WorldJournal::loadSnapshot() {
+    std::vector<char> data;
+    if (!readFile(snapshotPath, data)) {
+        return true; // No snapshot yet
+    }
+    
+    WireReader header(data.data(), data.size());
+    std::string_view magic = header.readBytes(sizeof(SnapshotMagic));
+    sf::Uint32 version = header.readUInt32();
+    std::string_view payload;
+    if (!header.ok() || magic != std::string_view(SnapshotMagic, sizeof(SnapshotMagic)) ||
+        version != SnapshotVersion || !readFrame(data, sizeof(SnapshotMagic) + 4, payload)) {
+        // Snapshots are renamed into place complete, so this is not a torn write
+        std::cerr << "Error: " << snapshotPath << " is corrupt" << std::endl;
+        return false;
+    }
+    
+    WireReader reader(payload.data(), payload.size());
+    sf::Uint64 lastSequence = reader.readVarUInt();
+    sf::Uint64 count = reader.readVarUInt();
+    for (sf::Uint64 i = 0; i < count && reader.ok(); i++) {
+        sf::Uint32 playerId = static_cast<sf::Uint32>(reader.readVarUInt());
+        std::string_view name = reader.readBytes(static_cast<size_t>(reader.readVarUInt()));
+        Vector3D position = readPosition(reader);
+        savedPlayers[playerId] = {std::string(name), position};
+    }
+    if (!reader.ok()) {
+        std::cerr << "Error: " << snapshotPath << " is malformed" << std::endl;
+        return false;
+    }
+    
+    nextSequence = lastSequence + 1;
+    return true;
+}
+
+bool WorldJournal::replayJournal() {
+    std::vector<char> data;
+    if (!readFile(journalPath, data)) {
+        return true; // No journal yet
+    }
+    
+    size_t offset = 0;
+    size_t replayed = 0;
+    std::string_view payload;
+    while (offset < data.size() && readFrame(data, offset, payload)) {
+        WireReader reader(payload.data(), payload.size());
+        Entry entry;
+        sf::Uint64 sequence = reader.readVarUInt();
+        entry.type = static_cast<EntryType>(reader.readByte());
+        entry.playerId = static_cast<sf::Uint32>(reader.readVarUInt());
+        if (entry.type == EntryType::PLAYER_CREATED) {
+            entry.name = std::string(reader.readBytes(static_cast<size_t>(reader.readVarUInt())));
+        }
+        entry.position = readPosition(reader);
+        if (!reader.ok() ||
+            (entry.type != EntryType::PLAYER_CREATED && entry.type != EntryType::PLAYER_MOVED)) {
+            break;
+        }
+        
+        // Entries at or before the snapshot are left over from an interrupted compaction
+        if (sequence >= nextSequence) {
+            applyEntry(savedPlayers, entry);
+            nextSequence = sequence + 1;
+            replayed++;
+        }
+        offset += FrameHeaderSize + payload.size();
+    }
+    
+    if (offset < data.size()) {
+        std::cerr << "Warning: Discarding " << data.size() - offset << " bytes of incomplete journal tail"
+                  << std::endl;
+        std::error_code error;
+        std::filesystem::resize_file(journalPath, offset, error);
+        if (error) {
+            std::cerr << "Error: Could not truncate " << journalPath << ": " << error.message() << std::endl;
+            return false;
+        }
+    }
+    
+    journalBytes = offset;
+    if (replayed > 0) {
+        std::cout << "Replayed " << replayed << " journal entries" << std::endl;
+    }
+    return true;
+}
+
+void WorldJournal::runWriter() {
+    while (true) {
+        // Read the flag first: anything committed before close() set it is in the ring
+        bool stopping = !running;
+        
+        size_t drained = ring.drain([this](Entry entry) {
+            appendEntry(entry);
+            applyEntry(savedPlayers, entry);
+        });
+        
+        if (!pendingBytes.empty() && !writeJournal()) {
+            std::cerr << "Error: Journal write failed; state changes are not being saved" << std::endl;
+        }
+        
+        if (unsynced && journalFile && (stopping || syncClock.getElapsedTime() >= SyncInterval)) {
+            if (!syncFile(journalFile)) {
+                std::cerr << "Error: Could not sync " << journalPath << std::endl;
+            }
+            unsynced = false;
+            syncClock.restart();
+        }
+        
+        // After a failed compaction, wait for another threshold's worth before retrying
+        if (journalBytes >= compactAt && !compact()) {
+            compactAt = journalBytes + CompactThreshold;
+        }
+        
+        if (stopping) {
+            break;
+        }
+        if (drained == 0) {
+            sf::sleep(WriterIdleSleep);
+        }
+    }
+}
+
+void WorldJournal::appendEntry(const Entry& entry) {
+    char payload[MaxEntrySize];
+    WireWriter writer(payload, sizeof(payload));
+    writer.writeVarUInt(nextSequence++);
+    writer.writeByte(static_cast<sf::Uint8>(entry.type));
+    writer.writeVarUInt(entry.playerId);
+    if (entry.type == EntryType::PLAYER_CREATED) {
+        writer.writeVarUInt(entry.name.size());
+        writer.writeBytes(entry.name.data(), entry.name.size());
+    }
+    writePosition(writer, entry.position);
+    if (writer.finish()) {
+        appendFrame(pendingBytes, payload, writer.getSize());
+    }
+}
+
+bool WorldJournal::writeJournal() {
+    if (!journalFile) {
+        pendingBytes.clear();
+        return false;
+    }
+    size_t written = std::fwrite(pendingBytes.data(), 1, pendingBytes.size(), journalFile);
+    journalBytes += written;
+    unsynced = true;
+    bool complete = written == pendingBytes.size();
+    pendingBytes.clear();
+    return complete;
+}
+
+bool WorldJournal::compact() {
+    // [magic][version][frame: last sequence, count, (id, name, position)...]
+    std::vector<char> payload(32 + savedPlayers.size() * (MaxEntrySize + 8));
+    WireWriter writer(payload.data(), payload.size());
+    writer.writeVarUInt(nextSequence - 1);
+    writer.writeVarUInt(savedPlayers.size());
+    for (const auto& [playerId, record] : savedPlayers) {
+        writer.writeVarUInt(playerId);
+        writer.writeVarUInt(record.name.size());
+        writer.writeBytes(record.name.data(), record.name.size());
+        writePosition(writer, record.position);
+    }
+    if (!writer.finish()) {
+        return false;
+    }
+    
+    std::vector<char> file(SnapshotMagic, SnapshotMagic + sizeof(SnapshotMagic));
+    char version[4];
+    WireWriter versionWriter(version, sizeof(version));
+    versionWriter.writeUInt32(SnapshotVersion);
+    file.insert(file.end(), version, version + sizeof(version));
+    appendFrame(file, payload.data(), writer.getSize());
+    
+    // A crash at any point leaves either the old snapshot or the new one in
+    // place, and the journal is only emptied once the new one is durable
+    std::string temporaryPath = snapshotPath + ".tmp";
+    std::FILE* snapshotFile = std::fopen(temporaryPath.c_str(), "wb");
+    if (!snapshotFile) {
+        std::cerr << "Error: Could not create " << temporaryPath << std::endl;
+        return false;
+    }
+    bool written = std::fwrite(file.data(), 1, file.size(), snapshotFile) == file.size() &&
+                   syncFile(snapshotFile);
+    std::fclose(snapshotFile);
+    
+    std::error_code error;
+    if (written) {
+        std::filesystem::rename(temporaryPath, snapshotPath, error);
+    }
+    if (!written || error) {
+        std::cerr << "Error: Could not write " << snapshotPath << std::endl;
+        return false;
+    }
+    syncDirectory(directory);
+    
+    std::FILE* emptyJournal = std::freopen(journalPath.c_str(), "wb", journalFile);
+    if (!emptyJournal) {
+        std::cerr << "Error: Could not reset " << journalPath << std::endl;
+        journalFile = std::fopen(journalPath.c_str(), "ab");
+        return false;
+    }
+    journalFile = emptyJournal;
+    journalBytes = 0;
+    compactAt = CompactThreshold;
+    unsynced = false;
+    return true;
+}
+
+} // namespace IsometricMUD
@@ -1,29 +1,251 @@
 #include "GameServer.hpp"
+#include "ServerBenchmarks.hpp"
 #include <iostream>
 #include <string>
+#include <vector>
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [port] [options]" << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  --tick-rate <hz>         Simulation ticks per second (default 60)" << std::endl;
+    std::cerr << "  --stats-interval <sec>   Seconds between tick reports, 0 to disable (default 30)" << std::endl;
+    std::cerr << "  --script <file>          Load a script whose events clients can trigger" << std::endl;
+    std::cerr << "  --snapshots              Send delta-compressed snapshots instead of per-entity updates" << std::endl;
+    std::cerr << "  --no-udp                 Keep movement on TCP instead of the UDP channel" << std::endl;
+    std::cerr << "  --sim-loss <percent>     Drop this share of outgoing datagrams (testing)" << std::endl;
+    std::cerr << "  --sim-latency <ms>       Delay outgoing datagrams (testing)" << std::endl;
+    std::cerr << "  --sim-jitter <ms>        Add up to this much random delay (testing)" << std::endl;
+    std::cerr << "  --level <file>           Reject moves that don't end on this level's walkable ground" << std::endl;
+    std::cerr << "  --npcs <n>               Spawn NPCs that wander the level (needs --level)" << std::endl;
+    std::cerr << "  --path-threads <n>       Pathfinding worker threads (default 2)" << std::endl;
+    std::cerr << "  --shard-map <file>       Run as one zone server of several; the map sets the port" << std::endl;
+    std::cerr << "  --shard <index>          This server's line in the shard map (default 0)" << std::endl;
+    std::cerr << "  --chat-rate <n>          Chat messages per second each client may send (default 1)" << std::endl;
+    std::cerr << "  --chat-burst <n>         Chat messages a quiet client may send at once (default 5)" << std::endl;
+    std::cerr << "  --chat-radius <units>    Reach of proximity chat (default 12)" << std::endl;
+    std::cerr << "  --seed <n>               Seed for session tokens and NPC wandering (default random)" << std::endl;
+    std::cerr << "  --capture <file>         Record every inbound packet for later replay" << std::endl;
+    std::cerr << "  --replay <file>          Run a capture through the simulation without sockets and report tick times" << std::endl;
+    std::cerr << "  --replay-speed <speed>   full (back to back, default) or realtime" << std::endl;
+    std::cerr << "  --data-dir <path>        Save player state here and restore it on restart" << std::endl;
+    std::cerr << "  --admin-port <port>      Serve Prometheus metrics on 127.0.0.1:<port>/metrics" << std::endl;
+    std::cerr << "  --send-high-watermark <KiB>  Drop position updates to clients this far behind (default 256)" << std::endl;
+    std::cerr << "  --send-low-watermark <KiB>   Resume position updates below this (default 64)" << std::endl;
+    std::cerr << "  --send-limit <KiB>       Evict clients with this much unsent (default 1024)" << std::endl;
+    std::cerr << "  --slow-client-timeout <sec>  Evict clients above the high watermark this long, 0 = never (default 10)" << std::endl;
+    std::cerr << "  --bench <name>           Run an offline benchmark, print one JSON line and exit ("
+              << IsometricMUD::ServerBenchmarks::getNames() << ")" << std::endl;
+}
+
+bool parseNumber(const std::string& text, int minValue, int maxValue, int& result) {
+    try {
+        int value = std::stoi(text);
+        if (value < minValue || value > maxValue) {
+            return false;
+        }
+        result = value;
+        return true;
+    } catch (const std::exception& e) {
+        return false;
+    }
+}
+
+} // namespace
 
 int main(int argc, char* argv[]) {
     unsigned short port = 53000;
+    IsometricMUD::ServerConfig config;
+    std::vector<std::string> scripts;
+    std::string replayFile;
+    bool replayRealTime = false;
+    std::string benchmark;
     
-    if (argc > 1) {
-        try {
-            int portNum = std::stoi(argv[1]);
-            if (portNum < 1 || portNum > 65535) {
-                std::cerr << "Error: Port must be between 1 and 65535" << std::endl;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        int value = 0;
+        
+        if (arg == "--tick-rate" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 1000, value)) {
+                std::cerr << "Error: Tick rate must be between 1 and 1000" << std::endl;
+                return 1;
+            }
+            config.tickRate = static_cast<unsigned int>(value);
+        } else if (arg == "--stats-interval" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 0, 86400, value)) {
+                std::cerr << "Error: Invalid stats interval '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.statsInterval = static_cast<unsigned int>(value);
+        } else if (arg == "--script" && i + 1 < argc) {
+            scripts.push_back(argv[++i]);
+        } else if (arg == "--snapshots") {
+            config.snapshotMode = true;
+        } else if (arg == "--no-udp") {
+            config.udpEnabled = false;
+        } else if (arg == "--sim-loss" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 0, 100, value)) {
+                std::cerr << "Error: Loss must be a percentage between 0 and 100" << std::endl;
+                return 1;
+            }
+            config.simulatedLoss = value / 100.0f;
+        } else if (arg == "--sim-latency" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 0, 10000, value)) {
+                std::cerr << "Error: Invalid latency '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.simulatedLatency = static_cast<unsigned int>(value);
+        } else if (arg == "--sim-jitter" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 0, 10000, value)) {
+                std::cerr << "Error: Invalid jitter '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.simulatedJitter = static_cast<unsigned int>(value);
+        } else if (arg == "--level" && i + 1 < argc) {
+            config.levelFile = argv[++i];
+        } else if (arg == "--npcs" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 0, 1000000, value)) {
+                std::cerr << "Error: Invalid NPC count '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.npcCount = static_cast<unsigned int>(value);
+        } else if (arg == "--path-threads" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 64, value)) {
+                std::cerr << "Error: Path threads must be between 1 and 64" << std::endl;
+                return 1;
+            }
+            config.pathThreads = static_cast<unsigned int>(value);
+        } else if (arg == "--shard-map" && i + 1 < argc) {
+            config.shardMapFile = argv[++i];
+        } else if (arg == "--shard" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 0, 127, value)) {
+                std::cerr << "Error: Shard index must be between 0 and 127" << std::endl;
+                return 1;
+            }
+            config.shardIndex = static_cast<unsigned int>(value);
+        } else if (arg == "--chat-rate" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 1000, value)) {
+                std::cerr << "Error: Chat rate must be between 1 and 1000" << std::endl;
+                return 1;
+            }
+            config.chatRate = static_cast<float>(value);
+        } else if (arg == "--chat-burst" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 1000, value)) {
+                std::cerr << "Error: Chat burst must be between 1 and 1000" << std::endl;
+                return 1;
+            }
+            config.chatBurst = static_cast<float>(value);
+        } else if (arg == "--chat-radius" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 1000, value)) {
+                std::cerr << "Error: Chat radius must be between 1 and 1000" << std::endl;
+                return 1;
+            }
+            config.chatRadius = static_cast<float>(value);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 2147483647, value)) {
+                std::cerr << "Error: Seed must be a positive number" << std::endl;
+                return 1;
+            }
+            config.randomSeed = static_cast<sf::Uint32>(value);
+        } else if (arg == "--capture" && i + 1 < argc) {
+            config.captureFile = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replayFile = argv[++i];
+        } else if (arg == "--replay-speed" && i + 1 < argc) {
+            std::string speed = argv[++i];
+            if (speed != "full" && speed != "realtime") {
+                std::cerr << "Error: Replay speed must be full or realtime" << std::endl;
+                return 1;
+            }
+            replayRealTime = speed == "realtime";
+        } else if (arg == "--data-dir" && i + 1 < argc) {
+            config.dataDirectory = argv[++i];
+        } else if (arg == "--admin-port" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 65535, value)) {
+                std::cerr << "Error: Invalid admin port '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.adminPort = static_cast<unsigned short>(value);
+        } else if (arg == "--send-high-watermark" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 1024 * 1024, value)) {
+                std::cerr << "Error: Invalid high watermark '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.sendHighWatermark = static_cast<size_t>(value) * 1024;
+        } else if (arg == "--send-low-watermark" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 0, 1024 * 1024, value)) {
+                std::cerr << "Error: Invalid low watermark '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.sendLowWatermark = static_cast<size_t>(value) * 1024;
+        } else if (arg == "--send-limit" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 1024 * 1024, value)) {
+                std::cerr << "Error: Invalid send limit '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.sendBufferLimit = static_cast<size_t>(value) * 1024;
+        } else if (arg == "--slow-client-timeout" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 0, 86400, value)) {
+                std::cerr << "Error: Invalid slow client timeout '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+            config.slowClientTimeout = static_cast<unsigned int>(value);
+        } else if (arg == "--bench" && i + 1 < argc) {
+            benchmark = argv[++i];
+            if (!IsometricMUD::ServerBenchmarks::exists(benchmark)) {
+                std::cerr << "Error: Unknown benchmark '" << benchmark << "' (expected "
+                          << IsometricMUD::ServerBenchmarks::getNames() << ")" << std::endl;
                 return 1;
             }
-            port = static_cast<unsigned short>(portNum);
-        } catch (const std::exception& e) {
-            std::cerr << "Error: Invalid port number '" << argv[1] << "'" << std::endl;
-            std::cerr << "Usage: " << argv[0] << " [port]" << std::endl;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Error: Unknown option '" << arg << "'" << std::endl;
+            printUsage(argv[0]);
             return 1;
+        } else {
+            if (!parseNumber(arg, 1, 65535, value)) {
+                std::cerr << "Error: Invalid port number '" << arg << "'" << std::endl;
+                printUsage(argv[0]);
+                return 1;
+            }
+            port = static_cast<unsigned short>(value);
         }
     }
     
+    if (!benchmark.empty()) {
+        return IsometricMUD::ServerBenchmarks::run(benchmark, std::cout) ? 0 : 1;
+    }
+    
+    if (config.sendLowWatermark >= config.sendHighWatermark ||
+        config.sendHighWatermark >= config.sendBufferLimit) {
+        std::cerr << "Error: Send watermarks must satisfy low < high < limit" << std::endl;
+        return 1;
+    }
+    
+    if (config.npcCount > 0 && config.levelFile.empty()) {
+        std::cerr << "Error: --npcs needs a level to walk on (--level)" << std::endl;
+        return 1;
+    }
+    
     std::cout << "Isometric MUD Server" << std::endl;
     std::cout << "===================" << std::endl;
     
-    IsometricMUD::GameServer server;
+    IsometricMUD::GameServer server(config);
+    
+    for (const auto& script : scripts) {
+        if (!server.loadScript(script)) {
+            std::cerr << "Failed to load script: " << script << std::endl;
+            return 1;
+        }
+    }
+    
+    if (!replayFile.empty()) {
+        if (!config.captureFile.empty() || !config.shardMapFile.empty()) {
+            std::cerr << "Error: --replay can't be combined with --capture or --shard-map" << std::endl;
+            return 1;
+        }
+        return server.replay(replayFile, replayRealTime) ? 0 : 1;
+    }
     
     if (!server.start(port)) {
         std::cerr << "Failed to start server" << std::endl;